@@ -0,0 +1,128 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_CHECKPOINT_HPP__
+#define __LIPNET_CHECKPOINT_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+
+#include <cereal/cereal.hpp>
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/tuple.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/array.hpp>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief The checkpoint_t struct; periodic snapshot of the optimizer state as
+     *          cereal binary archive. The state is written to a temporary file which
+     *          replaces the checkpoint, thus a preemption while writing leaves the last
+     *          checkpoint intact. The state has to provide a serialize method; types of
+     *          runtime size have to size themselves on load (e.g. through a stored topology).
+     */
+
+    struct checkpoint_t {
+        static constexpr uint32_t magic_value = 0x4350494c; // "LIPC"
+
+        std::string path;       /// path of the checkpoint file; empty disables checkpointing
+        size_t every = 1000;    /// iterations between two checkpoints (default = 1000)
+
+
+        inline bool enabled() const { return !path.empty(); }
+
+        /// true if a checkpoint should be written after iteration i
+        inline bool due( const size_t i ) const {
+            return enabled() && every > 0 && i > 0 && i % every == 0;
+        }
+
+
+        /**
+         * @brief write the state to the checkpoint file
+         * @param kind identifier of the optimizer; checked on load
+         * @param state optimizer state
+         * @return false if the checkpoint could not be written
+         */
+
+        template<typename STATE>
+        bool save( const std::string &kind, const STATE &state ) const {
+            if( !enabled() ) return false;
+
+            const std::string tmp = path + ".tmp";
+            {
+                std::ofstream os( tmp, std::ios::binary );
+                if( !os ) return false;
+
+                cereal::BinaryOutputArchive archive( os );
+                archive( magic_value, kind, state );
+                if( !os ) return false;
+            }
+
+            return std::rename( tmp.c_str(), path.c_str() ) == 0;
+        }
+
+        /**
+         * @brief read the state from the checkpoint file
+         * @param kind identifier of the optimizer
+         * @param state optimizer state; the return value
+         * @return false if there is no checkpoint to resume from
+         */
+
+        template<typename STATE>
+        bool load( const std::string &kind, STATE &state ) const {
+            if( !enabled() ) return false;
+
+            std::ifstream is( path, std::ios::binary );
+            if( !is ) return false;
+
+            uint32_t magic = 0; std::string stored;
+            cereal::BinaryInputArchive archive( is );
+            archive( magic, stored );
+
+            if( magic != magic_value || stored != kind )
+                throw std::string{"checkpoint does not belong to this optimizer: "} + path;
+
+            archive( state );
+            return true;
+        }
+
+        /// remove the checkpoint file; called once the optimization finished
+        inline void clear() const {
+            if( enabled() ) std::remove( path.c_str() );
+        }
+    };
+
+}
+
+#endif // __LIPNET_CHECKPOINT_HPP__
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_DISTRIBUTED_HPP__
+#define __LIPNET_DISTRIBUTED_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+
+#ifdef LIPNET_MPI
+#include <mpi.h>
+#endif
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+#include <lipnet/variable.hpp>
+
+#include <lipnet/network/data.hpp>
+
+
+
+
+namespace lipnet {
+
+#ifdef LIPNET_MPI
+    /// mpi datatype of a numerical value type
+    template<typename T> struct mpi_type;
+    template<> struct mpi_type<float>  { static inline MPI_Datatype get() { return MPI_FLOAT; } };
+    template<> struct mpi_type<double> { static inline MPI_Datatype get() { return MPI_DOUBLE; } };
+    template<> struct mpi_type<int>    { static inline MPI_Datatype get() { return MPI_INT; } };
+#endif
+
+
+    /**
+     * @brief The communicator_t struct; ranks of a data parallel run. Every rank holds
+     *          a shard of the training data and the same copy of the variable; the
+     *          gradients of the shards are averaged before the optimizer step, thus
+     *          all ranks take the same steps. Without LIPNET_MPI there is one rank
+     *          and all operations are no-ops.
+     */
+
+    struct communicator_t {
+
+#ifdef LIPNET_MPI
+        MPI_Comm comm = MPI_COMM_WORLD;
+
+        communicator_t() {
+            int r = 0, s = 1;
+            MPI_Comm_rank( comm, &r );
+            MPI_Comm_size( comm, &s );
+            nrank = size_t(r); nsize = size_t(s);
+        }
+#else
+        communicator_t() = default;
+#endif
+
+        /// index of this process
+        inline size_t rank() const { return nrank; }
+
+        /// number of processes
+        inline size_t size() const { return nsize; }
+
+        /// true on the rank which computes the barrier terms and writes the results
+        inline bool root() const { return nrank == 0; }
+
+
+        /**
+         * @brief sum of the buffers of all ranks, in place
+         * @param data buffer
+         * @param n number of entries
+         */
+
+        template<typename T>
+        void allreduce( T *data, const size_t n ) const {
+#ifdef LIPNET_MPI
+            if( nsize > 1 && MPI_Allreduce( MPI_IN_PLACE, data, int(n), mpi_type<T>::get(),
+                                            MPI_SUM, comm ) != MPI_SUCCESS )
+                throw std::string{"allreduce failed"};
+#else
+            (void) data; (void) n;
+#endif
+        }
+
+        /**
+         * @brief copy the buffer of the root rank to all ranks
+         * @param data buffer
+         * @param n number of entries
+         */
+
+        template<typename T>
+        void broadcast( T *data, const size_t n ) const {
+#ifdef LIPNET_MPI
+            if( nsize > 1 && MPI_Bcast( data, int(n), mpi_type<T>::get(), 0, comm ) != MPI_SUCCESS )
+                throw std::string{"broadcast failed"};
+#else
+            (void) data; (void) n;
+#endif
+        }
+
+
+        /**
+         * @brief sum a gradient and its loss over all ranks; one message of the
+         *          flat parameter buffer with the loss appended
+         * @param gradient gradient of the local shard
+         * @param objective loss of the local shard
+         * @param scale factor of the sums (default = 1)
+         */
+
+        template<typename T, typename V>
+        void sum( V &gradient, T &objective, const T scale = 1 ) const {
+            if( nsize < 2 ) return;
+
+            constexpr size_t n = flat_t<T,V>::size;
+            std::vector<T> buffer( n + 1 );
+            flat_t<T,V>::pack( gradient, buffer.data() );
+            buffer[n] = objective;
+
+            allreduce( buffer.data(), n + 1 );
+
+            if( scale != T(1) )
+                for( auto &b : buffer ) b *= scale;
+
+            flat_t<T,V>::unpack( buffer.data(), gradient );
+            objective = buffer[n];
+        }
+
+        /// mean of a batch gradient and its loss over all ranks
+        /// @see sum
+        template<typename T, typename V>
+        inline void average( V &gradient, T &objective ) const {
+            sum( gradient, objective, T(1) / T(nsize) );
+        }
+
+        /**
+         * @brief copy a structured variable of the root rank to all ranks
+         * @param var variable
+         */
+
+        template<typename T, typename V>
+        void broadcast( V &var ) const {
+            if( nsize < 2 ) return;
+
+            std::vector<T> buffer( flat_t<T,V>::size );
+            flat_t<T,V>::pack( var, buffer.data() );
+            broadcast( buffer.data(), buffer.size() );
+            flat_t<T,V>::unpack( buffer.data(), var );
+        }
+
+        /// value of the root rank
+        template<typename T>
+        T broadcast_value( T value ) const {
+            broadcast( &value, 1 );
+            return value;
+        }
+
+        /// decision of the root rank
+        bool broadcast_value( const bool value ) const {
+            return broadcast_value<int>( value ? 1 : 0 ) != 0;
+        }
+
+    private:
+        size_t nrank = 0, nsize = 1;
+    };
+
+
+    /**
+     * @brief communicator of the network problems; empty (local training) unless set
+     *          by the caller, like default_threads
+     * @return reference to the setting
+     */
+
+    inline std::shared_ptr<const communicator_t>& default_communicator() {
+        static std::shared_ptr<const communicator_t> comm;
+        return comm;
+    }
+
+
+    /**
+     * @brief The environment_t struct; initialises and finalises mpi for the lifetime
+     *          of the object, one per process. Only the calling thread communicates.
+     */
+
+    struct environment_t {
+
+        environment_t( int &argc, char **&argv ) {
+#ifdef LIPNET_MPI
+            int provided = 0;
+            if( MPI_Init_thread( &argc, &argv, MPI_THREAD_FUNNELED, &provided ) != MPI_SUCCESS )
+                throw std::string{"could not initialise mpi"};
+#else
+            (void) argc; (void) argv;
+#endif
+        }
+
+        ~environment_t() {
+#ifdef LIPNET_MPI
+            MPI_Finalize();
+#endif
+        }
+
+        environment_t( const environment_t& ) = delete;
+        environment_t& operator=( const environment_t& ) = delete;
+    };
+
+
+    /**
+     * @brief shard function; contiguous block of the samples of one rank. The blocks
+     *          differ by at most one sample in size.
+     * @param data training data of all ranks
+     * @param rank index of the rank
+     * @param size number of ranks
+     * @return samples of rank
+     */
+
+    template<typename T, size_t IN, size_t OUT>
+    network_data_t<T, IN, OUT> shard( network_data_t<T, IN, OUT> &&data, const size_t rank, const size_t size ) {
+        if( size < 2 ) return std::move(data);
+
+        const size_t n = data.samples();
+        if( n < size )
+            throw std::string{"fewer samples than ranks"};
+
+        const size_t begin = rank*n/size, count = (rank+1)*n/size - begin;
+
+        network_data_t<T, IN, OUT> res;
+        if( data.columnwise() ) {
+            res.icols = blaze::submatrix( data.icols, 0UL, begin, data.icols.rows(), count );
+            if( data.tcols.columns() > 0 )
+                res.tcols = blaze::submatrix( data.tcols, 0UL, begin, data.tcols.rows(), count );
+        } else {
+            res.idata = blaze::submatrix( data.idata, begin, 0UL, count, data.idata.columns() );
+            if( data.tdata.rows() > 0 )
+                res.tdata = blaze::submatrix( data.tdata, begin, 0UL, count, data.tdata.columns() );
+        }
+
+        if( data.labeled() )
+            res.labels.assign( data.labels.begin() + begin, data.labels.begin() + begin + count );
+
+        return res;
+    }
+
+}
+
+#endif // __LIPNET_DISTRIBUTED_HPP__
@@ -0,0 +1,443 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_DYNAMIC_BACKPROPAGATION_HPP__
+#define __LIPNET_DYNAMIC_BACKPROPAGATION_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/profile.hpp>
+#include <lipnet/tensor.hpp>
+#include <lipnet/variable.hpp>
+#include <lipnet/parallel.hpp>
+
+#include <lipnet/network/data.hpp>
+#include <lipnet/network/sampler.hpp>
+#include <lipnet/network/loss.hpp>
+#include <lipnet/network/activation.hpp>
+#include <lipnet/network/backpropagation.hpp>
+
+#include <lipnet/dynamic/network.hpp>
+
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief The dynamic_backpropagation_t struct; backpropagation of a network with
+     *          runtime topology in batches of runtime size; the counterpart of
+     *          backpropagation_batch_t with dynamic_batch
+     * @tparam T numerical value type
+     * @tparam ATYPE activation function type
+     * @tparam LOSS loss function type
+     */
+
+    template<typename T, template<typename> typename ATYPE,
+             template<typename> typename LOSS>
+    struct dynamic_backpropagation_t {
+
+
+        typedef typename compute_type<T>::type C;
+        typedef blaze::DynamicMatrix<C, blaze::rowMajor> dmatrix_t;
+
+        typedef dynamic_weights_t<T> variable_t;
+        typedef dynamic_weights_t<C> cvariable_t;
+
+        /// gathered batch of samples; one sample per column
+        struct batch_t {
+            dmatrix_t input, target;
+            /// class labels; used instead of target if the data is labeled
+            std::vector<size_t> labels;
+            size_t valid = 0;
+        };
+
+        /// activation buffers and sampler state; one entry per layer
+        struct workspace_t {
+            /// layer inputs; the first entry is not used, the input view is read instead
+            std::vector<dmatrix_t> x;
+            std::vector<dmatrix_t> z, delta;
+            /// activation derivatives of the hidden layers; the last entry is not used
+            std::vector<dmatrix_t> deriv;
+            cvariable_t params;
+
+            std::unique_ptr<batch_sampler_t> sampler;
+            std::vector<size_t> indices;
+            std::array<batch_t, 2> batches; size_t current = 0;
+
+            /// the other batch holds the prefetched next batch
+            bool ready = false;
+
+            /// persistent thread gathering the next batch; created by the first
+            /// prefetch, declared last so it is joined first
+            std::unique_ptr<worker_t> worker;
+
+            /// finish an outstanding prefetch
+            void settle() {
+                if( worker && worker->pending() ) { worker->wait(); ready = true; }
+            }
+        };
+
+        struct metainfo_t {
+             size_t iter; std::unique_ptr<workspace_t> workspace;
+             metainfo_t() : iter{0}, workspace{ std::make_unique<workspace_t>() } {}
+
+             /// iteration count and sampler position of the next batch; a prefetched
+             /// batch is not stored, the sampler is rewound and draws it again on
+             /// resume. The position of a data stream is not stored.
+             /// @cite cereallib
+             template<class Archive> void save( Archive & archive ) const {
+                 workspace->settle();
+                 const bool sampled = bool( workspace->sampler );
+                 archive( iter, sampled );
+                 if( !sampled ) return;
+
+                 batch_sampler_t sampler = *workspace->sampler;
+                 if( workspace->ready ) sampler.rewind();
+                 archive( sampler );
+             }
+
+             /// @see save
+             template<class Archive> void load( Archive & archive ) {
+                 bool sampled = false;
+                 archive( iter, sampled );
+
+                 workspace->settle(); workspace->ready = false;
+                 workspace->sampler.reset();
+                 if( sampled ) {
+                     workspace->sampler = std::make_unique<batch_sampler_t>( 1, 1 );
+                     archive( *workspace->sampler );
+                 }
+             }
+        };
+
+        /// number of neurons at each layer
+        std::vector<size_t> topology;
+
+        dynamic_data_t<C> training_data;
+        LOSS<C> loss;
+
+        /// number of threads used in compute
+        size_t threads = default_threads();
+
+        /// batch size; zero means the whole dataset
+        size_t batch;
+
+        /// shuffle the samples in every epoch
+        bool shuffle = true;
+        /// gather the next batch on a background thread
+        bool prefetch = true;
+        /// seed of the shuffling
+        size_t seed = 0;
+
+        /**
+         * @brief dynamic_backpropagation_t; default constructor
+         * @param l loss
+         * @param topo number of neurons at each layer
+         * @param data training data; the dimensions have to match the topology
+         * @param batchsize batch size; zero means the whole dataset
+         */
+
+        dynamic_backpropagation_t( LOSS<T>&& l, std::vector<size_t> topo, dynamic_data_t<T> &&data,
+                                   const size_t batchsize = 0 )
+            : topology{ std::move(topo) }, training_data{ precision_cast<C>( std::move(data) ) },
+              loss{ loss_cast( std::move(l) ) }, batch{ batchsize } {
+
+            if( topology.size() < 2 )
+                throw std::string{"topology needs an input and an output layer"};
+
+            if(  training_data.samples() == 0 )
+                throw std::string{"empty training data"};
+
+            training_data.make_columnwise();
+
+            if( training_data.icols.rows() != topology.front() )
+                throw std::string{"input dimension of the training data does not match the topology"};
+
+            if( training_data.labeled() ) {
+                if( !supports_labels<LOSS>::value )
+                    throw std::string{"loss does not support label targets"};
+                if( *std::max_element( training_data.labels.begin(), training_data.labels.end() ) >= topology.back() )
+                    throw std::string{"label out of range of the output layer"};
+            } else if( training_data.tcols.rows() != topology.back() ) {
+                throw std::string{"output dimension of the training data does not match the topology"};
+            }
+        }
+
+        /// number of layers
+        inline size_t depth() const {
+            return topology.size() - 1;
+        }
+
+        /// number of samples per batch
+        inline size_t batchsize() const {
+            return ( batch == 0 ) ? training_data.samples()
+                                  : std::min( batch, training_data.samples() );
+        }
+
+        /// loss in the numerical type of the propagation; the losses are stateless
+        static inline LOSS<C> loss_cast( LOSS<T> &&l ) {
+            if constexpr ( std::is_same<C, T>::value ) return std::move(l);
+            else return LOSS<C>{};
+        }
+
+        /// number of batches; the last batch holds the remainder
+        inline size_t batches() const {
+            return ( training_data.samples() + batchsize() - 1 ) / batchsize();
+        }
+
+        /**
+         * @brief run function; compute backpropagation of the next batch of the sampler
+         * @param var current position
+         * @param info optimisation metainfo which are needed during the iterations
+         * @param gradient the computed gradients; the return value, sized like var
+         * @param objective the loss at the current position
+         * @see compute( const variable_t& var, variable_t& gradient, T& objective ) const
+         */
+
+        void run( const variable_t& var, metainfo_t &info, variable_t& gradient, T& objective ) const {
+            workspace_t &ws = *info.workspace; info.iter++;
+
+            ws.settle();
+            if( ws.ready ) {
+                ws.ready = false; ws.current = 1 - ws.current;
+            } else {
+                sample( ws, ws.batches[ws.current] );
+            }
+
+            if( prefetch ) {
+                if( !ws.worker ) ws.worker = std::make_unique<worker_t>();
+                ws.worker->post( [this, &ws]() { sample( ws, ws.batches[1 - ws.current] ); } );
+            }
+
+            const batch_t &b = ws.batches[ws.current];
+            step( var, b, ws, gradient, objective );
+        }
+
+        /**
+         * @brief compute function; compute backpropagation over the whole dataset;
+         *          the batches are split over threads with one accumulator each
+         * @param var current position
+         * @param gradient the computed gradients; the return value
+         * @param objective the loss at the current position
+         */
+
+        void compute( const variable_t& var, variable_t& gradient, T& objective ) const {
+            const size_t B = batches();
+            std::vector<variable_t> gradients( std::max<size_t>( 1, std::min( threads, B ) ),
+                                               generator_t<variable_t>::make( topology, T(0) ) );
+            std::vector<T> objectives( gradients.size(), 0 );
+
+            parallel_for( B, gradients.size(), [&]( const size_t p, const size_t begin, const size_t end ) {
+                auto workspace = std::make_unique<workspace_t>();
+                for( size_t i = begin; i < end ; i++) {
+                    const size_t first = i*batchsize();
+                    const size_t size = std::min( batchsize(), training_data.samples() - first );
+
+                    auto input = blaze::submatrix( training_data.icols, 0UL, first, topology.front(), size );
+
+                    if( training_data.labeled() ) {
+                        auto &labels = workspace->batches[0].labels;
+                        labels.assign( training_data.labels.begin() + first,
+                                       training_data.labels.begin() + first + size );
+                        step( var, input, labels, *workspace, gradients[p], objectives[p] );
+                    } else {
+                        step( var, input, blaze::submatrix( training_data.tcols, 0UL, first, topology.back(), size ),
+                              *workspace, gradients[p], objectives[p] );
+                    }
+                }
+            });
+
+            tree_reduce( gradients, []( variable_t &a, const variable_t &b ) {
+                update_t<T, variable_t>::axpy( a, T(1), b ); } );
+            tree_reduce( objectives, []( T &a, const T &b ) { a += b; } );
+
+            update_t<T, variable_t>::axpy( gradient, T(1), gradients[0] );
+            objective += objectives[0];
+        }
+
+        /**
+         * @brief sample function; draw the next batch from the sampler and gather it
+         * @param ws workspace holding the sampler
+         * @param b the gathered batch; the return value
+         */
+
+        void sample( workspace_t &ws, batch_t &b ) const {
+            if( !ws.sampler )
+                ws.sampler = std::make_unique<batch_sampler_t>( training_data.samples(), batchsize(), shuffle, seed );
+
+            b.valid = ws.sampler->next( ws.indices, false );
+            b.input = blaze::columns( training_data.icols, ws.indices.data(), ws.indices.size() );
+
+            if( training_data.labeled() ) {
+                b.labels.resize( ws.indices.size() );
+                for( size_t j = 0; j < ws.indices.size(); j++ )
+                    b.labels[j] = training_data.labels[ws.indices[j]];
+            } else {
+                b.target = blaze::columns( training_data.tcols, ws.indices.data(), ws.indices.size() );
+            }
+        }
+
+        /**
+         * @brief propagation_weights function; weights in the numerical type of the propagation
+         * @param var current position
+         * @param ws workspace holding the converted copy
+         * @return var itself or the converted copy
+         */
+
+        inline const cvariable_t& propagation_weights( const variable_t& var, workspace_t &ws ) const {
+            if constexpr ( std::is_same<C, T>::value ) {
+                return var;
+            } else {
+                ws.params.resize( var.size() );
+                for( size_t l = 0; l < var.size(); ++l ) {
+                    ws.params[l].weight = var[l].weight;
+                    ws.params[l].bias = var[l].bias;
+                }
+                return ws.params;
+            }
+        }
+
+        /**
+         * @brief step function; compute backpropagation of a gathered batch
+         * @param var current position
+         * @param b the gathered batch; the labels are used if the data is labeled
+         * @param ws activation buffers
+         * @param gradient the computed gradients; the return value
+         * @param objective the loss at the current position
+         */
+
+        void step( const variable_t& var, const batch_t &b, workspace_t &ws,
+                   variable_t& gradient, T& objective ) const {
+            if( training_data.labeled() )
+                step( var, b.input, b.labels, ws, gradient, objective );
+            else
+                step( var, b.input, b.target, ws, gradient, objective );
+        }
+
+        /**
+         * @brief step function; compute backpropagation of a single batch
+         * @param var current position
+         * @param input the input batch
+         * @param target the target batch or the class labels of the batch
+         * @param ws activation buffers
+         * @param gradient the computed gradients; the return value
+         * @param objective the loss at the current position
+         */
+
+        template<typename INPUT, typename TARGET>
+        void step( const variable_t& var, const INPUT &input, const TARGET &target,
+                   workspace_t &ws, variable_t& gradient, T& objective ) const {
+            const size_t size = input.columns();
+
+            const cvariable_t &params = propagation_weights( var, ws );
+
+            forward( params, input, ws );
+
+            const size_t L = params.size();
+
+            // label targets are only reachable with a label loss, the constructor rejects the others
+            if constexpr ( !std::is_same<TARGET, std::vector<size_t>>::value || supports_labels<LOSS>::value )
+                objective += loss.fused( target, ws.z[L-1], ws.delta[L-1], size ) / size;
+
+            backward( params, gradient, input, ws );
+        }
+
+
+
+        /**
+         * @brief product function; output of layer l without bias
+         * @param layers weights and biases at each layer
+         * @param l layer index
+         * @param input view of the input batch; the input of the first layer
+         * @param ws activation buffers; the result is stored in ws.z[l]
+         */
+
+        template<typename INPUT>
+        static inline void product( const cvariable_t &layers, const size_t l,
+                                    const INPUT &input, workspace_t &ws ) {
+            if( l == 0 ) ws.z[l] = layers[l].weight * input;
+            else ws.z[l] = layers[l].weight * ws.x[l];
+        }
+
+        /**
+         * @brief forward function; compute forwardpropagation
+         * @param layers weights and biases at each layer
+         * @param input view of the input batch
+         * @param ws activation buffers; the return value
+         */
+
+        template<typename INPUT>
+        void forward( const cvariable_t &layers, const INPUT &input, workspace_t &ws ) const {
+            [[maybe_unused]] scoped_timer_t<phase_t::FORWARD> timer;
+            const size_t L = layers.size(), size = input.columns();
+
+            ws.x.resize( L ); ws.z.resize( L );
+            ws.delta.resize( L ); ws.deriv.resize( L );
+
+            for( size_t l = 0; l+1 < L; ++l ) {
+                product( layers, l, input, ws );
+                ATYPE<C>::forward_fused( ws.z[l], layers[l].bias, ws.x[l+1], ws.deriv[l] );
+            }
+
+            product( layers, L-1, input, ws );
+            ws.z[L-1] += blaze::expand( layers[L-1].bias, size );
+        }
+
+        /**
+         * @brief backward function; compute backpropagation
+         * @param layers weights and biases at each layer
+         * @param gradient gradient with respect to the weights and biases
+         * @param input view of the input batch
+         * @param ws activation buffers of the forward pass; delta is overwritten
+         */
+
+          template<typename INPUT>
+          void backward( const cvariable_t &layers, variable_t &gradient, const INPUT &input,
+                         workspace_t &ws ) const {
+              [[maybe_unused]] scoped_timer_t<phase_t::BACKWARD> timer;
+              const C size = input.columns();
+
+              for( size_t l = layers.size()-1; l > 0; --l ) {
+                  auto &grad = gradient[l];
+                  grad.bias += blaze::reduce<blaze::rowwise>( ws.delta[l], blaze::Add() ) / size;
+                  grad.weight += ws.delta[l] * blaze::trans( ws.x[l] ) / size;
+
+                  ws.delta[l-1] = ( blaze::trans( layers[l].weight ) * ws.delta[l] ) % ws.deriv[l-1];
+              }
+
+              auto &grad = gradient[0];
+              grad.bias += blaze::reduce<blaze::rowwise>( ws.delta[0], blaze::Add() ) / size;
+              grad.weight += ws.delta[0] * blaze::trans( input ) / size;
+          }
+
+
+    };
+
+}
+
+#endif // __LIPNET_DYNAMIC_BACKPROPAGATION_HPP__
@@ -0,0 +1,555 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_DYNAMIC_BARRIER_HPP__
+#define __LIPNET_DYNAMIC_BARRIER_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <ratio>
+#include <cmath>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/profile.hpp>
+#include <lipnet/tensor.hpp>
+#include <lipnet/variable.hpp>
+
+#include <lipnet/dynamic/network.hpp>
+
+namespace lipnet {
+
+
+    /**
+     * @brief The dynamic_liptrainweights_t struct; weights and t-parameters of the
+     *          barrier training with runtime topology; the counterpart of liptrainweights_t
+     * @tparam T numerical value type
+     */
+
+    template<typename T>
+    struct dynamic_liptrainweights_t {
+        typedef blaze::DynamicVector<T, blaze::columnVector> tvector_t;
+
+        dynamic_weights_t<T> W;
+        /// t-parameter of every hidden layer; t[I] has the dimension of the output of layer I
+        std::vector<tvector_t> t;
+
+        /// number of neurons at each layer
+        std::vector<size_t> topology() const {
+            std::vector<size_t> topo;
+            if( W.empty() ) return topo;
+
+            topo.push_back( W.front().inputs() );
+            for( const auto &layer : W ) topo.push_back( layer.outputs() );
+            return topo;
+        }
+
+        template <class Archive>
+        void save( Archive & ar) const
+        {
+            ar( cereal::make_nvp("topology", topology()) );
+
+            for( size_t I = 0; I < W.size(); ++I )
+                ar( cereal::make_nvp( "l-" + std::to_string( I ), W[I] ) );
+
+            for( size_t I = 0; I < t.size(); ++I )
+                ar( cereal::make_nvp( "t-" + std::to_string( I ), t[I] ) );
+        }
+
+
+        /// deserialize; the weights are sized from the stored topology
+        template <class Archive>
+        void load( Archive & ar )
+        {
+            std::vector<size_t> topo;
+            ar( cereal::make_nvp("topology", topo) );
+
+            W.clear(); t.clear();
+            for( size_t I = 0; I+1 < topo.size(); ++I )
+                W.emplace_back( topo[I], topo[I+1], T(0) );
+            for( size_t I = 1; I+1 < topo.size(); ++I )
+                t.emplace_back( topo[I], T(0) );
+
+            for( size_t I = 0; I < W.size(); ++I )
+                ar( cereal::make_nvp( "l-" + std::to_string( I ), W[I] ) );
+
+            for( size_t I = 0; I < t.size(); ++I )
+                ar( cereal::make_nvp( "t-" + std::to_string( I ), t[I] ) );
+        }
+
+    };
+
+
+
+    template<typename T>
+    struct generator_t<dynamic_liptrainweights_t<T>> {
+        static inline dynamic_liptrainweights_t<T> make( const std::vector<size_t> &topology, T val, T uni ) {
+            dynamic_liptrainweights_t<T> res;
+            res.W = generator_t<dynamic_weights_t<T>>::make( topology, val );
+            for( size_t I = 1; I+1 < topology.size(); ++I )
+                res.t.emplace_back( topology[I], uni );
+            return res;
+        }
+    };
+
+
+    template<typename T>
+    struct norm_t<T, dynamic_liptrainweights_t<T>> {
+        static inline T norm( const dynamic_liptrainweights_t<T> &m ) {
+            T res = norm_t<T, dynamic_weights_t<T>>::norm( m.W );
+            for( const auto &t : m.t ) res += blaze::norm( t );
+            return res;
+        }
+    };
+
+
+    template<typename T>
+    struct function_t<dynamic_liptrainweights_t<T>> {
+        static inline dynamic_liptrainweights_t<T> square( const dynamic_liptrainweights_t<T> &m ) {
+            dynamic_liptrainweights_t<T> res{ function_t<dynamic_weights_t<T>>::square( m.W ), {} };
+            for( const auto &t : m.t ) res.t.emplace_back( blaze::pow( t, 2 ) );
+            return res;
+        }
+
+        static inline dynamic_liptrainweights_t<T> sqrt( const dynamic_liptrainweights_t<T> &m ) {
+            dynamic_liptrainweights_t<T> res{ function_t<dynamic_weights_t<T>>::sqrt( m.W ), {} };
+            for( const auto &t : m.t ) res.t.emplace_back( blaze::sqrt( t ) );
+            return res;
+        }
+    };
+
+
+    /**
+     * @brief The update_t struct for dynamic_liptrainweights_t; empty targets are shaped
+     *        like the argument
+     * @see lipnet::update_t<T, dynamic_layer_t<T>>
+     */
+
+    template<typename T>
+    struct update_t<T, dynamic_liptrainweights_t<T>> {
+        typedef typename dynamic_liptrainweights_t<T>::tvector_t tvector_t;
+        typedef update_t<T, dynamic_weights_t<T>> wupdate_t;
+        typedef dense_update_t<T, tvector_t> tupdate_t;
+
+        /// resize y to the dimensions of x; new values are zero
+        static inline void shape( std::vector<tvector_t> &y, const std::vector<tvector_t> &x ) {
+            if( y.size() != x.size() ) y.resize( x.size() );
+            for( size_t I = 0; I < x.size(); ++I )
+                if( y[I].size() != x[I].size() ) {
+                    y[I].resize( x[I].size(), false ); y[I] = 0;
+                }
+        }
+
+        static inline void scale_add( dynamic_liptrainweights_t<T> &y, const T a,
+                                      const dynamic_liptrainweights_t<T> &x, const T b ) {
+            wupdate_t::scale_add( y.W, a, x.W, b );
+            shape( y.t, x.t );
+            for( size_t I = 0; I < x.t.size(); ++I ) tupdate_t::scale_add( y.t[I], a, x.t[I], b );
+        }
+
+        static inline void scale_add_square( dynamic_liptrainweights_t<T> &y, const T a,
+                                             const dynamic_liptrainweights_t<T> &x, const T b ) {
+            wupdate_t::scale_add_square( y.W, a, x.W, b );
+            shape( y.t, x.t );
+            for( size_t I = 0; I < x.t.size(); ++I ) tupdate_t::scale_add_square( y.t[I], a, x.t[I], b );
+        }
+
+        static inline void axpy( dynamic_liptrainweights_t<T> &y, const T a, const dynamic_liptrainweights_t<T> &x ) {
+            wupdate_t::axpy( y.W, a, x.W );
+            shape( y.t, x.t );
+            for( size_t I = 0; I < x.t.size(); ++I ) tupdate_t::axpy( y.t[I], a, x.t[I] );
+        }
+
+        static inline void adam_direction( dynamic_liptrainweights_t<T> &d, const dynamic_liptrainweights_t<T> &m,
+                                           const dynamic_liptrainweights_t<T> &v, const T c1, const T c2, const T eps ) {
+            wupdate_t::adam_direction( d.W, m.W, v.W, c1, c2, eps );
+            shape( d.t, m.t );
+            for( size_t I = 0; I < m.t.size(); ++I ) tupdate_t::adam_direction( d.t[I], m.t[I], v.t[I], c1, c2, eps );
+        }
+    };
+
+
+    template<typename T>
+    struct prod_t<T, dynamic_liptrainweights_t<T>, dynamic_liptrainweights_t<T>> {
+        static inline T inner( const dynamic_liptrainweights_t<T> &m1, const dynamic_liptrainweights_t<T> &m2 ) {
+            T res = prod_t<T, dynamic_weights_t<T>, dynamic_weights_t<T>>::inner( m1.W, m2.W );
+            for( size_t I = 0; I < m1.t.size(); ++I ) res += blaze::inner( m1.t[I], m2.t[I] );
+            return res;
+        }
+    };
+
+
+
+
+
+
+
+    /**
+     * @brief implementation of the log barrier function with runtime topology; the
+     *          block recursions of barrierfunction_t as loops over the layers, linear
+     *          in the depth of the network
+     *
+     *          @f[ \mu(W,T) = - \log \det ( \chi(\Psi^2,W,T) )  @f]
+     *
+     * @tparam T numerical value type
+     */
+
+    template<typename T>
+    struct dynamic_barrierfunction_t {
+
+        typedef blaze::DynamicMatrix<T, blaze::rowMajor> dmatrix_t;
+        typedef blaze::DynamicVector<T, blaze::columnVector> dvector_t;
+
+        typedef blaze::IdentityMatrix<T> eye;
+
+        typedef dynamic_liptrainweights_t<T> variable_t;
+
+        /**
+         * @brief block cholesky decomposition of chi; the first diagonal block is
+         *          lipschitz times identity with the scalar factor d0, D[0] is not used
+         */
+
+        struct cholesky_t {
+            T d0 = 0;
+            std::vector<dmatrix_t> D, L;
+        };
+
+        /**
+         * @brief parts of the inverse needed by the gradient; the subdiagonal
+         *          blocks K and the diagonals of the diagonal blocks P, where
+         *          p[I] holds the diagonal of P[I+1]
+         */
+
+        struct terms_t {
+            std::vector<dmatrix_t> K;
+            std::vector<dvector_t> p;
+        };
+
+        /**
+         * @brief cache of the last cholesky decomposition and gradient terms; kept in the
+         *          metainfo of the problem
+         */
+
+        struct cache_t {
+            bool valid = false;
+            T lipschitz = 0;
+            variable_t var;
+            cholesky_t L; terms_t G;
+
+            /// statistics: reused and recomputed decompositions
+            size_t hits = 0, misses = 0;
+        };
+
+
+        /// lipschitz constant
+        T lipschitz;
+
+        /// smallest probed stepsize of the feasibility check is limit / 2^bisections
+        size_t bisections = 30;
+
+        /// relative accuracy of the stepsize returned by the feasibility check
+        T tolerance = 1e-3;
+
+        /// maximal stepsize returned by the feasibility check
+        T limit = 1e3;
+
+
+        /**
+         * @brief dynamic_barrierfunction_t; default constructor
+         * @param lipschitz lipschitz constant
+         */
+
+        explicit dynamic_barrierfunction_t( const T lipschitz = 70.0 )
+            : lipschitz{ lipschitz } {}
+
+
+        /**
+         * @brief compute gradients
+         * @param var current position
+         * @param gradient reuturn value gradient; sized like var
+         * @param gamma hyperparameter of barrier function
+         */
+
+        cholesky_t compute( const variable_t& var,  variable_t& gradient, const T& gamma ) const {
+            cache_t cache;
+            compute( var, gradient, gamma, cache );
+            return std::move( cache.L );
+        }
+
+        /**
+         * @brief compute gradients; reuse the decomposition of the cache where possible
+         * @param var current position
+         * @param gradient reuturn value gradient; sized like var
+         * @param gamma hyperparameter of barrier function
+         * @param cache decomposition of the previous call
+         * @see factorise( const T lipschitz, const variable_t &var, cache_t &cache )
+         */
+
+        const cholesky_t& compute( const variable_t& var,  variable_t& gradient, const T& gamma,
+                                   cache_t &cache ) const {
+            const size_t L = var.W.size();
+
+            factorise( lipschitz, var, cache );
+            const terms_t &G = cache.G;
+
+            for( size_t I = 0; I < L; ++I ) {
+                auto& grad = gradient.W[I].weight;
+
+                if( I < L-1 )
+                    grad += 2*gamma*( blaze::expand( var.t[I], var.W[I].inputs() ) % G.K[I] );
+                else
+                    grad += 2*gamma*G.K[I];
+            }
+
+            for( size_t I = 0; I+1 < L; ++I )
+                gradient.t[I] += 2*( blaze::diagonal( G.K[I]*blaze::trans( var.W[I].weight ) ) - G.p[I] );
+
+            return cache.L;
+        }
+
+
+        /**
+         * @brief execute cholesky decomposition
+         * @tparam numeric_stability enable/disable numerical offset
+         * @tparam kondition numerical offset
+         * @param lipschitz lipschitz constant
+         * @param var current position
+         */
+
+        template<bool numeric_stability = true, typename kondition = std::ratio<1,100>,
+                 typename = typename std::enable_if<kondition::den != 0>::type>
+        inline cholesky_t chol( const T lipschitz, const variable_t &var ) const {
+            cholesky_t value;
+            chol_blocks<numeric_stability, kondition>( lipschitz, var, value );
+            return std::move( value );
+        }
+
+        /**
+         * @brief execute cholesky decomposition in place
+         * @tparam numeric_stability enable/disable numerical offset
+         * @tparam kondition numerical offset
+         * @param lipschitz lipschitz constant
+         * @param var current position; at least one hidden layer
+         * @param value cholesky decomposition; the return value
+         */
+
+        template<bool numeric_stability = true, typename kondition = std::ratio<1,100>,
+                 typename = typename std::enable_if<kondition::den != 0>::type>
+        inline void chol_blocks( const T lipschitz, const variable_t &var,
+                                 cholesky_t &value ) const {
+            [[maybe_unused]] scoped_timer_t<phase_t::CHOL> timer;
+            constexpr T ratio = ( (T) kondition::num )/( (T) kondition::den );
+
+            const size_t LN = var.W.size() - 1;
+            if( var.W.size() < 2 || var.t.size() != LN )
+                throw std::string{"barrier needs at least one hidden layer"};
+
+            value.D.resize( LN+2 ); value.L.resize( LN+1 );
+
+            value.d0 = lipschitz;
+            value.L[0] = -( blaze::expand( var.t[0], var.W[0].inputs() ) % var.W[0].weight ) / lipschitz;
+
+            for( size_t I = 1; I < LN; ++I ) {
+                const size_t n = var.W[I].inputs();
+
+                dmatrix_t X( n, n, T(0) ); blaze::diagonal( X ) = 2*var.t[I-1];
+                X -= value.L[I-1] * blaze::trans( value.L[I-1] );
+
+                if constexpr ( numeric_stability )
+                    X += ratio*eye( n );
+
+                blaze::llh( X, value.D[I] );
+
+                dmatrix_t Z = blaze::trans( blaze::expand( var.t[I], n ) % var.W[I].weight );
+                value.L[I] = - blaze::trans( blaze::solve( blaze::decllow( value.D[I] ), Z ) );
+            }
+
+            const size_t n = var.W[LN].inputs(), m = var.W[LN].outputs();
+
+            dmatrix_t X1( n, n, T(0) ); blaze::diagonal( X1 ) = 2*var.t[LN-1];
+            X1 -= value.L[LN-1] * blaze::trans( value.L[LN-1] );
+
+            if constexpr ( numeric_stability )
+                X1 += ratio*eye( n );
+
+            blaze::llh( X1, value.D[LN] );
+
+            value.L[LN] = - blaze::trans( blaze::solve( blaze::decllow( value.D[LN] ),
+                                                        dmatrix_t( blaze::trans( var.W[LN].weight ) ) ) );
+
+            dmatrix_t X2 = eye( m );
+
+            if constexpr ( numeric_stability )
+                X2 += ratio*eye( m );
+
+            X2 -= value.L[LN] * blaze::trans( value.L[LN] );
+            blaze::llh( X2, value.D[LN+1] );
+        }
+
+        /**
+         * @brief compare weights and t-parameters of two positions
+         * @param var current position
+         * @param old position of the cached decomposition
+         * @return true if nothing changed
+         */
+
+        inline bool unchanged( const variable_t &var, const variable_t &old ) const {
+            if( old.W.size() != var.W.size() || old.t.size() != var.t.size() ) return false;
+
+            for( size_t I = 0; I < var.W.size(); ++I )
+                if( var.W[I].weight != old.W[I].weight ) return false;
+
+            for( size_t I = 0; I < var.t.size(); ++I )
+                if( var.t[I] != old.t[I] ) return false;
+
+            return true;
+        }
+
+        /**
+         * @brief cholesky decomposition and gradient terms with cache. The cache serves
+         *          re-evaluations at an unchanged position; every step of the optimizer
+         *          changes the first block (W0), thus a moved position is always
+         *          factorised completely.
+         * @param lipschitz lipschitz constant
+         * @param var current position
+         * @param cache cache of the previous call; updated
+         * @see barrierfunction_t::factorise
+         */
+
+        inline void factorise( const T lipschitz, const variable_t &var, cache_t &cache ) const {
+            if( cache.valid && cache.lipschitz == lipschitz && unchanged( var, cache.var ) ) {
+                cache.hits++; return;
+            }
+
+            cache.misses++;
+            chol_blocks( lipschitz, var, cache.L );
+            cache.G = terms( cache.L );
+            cache.var = var; cache.lipschitz = lipschitz; cache.valid = true;
+        }
+
+
+        /**
+         * @brief compute the gradient terms from the cholesky factors
+         * @param val cholesky decomposition (e.g L)
+         * @see barrierfunction_t::terms( const cholesky_t &val )
+         */
+
+        inline terms_t terms( const cholesky_t &val ) const {
+            [[maybe_unused]] scoped_timer_t<phase_t::TERMS> timer;
+            const size_t LN = val.L.size() - 1;
+
+            terms_t res;
+            res.K.resize( LN+1 ); res.p.resize( LN );
+
+            // diagonal block of the inverse behind the current one
+            dmatrix_t Pp;
+            {
+                dmatrix_t Dinv = val.D[LN+1];
+                blaze::invert( Dinv );
+                Pp = blaze::trans( Dinv ) * Dinv;
+            }
+
+            for( size_t I = LN; I > 0; --I ) {
+                const dmatrix_t &L = val.L[I];
+                const dmatrix_t &D = val.D[I];
+
+                dmatrix_t tmp = blaze::solve( blaze::declupp( blaze::trans(D) ), blaze::trans(L) );
+                res.K[I] = -blaze::trans( tmp*Pp );
+
+                dmatrix_t Dinv = D;
+                blaze::invert( Dinv );
+
+                dmatrix_t P = blaze::trans( Dinv ) * Dinv - blaze::trans( tmp*res.K[I] );
+                res.p[I-1] = blaze::diagonal( P );
+                Pp = std::move( P );
+            }
+
+            res.K[0] = - blaze::trans( Pp ) * val.L[0] / val.d0;
+
+            return std::move( res );
+        }
+
+
+        /**
+         * @brief test if chi is positive definite; the decomposition without numerical offset
+         * @param rho squared lipschitz constant
+         * @param var weights and t-parameters
+         */
+
+        bool definite( const T rho, const variable_t &var ) const {
+            if( !( rho > 0 ) ) return false;
+
+            cholesky_t value;
+            try {
+                chol_blocks<false>( std::sqrt( rho ), var, value );
+            }
+            catch( const std::exception& ) { return false; }
+
+            return true;
+        }
+
+        /**
+         * @brief maximal stepsize alpha in (0, limit] for which pos - alpha*dir is
+         *          feasible; the interval is expanded from limit / 2^bisections upwards
+         *          and the first infeasible probe is bisected, thus infeasible gaps of
+         *          the quadratic chi( alpha ) are not skipped
+         * @param pos current position
+         * @param dir update direction
+         * @param rho squared lipschitz constant
+         * @see chi_definite_t::bisect
+         */
+
+        T maximal_step( const variable_t &pos, const variable_t &dir, const T rho ) const {
+            [[maybe_unused]] scoped_timer_t<phase_t::FEASIBILITY> timer;
+            // one trial position for all probes; the assignment keeps its storage
+            variable_t x;
+            const auto feasible = [&]( const T alpha ){
+                x = pos;
+                update_t<T,variable_t>::axpy( x, -alpha, dir );
+                return definite( rho, x );
+            };
+
+            T lo = 0, hi = std::ldexp( limit, -int( bisections ) );
+
+            while( feasible( hi ) ) {
+                if( hi >= limit ) return limit;
+                lo = hi; hi = std::min( 2*hi, limit );
+            }
+
+            if( lo == 0 ) return lo;
+
+            while( hi - lo > tolerance*hi ) {
+                const T mid = ( lo + hi ) / 2;
+                if( feasible( mid ) ) lo = mid;
+                else hi = mid;
+            }
+
+            return lo;
+        }
+
+    };
+
+}
+
+#endif // __LIPNET_DYNAMIC_BARRIER_HPP__
@@ -0,0 +1,461 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_DYNAMIC_NETWORK_HPP__
+#define __LIPNET_DYNAMIC_NETWORK_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <sstream>
+
+
+#include <cereal/cereal.hpp>
+
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/xml.hpp>
+
+#include <cereal/types/vector.hpp>
+#include <cereal/types/array.hpp>
+
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+#include <lipnet/variable.hpp>
+#include <lipnet/parallel.hpp>
+
+#include <lipnet/network/layer.hpp>
+#include <lipnet/network/activation.hpp>
+
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief parse_topology function; read a topology like "2,10,10,3"
+     * @param spec comma separated number of neurons at each layer
+     * @return topology; at least an input and an output layer
+     */
+
+    inline std::vector<size_t> parse_topology( const std::string &spec ) {
+        std::vector<size_t> topology;
+        std::istringstream is( spec );
+        std::string cell;
+
+        while( std::getline( is, cell, ',' ) ) {
+            const long value = std::stol( cell );
+            if( value <= 0 )
+                throw std::string{"invalid layer size in topology: "} + spec;
+            topology.push_back( value );
+        }
+
+        if( topology.size() < 2 )
+            throw std::string{"topology needs an input and an output layer: "} + spec;
+
+        return topology;
+    }
+
+
+
+    /**
+     * @brief The dynamic_layer_t struct; layer with runtime dimensions; the
+     *        runtime counterpart of layer_t with the same serialization
+     * @tparam T numerical value type
+     */
+
+    template<typename T>
+    struct dynamic_layer_t {
+
+        typedef blaze::DynamicMatrix<T, blaze::rowMajor> MT;
+        typedef blaze::DynamicVector<T, blaze::columnVector> VT;
+
+        MT weight; VT bias;
+
+        dynamic_layer_t() = default;
+
+        inline dynamic_layer_t( MT&& w, VT&& b )
+            : weight{ std::move(w) }, bias{ std::move(b) } {}
+
+        /**
+         * @brief The dynamic_layer_t constructor; initilize weight and bias with random values
+         * @param I input dimension
+         * @param O output dimension
+         * @param var some kind of variance; zero initialises with zeros
+         */
+
+        dynamic_layer_t( const size_t I, const size_t O, const T &var = 0 )
+            : weight( O, I, T(0) ), bias( O, T(0) ) {
+            if( var == T(0) ) return;
+
+            make_random( bias.begin(), bias.end(), -var, var );
+            for( size_t i = 0; i < O; ++i )
+                make_random( weight.begin(i), weight.end(i), -var, var );
+        }
+
+        /// input dimension
+        inline size_t inputs() const { return weight.columns(); }
+
+        /// output dimension
+        inline size_t outputs() const { return weight.rows(); }
+
+        /// @brief serialize dynamic_layer_t; the matrices have to be sized when loading
+        template <class Archive>
+        void serialize( Archive & ar)
+        {
+            ar( cereal::make_nvp("weight", weight ) );
+            ar( cereal::make_nvp("bias", bias ) );
+        }
+
+    };
+
+
+    /**
+     * @brief weights and biases of a network with runtime topology; one entry per layer
+     * @tparam T numerical value type
+     */
+
+    template<typename T>
+    using dynamic_weights_t = std::vector<dynamic_layer_t<T>>;
+
+
+
+
+    template<typename T>
+    struct generator_t<dynamic_layer_t<T>> {
+        static inline dynamic_layer_t<T> make( const size_t I, const size_t O, T val ) {
+            return dynamic_layer_t<T>( I, O, val );
+        }
+    };
+
+
+    template<typename T>
+    struct generator_t<dynamic_weights_t<T>> {
+        static inline dynamic_weights_t<T> make( const std::vector<size_t> &topology, T val ) {
+            dynamic_weights_t<T> res;
+            for( size_t l = 0; l+1 < topology.size(); ++l )
+                res.emplace_back( topology[l], topology[l+1], val );
+            return res;
+        }
+    };
+
+
+    template<typename T>
+    struct norm_t<T, dynamic_layer_t<T>> {
+        static inline T norm( const dynamic_layer_t<T> &m ) {
+            return blaze::norm( m.weight ) + blaze::norm( m.bias );
+        }
+    };
+
+
+    template<typename T>
+    struct norm_t<T, dynamic_weights_t<T>> {
+        static inline T norm( const dynamic_weights_t<T> &m ) {
+            T res = 0;
+            for( const auto &layer : m ) res += norm_t<T, dynamic_layer_t<T>>::norm( layer );
+            return res;
+        }
+    };
+
+
+    template<typename T>
+    struct function_t<dynamic_layer_t<T>> {
+        static inline dynamic_layer_t<T> square( const dynamic_layer_t<T> &m ) {
+            return dynamic_layer_t<T>( blaze::pow(m.weight,2), blaze::pow(m.bias,2) );
+        }
+
+        static inline dynamic_layer_t<T> sqrt( const dynamic_layer_t<T> &m ) {
+            return dynamic_layer_t<T>( blaze::sqrt(m.weight), blaze::sqrt(m.bias) );
+        }
+    };
+
+
+    template<typename T>
+    struct function_t<dynamic_weights_t<T>> {
+        static inline dynamic_weights_t<T> square( const dynamic_weights_t<T> &m ) {
+            dynamic_weights_t<T> res;
+            for( const auto &layer : m ) res.push_back( function_t<dynamic_layer_t<T>>::square( layer ) );
+            return res;
+        }
+
+        static inline dynamic_weights_t<T> sqrt( const dynamic_weights_t<T> &m ) {
+            dynamic_weights_t<T> res;
+            for( const auto &layer : m ) res.push_back( function_t<dynamic_layer_t<T>>::sqrt( layer ) );
+            return res;
+        }
+    };
+
+
+    /**
+     * @brief The update_t struct for dynamic_layer_t; the optimisers default construct
+     *        the moments, so an empty target is shaped like the argument and zeroed first
+     * @see lipnet::dense_update_t
+     */
+
+    template<typename T>
+    struct update_t<T, dynamic_layer_t<T>> {
+        typedef dense_update_t<T, typename dynamic_layer_t<T>::MT> wupdate_t;
+        typedef dense_update_t<T, typename dynamic_layer_t<T>::VT> bupdate_t;
+
+        /// resize y to the dimensions of x; new values are zero
+        static inline void shape( dynamic_layer_t<T> &y, const dynamic_layer_t<T> &x ) {
+            if( y.weight.rows() != x.weight.rows() || y.weight.columns() != x.weight.columns() ) {
+                y.weight.resize( x.weight.rows(), x.weight.columns(), false ); y.weight = 0;
+            }
+            if( y.bias.size() != x.bias.size() ) {
+                y.bias.resize( x.bias.size(), false ); y.bias = 0;
+            }
+        }
+
+        static inline void scale_add( dynamic_layer_t<T> &y, const T a, const dynamic_layer_t<T> &x, const T b ) {
+            shape( y, x );
+            wupdate_t::scale_add( y.weight, a, x.weight, b );
+            bupdate_t::scale_add( y.bias, a, x.bias, b );
+        }
+
+        static inline void scale_add_square( dynamic_layer_t<T> &y, const T a, const dynamic_layer_t<T> &x, const T b ) {
+            shape( y, x );
+            wupdate_t::scale_add_square( y.weight, a, x.weight, b );
+            bupdate_t::scale_add_square( y.bias, a, x.bias, b );
+        }
+
+        static inline void axpy( dynamic_layer_t<T> &y, const T a, const dynamic_layer_t<T> &x ) {
+            shape( y, x );
+            wupdate_t::axpy( y.weight, a, x.weight );
+            bupdate_t::axpy( y.bias, a, x.bias );
+        }
+
+        static inline void adam_direction( dynamic_layer_t<T> &d, const dynamic_layer_t<T> &m, const dynamic_layer_t<T> &v,
+                                           const T c1, const T c2, const T eps ) {
+            shape( d, m );
+            wupdate_t::adam_direction( d.weight, m.weight, v.weight, c1, c2, eps );
+            bupdate_t::adam_direction( d.bias, m.bias, v.bias, c1, c2, eps );
+        }
+    };
+
+
+    /**
+     * @brief The update_t struct for dynamic_weights_t; layer by layer
+     * @see lipnet::update_t<T, dynamic_layer_t<T>>
+     */
+
+    template<typename T>
+    struct update_t<T, dynamic_weights_t<T>> {
+        typedef update_t<T, dynamic_layer_t<T>> lupdate_t;
+
+        static inline void shape( dynamic_weights_t<T> &y, const dynamic_weights_t<T> &x ) {
+            if( y.size() != x.size() ) y.resize( x.size() );
+        }
+
+        static inline void scale_add( dynamic_weights_t<T> &y, const T a, const dynamic_weights_t<T> &x, const T b ) {
+            shape( y, x );
+            for( size_t l = 0; l < x.size(); ++l ) lupdate_t::scale_add( y[l], a, x[l], b );
+        }
+
+        static inline void scale_add_square( dynamic_weights_t<T> &y, const T a, const dynamic_weights_t<T> &x, const T b ) {
+            shape( y, x );
+            for( size_t l = 0; l < x.size(); ++l ) lupdate_t::scale_add_square( y[l], a, x[l], b );
+        }
+
+        static inline void axpy( dynamic_weights_t<T> &y, const T a, const dynamic_weights_t<T> &x ) {
+            shape( y, x );
+            for( size_t l = 0; l < x.size(); ++l ) lupdate_t::axpy( y[l], a, x[l] );
+        }
+
+        static inline void adam_direction( dynamic_weights_t<T> &d, const dynamic_weights_t<T> &m, const dynamic_weights_t<T> &v,
+                                           const T c1, const T c2, const T eps ) {
+            shape( d, m );
+            for( size_t l = 0; l < m.size(); ++l ) lupdate_t::adam_direction( d[l], m[l], v[l], c1, c2, eps );
+        }
+    };
+
+
+    template<typename T>
+    struct prod_t<T, dynamic_layer_t<T>, dynamic_layer_t<T>> {
+        static inline T inner( const dynamic_layer_t<T> &m1, const dynamic_layer_t<T> &m2 ) {
+            return blaze::inner( m1.weight , m2.weight ) + blaze::inner( m1.bias, m2.bias);
+        }
+    };
+
+
+    template<typename T>
+    struct prod_t<T, dynamic_weights_t<T>, dynamic_weights_t<T>> {
+        static inline T inner( const dynamic_weights_t<T> &m1, const dynamic_weights_t<T> &m2 ) {
+            T res = 0;
+            for( size_t l = 0; l < m1.size(); ++l )
+                res += prod_t<T, dynamic_layer_t<T>, dynamic_layer_t<T>>::inner( m1[l], m2[l] );
+            return res;
+        }
+    };
+
+
+
+
+
+
+
+    /**
+     * @brief The dynamic_network_t struct; neural network with a topology read at
+     *          runtime, e.g. from the command line or the model file. Same model
+     *          format as network_t, so models are exchangeable between both. The
+     *          compile-time network_t is faster for small networks.
+     * @tparam T numerical value type
+     * @tparam ATYPE activation function type
+     */
+
+    template<typename T, template<typename> typename ATYPE>
+    struct dynamic_network_t {
+
+        typedef dynamic_weights_t<T> layer_t;
+
+        typedef blaze::DynamicMatrix<T, blaze::rowMajor> dmatrix_t;
+        typedef blaze::DynamicVector<T, blaze::columnVector> dvector_t;
+
+
+        /// serialization helper struct
+        template<bool saveing = true> struct data_serialization_t {
+            using value_t = typename std::conditional<saveing,
+                            const layer_t, layer_t>::type; value_t &layersdata;
+
+            template<class Archive> void serialize(Archive &ar)
+                { cereal::size_type number = layersdata.size();
+                  ar( cereal::make_size_tag(number) );
+                  if constexpr ( !saveing )
+                      if( number != layersdata.size() ) throw std::string{"wrong topology"};
+                  for( auto &layer : layersdata ) ar( layer ); }};
+
+
+        /// number of neurons at each layer
+        std::vector<size_t> topology;
+
+        /// weights and biases
+        layer_t layers;
+
+
+        dynamic_network_t() = default;
+
+        /**
+         * @brief dynamic_network_t; network of the given topology
+         * @param topo number of neurons at each layer
+         * @param var variance of the random initialisation; zero initialises with zeros
+         */
+
+        explicit dynamic_network_t( std::vector<size_t> topo, const T var = 0 )
+            : topology{ std::move(topo) } {
+            if( topology.size() < 2 )
+                throw std::string{"topology needs an input and an output layer"};
+            layers = generator_t<layer_t>::make( topology, var );
+        }
+
+        /// number of layers
+        inline size_t depth() const { return layers.size(); }
+
+
+        /**
+         * @brief query the neural network
+         *                  @f[  z_l = W_l x_l \quad x_{l+1} = \sigma(z_l) \quad \cdots  @f]
+         * @param input vector
+         * @return output vector
+         */
+
+        template<typename VT>
+        dvector_t query( const VT& input ) const {
+            dmatrix_t in( input.size(), 1 );
+            blaze::column( in, 0 ) = input;
+            return blaze::column( propagate( in ), 0 );
+        }
+
+        /**
+         * @brief query the neural network with a batch of inputs; every layer is one
+         *          matrix product over the batch
+         * @param input inputs; one sample per column
+         * @param threads number of threads; the columns are split in contiguous blocks
+         * @return outputs; one sample per column
+         */
+
+        template<typename MT>
+        dmatrix_t query_batch( const MT &input, const size_t threads = 1 ) const {
+            if( layers.empty() || input.rows() != topology.front() )
+                throw std::string{"wrong input dimension"};
+
+            dmatrix_t output( topology.back(), input.columns() );
+
+            parallel_for( input.columns(), threads, [&]( const size_t, const size_t begin, const size_t end ) {
+                blaze::submatrix( output, 0UL, begin, topology.back(), end-begin ) =
+                        propagate( blaze::submatrix( input, 0UL, begin, topology.front(), end-begin ) );
+            });
+
+            return output;
+        }
+
+        /**
+         * @brief propagate a batch of inputs through the layers
+         * @param input inputs; one sample per column
+         * @return outputs; one sample per column
+         */
+
+        template<typename MT>
+        dmatrix_t propagate( const MT &input ) const {
+            dmatrix_t x( input ), z;
+
+            for( size_t l = 0; l+1 < layers.size(); ++l ) {
+                z = layers[l].weight * x + blaze::expand( layers[l].bias, x.columns() );
+                // the dimensions only select the static result types
+                x = ATYPE<T>::template forward<0,0>( z );
+            }
+
+            const auto &layer = layers.back();
+            return layer.weight * x + blaze::expand( layer.bias, x.columns() );
+        }
+
+
+
+        /// serialize network
+        template <class Archive>
+        void save( Archive & ar) const
+        {
+            typedef data_serialization_t<true> serilizable_t;
+            ar( cereal::make_nvp("topology", topology ) );
+            ar( cereal::make_nvp("data", serilizable_t{layers} ) );
+        }
+
+        /// deserialize network; the layers are sized from the stored topology
+        template <class Archive>
+        void load( Archive & ar )
+        {
+            typedef data_serialization_t<false> serilizable_t;
+
+            ar( cereal::make_nvp("topology", topology) );
+            if( topology.size() < 2 || std::count( topology.begin(), topology.end(), size_t(0) ) > 0 )
+                throw std::string{"wrong topology"};
+
+            layers = generator_t<layer_t>::make( topology, T(0) );
+            ar( cereal::make_nvp("data", serilizable_t{layers} ) );
+        }
+
+    };
+
+}
+
+#endif // __LIPNET_DYNAMIC_NETWORK_HPP__
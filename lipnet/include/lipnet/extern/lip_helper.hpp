@@ -45,6 +45,8 @@
 #include <fusion.h>
 #include <mosek.h>
 
+#include <lipnet/parallel.hpp>
+
 using namespace mosek;
 
 
@@ -52,6 +54,20 @@ using namespace mosek;
 namespace lipnet {
 
 
+    /**
+     * @brief apply the configured number of mosek threads to a model
+     * @param M mosek model
+     * @see lipnet::resources_t
+     */
+
+    template<typename MODEL>
+    inline void configure_model( MODEL &M ) {
+        if( resources().solver > 0 )
+            M->setSolverParam( "numThreads", (int) resources().solver );
+    }
+
+
+
     template<size_t START, size_t... Ints, size_t... Seq>
     constexpr size_t sum_from_to_(std::integral_constant<size_t,START>,
                           std::integer_sequence<size_t, Ints...>,
@@ -181,6 +197,74 @@ namespace lipnet {
         return fusion::Expr::add( tmp , constQ );
     }
 
+    /**
+     * @brief sparse selection matrix; ones at (roff+i, coff+i) for i < k
+     * @param r rows
+     * @param c columns
+     * @param roff row offset
+     * @param coff column offset
+     * @param k number of ones
+     */
+
+    inline auto block_select( size_t r, size_t c, size_t roff, size_t coff, size_t k ) {
+        auto values = monty::new_array_ptr<double,1>( k );
+        auto rindex = monty::new_array_ptr<int,1>( k );
+        auto cindex = monty::new_array_ptr<int,1>( k );
+
+        for( size_t i=0UL; i< k; ++i ) {
+            (*values)[i] = 1.0; (*rindex)[i] = roff+i; (*cindex)[i] = coff+i; }
+
+        return fusion::Matrix::sparse( (int) r, (int) c, rindex, cindex, values );
+    }
+
+
+    /**
+     * @brief copy a blaze matrix into a dense fusion array; e.g. for parameter values
+     * @param m matrix
+     */
+
+    template<typename MT>
+    auto dense_array( const MT &m ) {
+        auto values = monty::new_array_ptr<double,2>(
+                    monty::shape( (int) m.rows(), (int) m.columns() ) );
+
+        for( size_t i=0UL; i< m.rows(); ++i )
+            for( size_t j=0UL; j< m.columns(); ++j )
+                (*values)(i,j) = m(i,j);
+
+        return values;
+    }
+
+
+    /**
+     * @brief parametrised version of block_diag_q; the weight dependent block is a
+     *          fusion parameter which can be updated between solves
+     * @param Q parameter of the last block (e.g. trans(W)*W)
+     * @param L variable of the squared lipschitz constant
+     */
+
+    template<size_t ...N>
+    auto block_diag_q( std::integer_sequence<size_t,N...>, fusion::Parameter::t &Q, fusion::Variable::t &L) {
+        constexpr size_t n = sum_from_to<0, sizeof... (N)-1, N...>();
+        constexpr size_t q = at<0,N...>();
+        constexpr size_t k = at<sizeof... (N)-2, N...>();
+
+        auto valuesq = monty::new_array_ptr<double,1>( q );
+        auto rindexq = monty::new_array_ptr<int,1>( q );
+        auto cindexq = monty::new_array_ptr<int,1>( q );
+
+        for(int i = 0; i < q ; ++i){
+            (*valuesq)[i] = -1; (*rindexq)[i] = i; (*cindexq)[i] = i;}
+
+        auto varQ = fusion::Matrix::sparse(n, n, rindexq, cindexq, valuesq);
+        auto S = block_select( k, n, 0, n-k, k );
+
+        auto tmp = fusion::Expr::mulElm(  fusion::Expr::repeat( fusion::Expr::repeat(L, n, 1)  , n, 0) , varQ );
+
+        return fusion::Expr::add( tmp , fusion::Expr::mul( S->transpose(), fusion::Expr::mul( Q, S ) ) );
+    }
+
+
     auto zeros( size_t r, size_t c) {
         return fusion::Expr::repeat( fusion::Expr::zeros(r), c, 1 );
     }
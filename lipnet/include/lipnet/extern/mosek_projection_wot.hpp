@@ -30,6 +30,7 @@
 #include <deque>
 
 #include <lipnet/traits.hpp>
+#include <lipnet/profile.hpp>
 #include <lipnet/tensor.hpp>
 #include <lipnet/problem.hpp>
 #include <lipnet/variable.hpp>
@@ -99,35 +100,41 @@ namespace lipnet {
 
 
 
+        /// mosek model of the projection; built once, reference weights as parameters
+        fusion::Model::t M;
+
+        /// projected weights and norm of the difference
+        std::array<fusion::Variable::t, L::value> Wvar;
+        fusion::Variable::t Norm;
+
+        /// reference weights
+        std::array<fusion::Parameter::t, L::value> Wref;
+
+
         /**
-         * 
-         * @brief Compute projetion of weights into feasible set.
+         * @brief mosek_projection_wot_t; default constructor; builds the model and
+         *          the constraints of the projection
          * @param lipschitz lipschitz integral_constant
-         * @param ref reference weights; computed during gradient descent step
          * @param tinitval hyperparameter T of chi matrix
          */
 
-        static variable_t projection(  const T lipschitz, variable_t &&ref, const T &tinitval ) {
-
-            // creat emosek model
-            auto M = new fusion::Model("ProjectionLipschitz");
+        mosek_projection_wot_t( const T lipschitz, const T &tinitval )
+            : M{ new fusion::Model("ProjectionLipschitz") } {
+            configure_model( M );
 
-            
             // create mosek variables
-            std::array<fusion::Variable::t, L::value> Wvar;
-            fusion::Variable::t Norm = M->variable("norm",
-                       fusion::Domain::greaterThan(0.));
+            Norm = M->variable("norm", fusion::Domain::greaterThan(0.));
 
-            std::array<fusion::Matrix::t, L::value> Wref;
             std::array<fusion::Matrix::t, L::value-1> Tparam;
 
 
-            // generate mosek parameters from input argument
+            // generate mosek variables and parameters
             std::for_range<0,L::value>([&]<auto I>(){
                 std::get<I>(Wvar) = M->variable( std::format("var-%i", I),
                       monty::new_array_ptr<int,1>({ at<I+1,N...>() ,  at<I,N...>() }) );
 
-                std::get<I>(Wref) = map<at<I+1,N...>(),at<I,N...>()>( std::get<I>(ref).weight );
+                std::get<I>(Wref) = M->parameter( std::format("ref-%i", I),
+                      monty::new_array_ptr<int,1>({ at<I+1,N...>() ,  at<I,N...>() }) );
 
                 if constexpr ( I+1 < L::value )
                       std::get<I>(Tparam) = fusion::SparseMatrix::diag( at<I+1,N...>(), tinitval );
@@ -137,8 +144,9 @@ namespace lipnet {
             // stacking all parts together to generate chi matrix
             auto vstack = monty::new_array_ptr< fusion::Expression::t, 1>( L::value+1 );
             std::for_range<0,L::value+1>([&]<auto I>(){
-                constexpr size_t nnnn = ( (I > 1 && I < L::value-1) ? 5 : (I > 0
-                                          && I < L::value) ? 4 : 3);
+                // leading zeros, lower block, diagonal block, upper block, trailing zeros
+                constexpr size_t nnnn = ( I > 1 ) + ( I > 0 ) + 1
+                                      + ( I < L::value ) + ( I+1 < L::value );
                 auto hstack = monty::new_array_ptr< fusion::Expression::t, 1>(nnnn);
 
                 size_t i = 0;
@@ -180,7 +188,7 @@ namespace lipnet {
                    fusion::Expression::t, 1>( L::value+1 ); (*hstack)[0] = Norm;
             std::for_range<0,L::value>([&]<auto I>(){
                  (*hstack)[I+1]  = fusion::Expr::transpose( fusion::Expr::sub( fusion::Expr::flatten( std::get<I>(Wvar) ),
-                        fusion::Expr::flatten( fusion::Expr::constTerm(std::get<I>(Wref)) ) ));
+                        fusion::Expr::flatten( std::get<I>(Wref) ) ));
             });
 
 
@@ -195,11 +203,30 @@ namespace lipnet {
 
             // set objective function
             M->objective( fusion::ObjectiveSense::Minimize, Norm );
-            
+        }
+
+        mosek_projection_wot_t( const mosek_projection_wot_t& ) = delete;
+        mosek_projection_wot_t& operator=( const mosek_projection_wot_t& ) = delete;
+
+        ~mosek_projection_wot_t() { M->dispose(); }
+
+
+        /**
+         * @brief Compute projetion of weights into feasible set; only the reference
+         *          weights of the model are updated, the model is not rebuilt
+         * @param ref reference weights; computed during gradient descent step
+         */
+
+        variable_t project( variable_t &&ref ) {
+
+            std::for_range<0,L::value>([&]<auto I>(){
+                std::get<I>(Wref)->setValue( dense_array( std::get<I>(ref).weight ) );
+            });
+
             // solve problem
-            M->solve();
-            
-            
+            { [[maybe_unused]] scoped_timer_t<phase_t::SDP> timer; M->solve(); }
+
+
             // extract weights from solution
             variable_t result = std::move(ref);
             std::for_range<0,L::value>([&]<auto I>(){
@@ -209,15 +236,23 @@ namespace lipnet {
                         mat(i,j) = (* std::get<I>(Wvar)->level() )[i*mat.columns()+j]; }
             });
 
-
-            // free mosel model
-            M->dispose();
-
             return std::move(result);
-
         }
 
 
+        /**
+         * 
+         * @brief Compute projetion of weights into feasible set; one-shot variant,
+         *          keep a mosek_projection_wot_t for repeated projections
+         * @param lipschitz lipschitz integral_constant
+         * @param ref reference weights; computed during gradient descent step
+         * @param tinitval hyperparameter T of chi matrix
+         */
+
+        static variable_t projection(  const T lipschitz, variable_t &&ref, const T &tinitval ) {
+            mosek_projection_wot_t proj( lipschitz, tinitval );
+            return proj.project( std::move(ref) );
+        }
 
     };
 
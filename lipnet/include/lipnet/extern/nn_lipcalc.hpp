@@ -30,6 +30,7 @@
 #include <deque>
 
 #include <lipnet/traits.hpp>
+#include <lipnet/profile.hpp>
 #include <lipnet/tensor.hpp>
 #include <lipnet/problem.hpp>
 #include <lipnet/variable.hpp>
@@ -87,61 +88,204 @@ namespace lipnet {
 
 
 
+        /// mosek model of the sdp; built once, weight dependent data as parameters
+        fusion::Model::t M;
+
+        /// squared lipschitz constant and T parameter
+        fusion::Variable::t Lvar, Tvar;
+
+        /// weights of the hidden layers and trans(W)*W of the last layer
+        std::vector<fusion::Parameter::t> Wpar;
+        fusion::Parameter::t Qpar;
+
+
         /**
-         * @brief solve sdp; via mosek; via interior point method
-         * @param var network weights
+         * @brief network_libcalc_t; default constructor; builds the model structure
+         *          of the sdp
+         * @param chordal split chi into one psd cone per pair of consecutive layers
          * @cite fazlyab2019efficient
          */
-        
-        static std::tuple<T, vector_t<sum_from_to<1, L::value, N...>()>> solve( const variable_t& var ) {
-            constexpr size_t n = sum_from_to<1, L::value, N...>();
 
-            // create mosek model
-            fusion::Model::t M = new fusion::Model("sdo1");
-            auto _M = monty::finally([&]() { M->dispose(); });
+        explicit network_libcalc_t( const bool chordal = false ) : M{ new fusion::Model("sdo1") } {
+            configure_model( M );
+            constexpr size_t n = sum_from_to<1, L::value, N...>();
 
             // create mosek variables to optimize
-            fusion::Variable::t Lvar  = M->variable("L^2", 1, fusion::Domain::greaterThan(0.));
-            fusion::Variable::t Tvar  = M->variable("T", n, fusion::Domain::greaterThan(0.));
+            Lvar  = M->variable("L^2", 1, fusion::Domain::greaterThan(0.));
+            Tvar  = M->variable("T", n, fusion::Domain::greaterThan(0.));
+
+            // weight dependent data
+            std::for_range<0, L::value-1>([&]<auto I>(){
+                Wpar.push_back( M->parameter( (int) at<I+1,N...>(), (int) at<I,N...>() ) );
+            });
+            Qpar = M->parameter( (int) at<L::value-1,N...>(), (int) at<L::value-1,N...>() );
 
-            // generate network representation in matrices A and B
-            auto A = block_diag_a_const( std::integer_sequence<size_t, N...>{}, extract_weights(var) );
-            auto B = block_diag_b_const( std::integer_sequence<size_t, N...>{} );
+            if( chordal ) chordal_constraints();
+            else dense_constraints();
 
+            // set objective function
+            M->objective( fusion::ObjectiveSense::Minimize,  Lvar );
+        }
 
-            auto Tcon = fusion::Expr::repeat(Tvar, n+at<0,N...>(), 1);
 
-            // gernate 
-            auto term1 = fusion::Expr::mul( B->transpose(), fusion::Expr::mulElm( Tcon, A) );
-            auto term2 = fusion::Expr::mul( A->transpose(), fusion::Expr::mulElm( Tcon, B) );
-            auto term3 = fusion::Expr::mul( -2.0, fusion::Expr::mul( B->transpose(), fusion::Expr::mulElm( Tcon, B) ));
+        /**
+         * @brief chi as one psd cone
+         */
+
+        void dense_constraints() {
+            constexpr size_t n = sum_from_to<1, L::value, N...>();
+            constexpr size_t m = sum<L::value,N...>();
+
+            auto B = block_diag_b_const( DIMS{} );
+
+            // diag(T)*A; assembled from the weight parameters of each layer
+            std::vector<fusion::Expression::t> TA;
+            std::for_range<0, L::value-1>([&]<auto I>(){
+                constexpr size_t rows = at<I+1,N...>();
+                constexpr size_t cols = at<I,N...>();
+                constexpr size_t roff = sum<I+1,N...>() - at<0,N...>();
 
-            auto res = blaze::trans(  std::get<L::value-1>(var).weight ) *  std::get<L::value-1>(var).weight;
-            auto term4 = block_diag_q( std::integer_sequence<size_t, N...>{} , res , Lvar );
+                auto t = fusion::Expr::repeat( Tvar->slice( (int) roff, (int) (roff+rows) ), (int) cols, 1 );
+                auto R = block_select( n, rows, roff, 0, rows );
+                auto C = block_select( cols, m, 0, sum<I,N...>(), cols );
+
+                TA.push_back( fusion::Expr::mul( R, fusion::Expr::mul( fusion::Expr::mulElm( Wpar[I], t ), C ) ) );
+            });
+
+            auto Tcon = fusion::Expr::repeat(Tvar, m, 1);
+
+            // gernate
+            auto term1 = fusion::Expr::mul( B->transpose(),
+                                fusion::Expr::add( monty::new_array_ptr<fusion::Expression::t>( TA ) ) );
+            auto term2 = fusion::Expr::transpose( term1 );
+            auto term3 = fusion::Expr::mul( -2.0, fusion::Expr::mul( B->transpose(), fusion::Expr::mulElm( Tcon, B) ));
+            auto term4 = block_diag_q( DIMS{}, Qpar, Lvar );
 
             // generate chi matrix
             auto P = fusion::Expr::add( monty::new_array_ptr<fusion::Expression::t,1>({term1, term2, term3, term4}) );
 
-
-            // set objective function and contraint
-            M->objective( fusion::ObjectiveSense::Minimize,  Lvar );
             M->constraint( fusion::Expr::neg(P), fusion::Domain::inPSDCone() );
+        }
+
+
+        /**
+         * @brief chi as sum of overlapping psd cones; chi is block-tridiagonal, so
+         *          its cliques are the pairs of consecutive layers and chi is psd iff
+         *          it is the sum of psd matrices Z_k on the blocks k and k+1
+         */
+
+        void chordal_constraints() {
+            auto index = []( int r, int c ){ return monty::new_array_ptr<int,1>({ r, c }); };
+
+            std::vector<fusion::Variable::t> Z;
+
+            // one cone per pair of layers; the offdiagonal block is only in this cone
+            std::for_range<0, L::value-1>([&]<auto K>(){
+                constexpr int nk = at<K,N...>();
+                constexpr int nk1 = at<K+1,N...>();
+                constexpr int roff = sum<K+1,N...>() - at<0,N...>();
+
+                auto z = M->variable( fusion::Domain::inPSDCone( nk+nk1 ) );
+                Z.push_back( z );
+
+                auto t = fusion::Expr::repeat( Tvar->slice( roff, roff+nk1 ), nk, 1 );
+                M->constraint( fusion::Expr::add( z->slice( index( nk, 0 ), index( nk+nk1, nk ) ),
+                                                  fusion::Expr::mulElm( Wpar[K], t ) ),
+                               fusion::Domain::equalsTo( 0.0 ) );
+            });
+
+            // diagonal blocks are shared by the neighbouring cones
+            std::for_range<0, L::value>([&]<auto J>(){
+                constexpr int nj = at<J,N...>();
+
+                std::vector<fusion::Expression::t> parts;
+
+                if constexpr ( J > 0 ) {
+                    constexpr int np = at<J-1,N...>();
+                    parts.push_back( Z[J-1]->slice( index( np, np ), index( np+nj, np+nj ) ) );
+                }
+
+                if constexpr ( J < L::value-1 )
+                    parts.push_back( Z[J]->slice( index( 0, 0 ), index( nj, nj ) ) );
+
+                if constexpr ( J == 0 )
+                    parts.push_back( fusion::Expr::neg( fusion::Expr::mulElm( fusion::Expr::repeat(
+                            fusion::Expr::repeat( Lvar, nj, 1 ), nj, 0 ), fusion::Matrix::eye( nj ) ) ) );
+
+                if constexpr ( J > 0 ) {
+                    constexpr int roff = sum<J,N...>() - at<0,N...>();
+                    parts.push_back( fusion::Expr::mul( -2.0, fusion::Expr::mulElm( fusion::Expr::repeat(
+                            Tvar->slice( roff, roff+nj ), nj, 1 ), fusion::Matrix::eye( nj ) ) ) );
+                }
+
+                if constexpr ( J == L::value-1 )
+                    parts.push_back( Qpar );
+
+                M->constraint( fusion::Expr::add( monty::new_array_ptr<fusion::Expression::t>( parts ) ),
+                               fusion::Domain::equalsTo( 0.0 ) );
+            });
+        }
+
+
+        /**
+         * @brief limit the number of threads mosek uses for this model; e.g. when
+         *          several models are solved concurrently
+         * @param n number of threads; 0 lets mosek decide
+         */
+
+        void threads( const size_t n ) {
+            M->setSolverParam( "numThreads", (int) n );
+        }
+
+        network_libcalc_t( const network_libcalc_t& ) = delete;
+        network_libcalc_t& operator=( const network_libcalc_t& ) = delete;
+
+        ~network_libcalc_t() { M->dispose(); }
+
+
+        /**
+         * @brief solve sdp for given weights; only the parameters of the model are
+         *          updated, the model is not rebuilt. The interior point
+         *          optimizer of mosek starts from scratch, there is no warm start
+         * @param var network weights
+         */
+
+        std::tuple<T, vector_t<sum_from_to<1, L::value, N...>()>> compute( const variable_t& var ) {
+            constexpr size_t n = sum_from_to<1, L::value, N...>();
+
+            std::for_range<0, L::value-1>([&]<auto I>(){
+                Wpar[I]->setValue( dense_array( std::get<I>(var).weight ) );
+            });
+
+            matrix_t<at<L::value-1,N...>(),at<L::value-1,N...>()> res =
+                    blaze::trans(  std::get<L::value-1>(var).weight ) *  std::get<L::value-1>(var).weight;
+            Qpar->setValue( dense_array( res ) );
 
             // solve mosek problem
-            M->solve();
+            { [[maybe_unused]] scoped_timer_t<phase_t::SDP> timer; M->solve(); }
 
             // extract T param and psi (aka lipschitz constant)
-            vector_t<sum_from_to<1, L::value, N...>()> TT;
+            vector_t<n> TT;
             for(int i = 0; i < n; i++)
                 TT.at(i) = (*Tvar->level())[i];
 
-            // free mosek model
-            M->dispose();
-
             return std::make_tuple( std::sqrt( (*(Lvar->level()))[0] ), std::move(TT)  );
-
         }
+
+
+        /**
+         * @brief solve sdp; via mosek; via interior point method; one-shot variant,
+         *          keep a network_libcalc_t for repeated solves
+         * @param var network weights
+         * @param chordal use the chordal formulation
+         * @cite fazlyab2019efficient
+         */
         
+        static std::tuple<T, vector_t<sum_from_to<1, L::value, N...>()>> solve( const variable_t& var,
+                                                                              const bool chordal = false ) {
+            network_libcalc_t calc( chordal );
+            return calc.compute( var );
+        }
 
     };
 
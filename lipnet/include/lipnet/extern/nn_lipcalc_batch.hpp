@@ -0,0 +1,164 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_NETWORK_LIPCALC_BATCH_HPP__
+#define __LIPNET_NETWORK_LIPCALC_BATCH_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <atomic>
+#include <ostream>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+#include <lipnet/parallel.hpp>
+
+#include <lipnet/network/topology.hpp>
+
+#include <lipnet/lipschitz/trivial.hpp>
+
+#include <lipnet/extern/nn_lipcalc.hpp>
+#include <lipnet/extern/nn_lipcalc_tiered.hpp>
+
+
+namespace lipnet {
+
+
+    /**
+     * @brief certify the lipschitz constant of many networks of the same topology;
+     *          the bounds without sdp are computed first for all networks and the
+     *          sdp tiers only for the networks they do not decide. The sdps run
+     *          concurrently, one certifier per worker
+     *
+     * @tparam T numerical value type
+     * @tparam N network topology
+     * @see network_libcalc_tiered_t
+     */
+
+    template<typename T, size_t ...N>
+    struct network_libcalc_batch_t {
+
+        typedef typename network_topology<T, N...>::type variable_t;
+        typedef network_libcalc_tiered_t<T, N...> tiered_t;
+
+        /**
+         * @brief certificate of one network
+         */
+
+        struct result_t {
+            std::string name;       /// name of the network (e.g. model file)
+            T trivial;              /// product of the spectral norm bounds
+            T lipschitz;            /// smallest computed upper bound
+            bool skipped;           /// true if the full sdp was not needed
+            typename tiered_t::result_t bounds;
+        };
+
+
+        /// lipschitz target; tiers are skipped once the target is decided (default = 0, never skip)
+        T target = 0;
+
+        /// compute the layer pair sdps before the full sdp (default = true)
+        bool pairs = true;
+
+        /// number of concurrent sdps
+        size_t workers = default_threads();
+
+        /// number of threads of each mosek model (default = 1)
+        size_t solver_threads = 1;
+
+        /// use the chordal sdp formulation (default = false)
+        bool chordal = false;
+
+
+        /**
+         * @brief certify all networks
+         * @param names names of the networks
+         * @param models network weights
+         * @return one result per network in the order of the input
+         */
+
+        std::vector<result_t> compute( const std::vector<std::string> &names,
+                                       const std::vector<variable_t> &models ) const {
+            if( names.size() != models.size() )
+                throw std::string{"number of names and models differ"};
+
+            std::vector<result_t> results( models.size() );
+
+            const auto make = [&](){
+                tiered_t tiered( target, chordal );
+                tiered.pairs = pairs; tiered.solver_threads = solver_threads;
+                return tiered;
+            };
+
+            // cheap bounds first
+            parallel_for( models.size(), workers, [&]( size_t, size_t begin, size_t end ){
+                const tiered_t tiered = make();
+                for( size_t i = begin; i < end; ++i ) {
+                    const auto bounds = tiered.screen( models[i] );
+                    results[i] = result_t{ names[i], bounds.upper, bounds.upper, true, bounds };
+                }
+            });
+
+            std::vector<size_t> pending;
+            for( size_t i = 0; i < results.size(); ++i )
+                if( target <= 0 || !( results[i].bounds.certified || results[i].bounds.exceeds ) )
+                    pending.push_back( i );
+
+            // sdp tiers; workers take the next network when they are done
+            std::atomic<size_t> next{ 0 };
+            parallel_for( workers, workers, [&]( size_t, size_t, size_t ){
+                tiered_t tiered = make();
+
+                for( size_t k = next++; k < pending.size(); k = next++ ) {
+                    auto &r = results[pending[k]];
+                    r.bounds = tiered.refine( models[pending[k]], r.bounds );
+                    r.lipschitz = r.bounds.upper;
+                    r.skipped = r.bounds.tier != tier_t::SDP;
+                }
+            });
+
+            return results;
+        }
+
+
+        /**
+         * @brief write the results as tab separated table
+         * @param stream output stream
+         * @param results certificates
+         */
+
+        static void print( std::ostream &stream, const std::vector<result_t> &results ) {
+            stream << "name\tlower\ttrivial\tlipschitz\ttier\tcertified\tskipped\n";
+            for( const auto &r : results )
+                stream << r.name << "\t" << r.bounds.lower << "\t" << r.trivial << "\t" << r.lipschitz
+                       << "\t" << tier_name( r.bounds.tier ) << "\t" << ( r.bounds.certified ? 1 : 0 )
+                       << "\t" << ( r.skipped ? 1 : 0 ) << "\n";
+        }
+
+    };
+
+}
+
+#endif // __LIPNET_NETWORK_LIPCALC_BATCH_HPP__
@@ -0,0 +1,259 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_NETWORK_LIPCALC_DYNAMIC_HPP__
+#define __LIPNET_NETWORK_LIPCALC_DYNAMIC_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/profile.hpp>
+#include <lipnet/tensor.hpp>
+#include <lipnet/problem.hpp>
+#include <lipnet/variable.hpp>
+
+#include <lipnet/dynamic/network.hpp>
+
+#include <lipnet/extern/lip_helper.hpp>
+
+#include <fusion.h>
+#include <mosek.h>
+
+using namespace mosek;
+
+
+
+
+
+
+
+namespace lipnet {
+
+
+    /**
+     * @breif calculate lipschitz constant of a neural network with runtime topology
+     *          via conic program (SDP); the chordal formulation of network_libcalc_t,
+     *          one psd cone per pair of consecutive layers
+     *
+     *      @f[ \arg \min_{\Psi,T} \quad \Psi^2 \quad \mathrm{s.t} \chi(\Psi^2,W) \succeq 0 @f]
+     *
+     * @tparam T numerical value type
+     * @cite fazlyab2019efficient
+     */
+
+
+    template<typename T>
+    struct dynamic_network_libcalc_t {
+
+        typedef blaze::DynamicMatrix<T, blaze::rowMajor> dmatrix_t;
+        typedef blaze::DynamicVector<T, blaze::columnVector> dvector_t;
+
+        typedef dynamic_weights_t<T> variable_t;
+
+
+        /// number of neurons at each layer
+        std::vector<size_t> topology;
+
+        /// mosek model of the sdp; built once, weight dependent data as parameters
+        fusion::Model::t M;
+
+        /// squared lipschitz constant and T parameter
+        fusion::Variable::t Lvar, Tvar;
+
+        /// weights of the hidden layers and trans(W)*W of the last layer
+        std::vector<fusion::Parameter::t> Wpar;
+        fusion::Parameter::t Qpar;
+
+
+        /**
+         * @brief dynamic_network_libcalc_t; default constructor; builds the model structure
+         *          of the sdp
+         * @param topo number of neurons at each layer; at least one hidden layer
+         * @cite fazlyab2019efficient
+         */
+
+        explicit dynamic_network_libcalc_t( std::vector<size_t> topo )
+            : topology{ std::move(topo) }, M{ new fusion::Model("sdo1") } {
+            configure_model( M );
+            if( topology.size() < 3 )
+                throw std::string{"lipschitz sdp needs at least one hidden layer"};
+
+            const int L = topology.size()-1;
+            const int n = hidden();
+
+            // create mosek variables to optimize
+            Lvar  = M->variable("L^2", 1, fusion::Domain::greaterThan(0.));
+            Tvar  = M->variable("T", n, fusion::Domain::greaterThan(0.));
+
+            // weight dependent data
+            for( int I = 0; I < L-1; ++I )
+                Wpar.push_back( M->parameter( (int) topology[I+1], (int) topology[I] ) );
+            Qpar = M->parameter( (int) topology[L-1], (int) topology[L-1] );
+
+            constraints();
+
+            // set objective function
+            M->objective( fusion::ObjectiveSense::Minimize,  Lvar );
+        }
+
+        /// number of hidden neurons; the dimension of the T parameter
+        inline size_t hidden() const {
+            size_t n = 0;
+            for( size_t I = 1; I+1 < topology.size(); ++I ) n += topology[I];
+            return n;
+        }
+
+
+        /**
+         * @brief chi as sum of overlapping psd cones; chi is block-tridiagonal, so
+         *          its cliques are the pairs of consecutive layers and chi is psd iff
+         *          it is the sum of psd matrices Z_k on the blocks k and k+1
+         * @see network_libcalc_t::chordal_constraints
+         */
+
+        void constraints() {
+            auto index = []( int r, int c ){ return monty::new_array_ptr<int,1>({ r, c }); };
+
+            const int L = topology.size()-1;
+
+            std::vector<fusion::Variable::t> Z;
+
+            // one cone per pair of layers; the offdiagonal block is only in this cone
+            int roff = 0;
+            for( int K = 0; K < L-1; ++K ) {
+                const int nk = topology[K];
+                const int nk1 = topology[K+1];
+
+                auto z = M->variable( fusion::Domain::inPSDCone( nk+nk1 ) );
+                Z.push_back( z );
+
+                auto t = fusion::Expr::repeat( Tvar->slice( roff, roff+nk1 ), nk, 1 );
+                M->constraint( fusion::Expr::add( z->slice( index( nk, 0 ), index( nk+nk1, nk ) ),
+                                                  fusion::Expr::mulElm( Wpar[K], t ) ),
+                               fusion::Domain::equalsTo( 0.0 ) );
+                roff += nk1;
+            }
+
+            // diagonal blocks are shared by the neighbouring cones
+            roff = 0;
+            for( int J = 0; J < L; ++J ) {
+                const int nj = topology[J];
+
+                std::vector<fusion::Expression::t> parts;
+
+                if( J > 0 ) {
+                    const int np = topology[J-1];
+                    parts.push_back( Z[J-1]->slice( index( np, np ), index( np+nj, np+nj ) ) );
+                }
+
+                if( J < L-1 )
+                    parts.push_back( Z[J]->slice( index( 0, 0 ), index( nj, nj ) ) );
+
+                if( J == 0 )
+                    parts.push_back( fusion::Expr::neg( fusion::Expr::mulElm( fusion::Expr::repeat(
+                            fusion::Expr::repeat( Lvar, nj, 1 ), nj, 0 ), fusion::Matrix::eye( nj ) ) ) );
+
+                if( J > 0 ) {
+                    parts.push_back( fusion::Expr::mul( -2.0, fusion::Expr::mulElm( fusion::Expr::repeat(
+                            Tvar->slice( roff, roff+nj ), nj, 1 ), fusion::Matrix::eye( nj ) ) ) );
+                    roff += nj;
+                }
+
+                if( J == L-1 )
+                    parts.push_back( Qpar );
+
+                M->constraint( fusion::Expr::add( monty::new_array_ptr<fusion::Expression::t>( parts ) ),
+                               fusion::Domain::equalsTo( 0.0 ) );
+            }
+        }
+
+
+        /**
+         * @brief limit the number of threads mosek uses for this model
+         * @param n number of threads; 0 lets mosek decide
+         */
+
+        void threads( const size_t n ) {
+            M->setSolverParam( "numThreads", (int) n );
+        }
+
+        dynamic_network_libcalc_t( const dynamic_network_libcalc_t& ) = delete;
+        dynamic_network_libcalc_t& operator=( const dynamic_network_libcalc_t& ) = delete;
+
+        ~dynamic_network_libcalc_t() { M->dispose(); }
+
+
+        /**
+         * @brief solve sdp for given weights; only the parameters of the model are
+         *          updated, the model is not rebuilt. The interior point
+         *          optimizer of mosek starts from scratch, there is no warm start
+         * @param var network weights; same topology as the model
+         */
+
+        std::tuple<T, dvector_t> compute( const variable_t& var ) {
+            const size_t L = topology.size()-1;
+            if( var.size() != L )
+                throw std::string{"weights do not match the topology of the sdp"};
+
+            for( size_t I = 0; I+1 < L; ++I )
+                Wpar[I]->setValue( dense_array( var[I].weight ) );
+
+            dmatrix_t res = blaze::trans( var[L-1].weight ) * var[L-1].weight;
+            Qpar->setValue( dense_array( res ) );
+
+            // solve mosek problem
+            { [[maybe_unused]] scoped_timer_t<phase_t::SDP> timer; M->solve(); }
+
+            // extract T param and psi (aka lipschitz constant)
+            const size_t n = hidden();
+            dvector_t TT( n );
+            for( size_t i = 0; i < n; i++ )
+                TT[i] = (*Tvar->level())[i];
+
+            return std::make_tuple( std::sqrt( (*(Lvar->level()))[0] ), std::move(TT)  );
+        }
+
+
+        /**
+         * @brief solve sdp; one-shot variant, keep a dynamic_network_libcalc_t for
+         *          repeated solves
+         * @param var network weights
+         * @cite fazlyab2019efficient
+         */
+
+        static std::tuple<T, dvector_t> solve( const variable_t& var ) {
+            std::vector<size_t> topo{ var.front().inputs() };
+            for( const auto &layer : var ) topo.push_back( layer.outputs() );
+
+            dynamic_network_libcalc_t calc( std::move(topo) );
+            return calc.compute( var );
+        }
+
+    };
+
+}
+
+#endif // __LIPNET_NETWORK_LIPCALC_DYNAMIC_HPP__
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_NETWORK_LIPCALC_TIERED_HPP__
+#define __LIPNET_NETWORK_LIPCALC_TIERED_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+
+#include <lipnet/network/topology.hpp>
+
+#include <lipnet/lipschitz/trivial.hpp>
+
+#include <lipnet/extern/nn_lipcalc.hpp>
+
+
+namespace lipnet {
+
+    /// bounds of the tiered certifier, from cheap to expensive
+    enum class tier_t : size_t { POWER = 0, PAIRS, SDP };
+
+    /// name of a tier in the results
+    inline const char* tier_name( const tier_t t ) {
+        constexpr std::array<const char*, 3> names = { "power", "pairs", "sdp" };
+        return names[ size_t(t) ];
+    }
+
+
+    /**
+     * @brief certify a lipschitz target with progressively tighter and costlier bounds;
+     *          stops as soon as the upper bound meets the target or the lower bound
+     *          excludes it.
+     *
+     *      - lower bound: spectral norm of the linear network (power iteration)
+     *      - POWER: product of the spectral norm bounds of the layers
+     *      - PAIRS: product of the sdp bounds of pairs of consecutive layers; only for
+     *               more than one hidden layer, the small sdps are cheaper than the full one
+     *      - SDP: the full sdp of network_libcalc_t; the model is built once and reused
+     *
+     *      Every upper bound is valid, the reported bound is the minimum of the computed ones.
+     *
+     * @tparam T numerical value type
+     * @tparam N network topology
+     * @see calculate_lipschitz_t
+     * @see network_libcalc_t
+     */
+
+    template<typename T, size_t ...N>
+    struct network_libcalc_tiered_t {
+
+        typedef typename network_topology<T, N...>::type variable_t;
+        typedef std::integral_constant<size_t, sizeof... (N)-1> L;
+
+        /**
+         * @brief bounds of one network
+         */
+
+        struct result_t {
+            T lower = 0;                    /// lower bound of every sdp bound
+            T upper = 0;                    /// smallest computed upper bound
+            tier_t tier = tier_t::POWER;    /// last computed tier
+            bool certified = false;         /// upper <= target
+            bool exceeds = false;           /// lower > target; no sdp bound can meet the target
+        };
+
+
+        /// lipschitz target; 0 computes all tiers (default = 0)
+        T target = 0;
+
+        /// squarings of the spectral norm bounds (default = 5)
+        size_t squarings = 5;
+
+        /// power iterations of the lower bound (default = 20)
+        size_t iterations = 20;
+
+        /// compute the layer pair tier (default = true)
+        bool pairs = true;
+
+        /// use the chordal sdp formulation (default = false)
+        bool chordal = false;
+
+        /// number of threads of each mosek model (default = 1 or the configured mosek threads)
+        size_t solver_threads = std::max<size_t>( 1, resources().solver );
+
+
+        network_libcalc_tiered_t() = default;
+
+        network_libcalc_tiered_t( const T target, const bool chordal = false )
+            : target{ target }, chordal{ chordal } {}
+
+
+        /// true if the bounds decide the target
+        inline bool decided( const result_t &res ) const {
+            return target > 0 && ( res.certified || res.exceeds );
+        }
+
+
+        /**
+         * @brief all tiers until one decides the target
+         * @param var network weights
+         */
+
+        result_t compute( const variable_t &var ) {
+            return refine( var, screen( var ) );
+        }
+
+
+        /**
+         * @brief tiers without sdp; lower bound and POWER
+         * @param var network weights
+         */
+
+        result_t screen( const variable_t &var ) const {
+            result_t res;
+            res.lower = calculate_lipschitz_t<T,N...>::linear_lipschitz( var, iterations );
+            res.upper = calculate_lipschitz_t<T,N...>::power_lipschitz( var, squarings );
+            res.tier = tier_t::POWER;
+            return classify( res );
+        }
+
+
+        /**
+         * @brief continue with the sdp tiers if the result does not decide the target
+         * @param var network weights
+         * @param res bounds of the previous tiers
+         */
+
+        result_t refine( const variable_t &var, result_t res ) {
+            if( decided( res ) ) return res;
+
+            if constexpr ( L::value > 2 ) {
+                if( pairs && res.tier < tier_t::PAIRS ) {
+                    res.upper = std::min( res.upper, pairs_lipschitz( var ) );
+                    res.tier = tier_t::PAIRS;
+                    if( decided( classify( res ) ) ) return res;
+                }
+            }
+
+            if( !full ) {
+                full = std::make_unique<network_libcalc_t<T,N...>>( chordal );
+                full->threads( solver_threads );
+            }
+
+            res.upper = std::min( res.upper, std::get<0>( full->compute( var ) ) );
+            res.tier = tier_t::SDP;
+            return classify( res );
+        }
+
+
+        /**
+         * @brief product of the sdp bounds of the subnetworks W_{k+1} phi( W_k x ); a
+         *          remaining last layer contributes its spectral norm bound
+         * @param var network weights
+         */
+
+        T pairs_lipschitz( const variable_t &var ) const {
+            T lipschitz = 1.0;
+
+            std::for_range<0, (L::value+1)/2>([&]<auto P>(){
+                constexpr size_t K = 2*P;
+
+                if constexpr ( K+1 < L::value ) {
+                    typedef network_libcalc_t<T, at<K,N...>(), at<K+1,N...>(), at<K+2,N...>()> calc_t;
+                    typename calc_t::variable_t sub{ std::get<K>( var ), std::get<K+1>( var ) };
+
+                    calc_t calc( chordal );
+                    calc.threads( solver_threads );
+                    lipschitz *= std::get<0>( calc.compute( sub ) );
+                } else {
+                    lipschitz *= calculate_lipschitz_t<T,N...>::spectral_norm_bound(
+                                std::get<K>( var ).weight, squarings );
+                }
+            });
+
+            return lipschitz;
+        }
+
+    private:
+        /// full sdp; built on first use
+        std::unique_ptr<network_libcalc_t<T,N...>> full;
+
+        inline result_t& classify( result_t &res ) const {
+            res.certified = target > 0 && res.upper <= target;
+            res.exceeds = target > 0 && res.lower > target;
+            return res;
+        }
+    };
+
+}
+
+#endif // __LIPNET_NETWORK_LIPCALC_TIERED_HPP__
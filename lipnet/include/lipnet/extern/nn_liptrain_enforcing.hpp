@@ -30,6 +30,7 @@
 #include <deque>
 
 #include <lipnet/traits.hpp>
+#include <lipnet/profile.hpp>
 #include <lipnet/tensor.hpp>
 #include <lipnet/problem.hpp>
 #include <lipnet/variable.hpp>
@@ -204,6 +205,7 @@ namespace lipnet {
 
             // create mosek model
             auto M = new fusion::Model("liptrain");
+            configure_model( M );
 
             // create mosek variables to optimize
             std::array<fusion::Variable::t, L::value> Wvar;
@@ -284,7 +286,7 @@ namespace lipnet {
                                                                                fusion::Expr::mul( mu , Nvar)) );
             
             // solve mosek problem
-            M->solve();
+            { [[maybe_unused]] scoped_timer_t<phase_t::SDP> timer; M->solve(); }
             
 
             // extract weights from solution
@@ -29,10 +29,12 @@
 #include <initializer_list>
 #include <deque>
 #include <ratio>
+#include <stdexcept>
 
 #include <cereal/cereal.hpp>
 
 #include <lipnet/traits.hpp>
+#include <lipnet/profile.hpp>
 #include <lipnet/tensor.hpp>
 #include <lipnet/tuple.hpp>
 #include <lipnet/variable.hpp>
@@ -40,6 +42,7 @@
 #include <lipnet/network/network.hpp>
 
 #include <lipnet/lipschitz/topology.hpp>
+#include <lipnet/lipschitz/kernels.hpp>
 
 namespace lipnet {
 
@@ -69,6 +72,18 @@ namespace lipnet {
         template <class Archive>
         void load( Archive & ar )
         {
+            std::array<size_t, sizeof... (N)> topo;
+            ar( cereal::make_nvp("topology", topo) );
+            if( topo != std::array<size_t, sizeof... (N)>{ N... } )
+                throw std::string{"wrong topology"};
+
+            std::for_range<0, sizeof ...(N)-1>([&]<auto I>(){
+                ar( cereal::make_nvp( std::format("l-%i", I) , std::get<I>(W) ) );
+            });
+
+            std::for_range<0, sizeof ...(N)-2>([&]<auto I>(){
+                ar( cereal::make_nvp( std::format("t-%i", I) , std::get<I>(t) ) );
+            });
         }
 
     };
@@ -166,6 +181,54 @@ namespace lipnet {
     };
 
 
+    template<typename T, size_t ...N>
+    struct update_t<T, liptrainweights_t<T,N...>> {
+        typedef decltype (liptrainweights_t<T,N...>::W) arg1_t;
+        typedef decltype (liptrainweights_t<T,N...>::t) arg2_t;
+
+        static inline void scale_add( liptrainweights_t<T,N...> &y, const T a,
+                                      const liptrainweights_t<T,N...> &x, const T b ) {
+            update_t<T,arg1_t>::scale_add( y.W, a, x.W, b );
+            update_t<T,arg2_t>::scale_add( y.t, a, x.t, b );
+        }
+
+        static inline void scale_add_square( liptrainweights_t<T,N...> &y, const T a,
+                                             const liptrainweights_t<T,N...> &x, const T b ) {
+            update_t<T,arg1_t>::scale_add_square( y.W, a, x.W, b );
+            update_t<T,arg2_t>::scale_add_square( y.t, a, x.t, b );
+        }
+
+        static inline void axpy( liptrainweights_t<T,N...> &y, const T a, const liptrainweights_t<T,N...> &x ) {
+            update_t<T,arg1_t>::axpy( y.W, a, x.W );
+            update_t<T,arg2_t>::axpy( y.t, a, x.t );
+        }
+
+        static inline void adam_direction( liptrainweights_t<T,N...> &d, const liptrainweights_t<T,N...> &m,
+                                           const liptrainweights_t<T,N...> &v, const T c1, const T c2, const T eps ) {
+            update_t<T,arg1_t>::adam_direction( d.W, m.W, v.W, c1, c2, eps );
+            update_t<T,arg2_t>::adam_direction( d.t, m.t, v.t, c1, c2, eps );
+        }
+    };
+
+
+    template<typename T, size_t ...N>
+    struct flat_t<T, liptrainweights_t<T,N...>> {
+        typedef decltype (liptrainweights_t<T,N...>::W) arg1_t;
+        typedef decltype (liptrainweights_t<T,N...>::t) arg2_t;
+        static constexpr size_t size = flat_t<T,arg1_t>::size + flat_t<T,arg2_t>::size;
+
+        static inline void pack( const liptrainweights_t<T,N...> &m, T *dst ) {
+            flat_t<T,arg1_t>::pack( m.W, dst );
+            flat_t<T,arg2_t>::pack( m.t, dst + flat_t<T,arg1_t>::size );
+        }
+
+        static inline void unpack( const T *src, liptrainweights_t<T,N...> &m ) {
+            flat_t<T,arg1_t>::unpack( src, m.W );
+            flat_t<T,arg2_t>::unpack( src + flat_t<T,arg1_t>::size, m.t );
+        }
+    };
+
+
     template<typename T, size_t ...N>
     struct prod_t<T, liptrainweights_t<T,N...>, liptrainweights_t<T,N...>> {
         typedef decltype (liptrainweights_t<T,N...>::W) arg1_t;
@@ -210,11 +273,43 @@ namespace lipnet {
         typedef liptrainweights_t<T,N...> variable_t;
 
         typedef std::integral_constant<size_t, sizeof... (N)-2> LN;
+
+        static_assert ( sizeof... (N) > 2,
+                        "chi requires at least one hidden layer");
         typedef std::integral_constant<size_t, sizeof... (N)-1> L;
 
         /// lipschitz constant
         T lipschitz;
 
+        /**
+         * @brief parts of the inverse needed by the gradient; the subdiagonal
+         *          blocks K and the diagonals of the diagonal blocks P, where
+         *          p[I] holds the diagonal of P[I+1]
+         */
+
+        struct terms_t {
+            typename inverse_subentry<T,N...>::type K;
+            tparam_t p;
+        };
+
+        /**
+         * @brief cache of the last cholesky decomposition and gradient terms; kept in the
+         *          metainfo of the problem
+         */
+
+        struct cache_t {
+            bool valid = false;
+            T lipschitz = 0;
+            variable_t var;
+
+            /// true if the decomposition includes the numerical offset
+            bool offset = true;
+            cholesky_t L; terms_t G;
+
+            /// statistics: reused and recomputed decompositions
+            size_t hits = 0, misses = 0;
+        };
+
         
         /**
          * @brief barrierfunction_t; default constructor
@@ -233,13 +328,28 @@ namespace lipnet {
          */
         
         auto compute( const variable_t& var,  variable_t& gradient, const T& gamma ) const {
+            cache_t cache;
+            return compute( var, gradient, gamma, cache );
+        }
+
+        /**
+         * @brief compute gradients; reuse the decomposition of the cache where possible
+         * @param var current position
+         * @param gradient reuturn value gradient
+         * @param gamma hyperparameter of barrier function
+         * @param cache decomposition of the previous call
+         * @see factorise( const T lipschitz, const variable_t &var, cache_t &cache )
+         */
 
-            cholesky_t L = chol( lipschitz, var );
-            inverse_t P = inv( L );
+        auto compute( const variable_t& var,  variable_t& gradient, const T& gamma, cache_t &cache ) const {
+
+            factorise( lipschitz, var, cache );
+            const cholesky_t &L = cache.L;
+            const terms_t &G = cache.G;
 
             std::for_range<0,L::value>([&]<auto I>(){
                 auto& grad = std::get<I>( gradient.W ).weight;
-                auto& submat = std::get<I>( P.K );
+                auto& submat = std::get<I>( G.K );
 
                 if constexpr ( I < L::value-1 )
                     grad += 2*gamma*blaze::expand<at<I,N...>()>( std::get<I>( var.t ) ) % submat;
@@ -249,17 +359,16 @@ namespace lipnet {
             });
 
             std::for_range<0,L::value-1>([&]<auto I>(){
-                 auto& submat = std::get<I>( P.K );
-                 auto& subdiag = std::get<I+1>( P.P );
+                 auto& submat = std::get<I>( G.K );
                  auto& w = std::get<I>( var.W ).weight;
 
                  auto& grad = std::get<I>( gradient.t );
 
-                 grad += 2*( blaze::diagonal(submat*blaze::trans(w)) - blaze::diagonal(subdiag) );
+                 grad += 2*( blaze::diagonal(submat*blaze::trans(w)) - std::get<I>( G.p ) );
 
             });
 
-            return std::move( L );
+            return L;
         }
 
         
@@ -274,64 +383,230 @@ namespace lipnet {
         template<bool numeric_stability = true, typename kondition = std::ratio<1,100>,
                  typename = typename std::enable_if<kondition::den != 0>::type>
         inline cholesky_t chol(const T lipschitz, const variable_t &var ) const {
-            constexpr T ratio = ( (T) kondition::num )/( (T) kondition::den );
-
             cholesky_t value;
+            chol_blocks<numeric_stability, kondition>( lipschitz, var, value );
+            return std::move( value );
+        }
 
-            if constexpr ( numeric_stability )
-                std::get<0>( value.D ) = lipschitz;
-            else std::get<0>( value.D ) = lipschitz;
+        /**
+         * @brief execute cholesky decomposition in place
+         * @tparam numeric_stability enable/disable numerical offset
+         * @tparam kondition numerical offset
+         * @param lipschitz lipschitz constant
+         * @param var current position
+         * @param value cholesky decomposition; the return value
+         */
+
+        template<bool numeric_stability = true, typename kondition = std::ratio<1,100>,
+                 typename = typename std::enable_if<kondition::den != 0>::type>
+        inline void chol_blocks(const T lipschitz, const variable_t &var,
+                                cholesky_t &value ) const {
+            chol_blocks<numeric_stability, kondition>( lipschitz, var.W, var.t, value );
+        }
+
+        /**
+         * @brief execute cholesky decomposition in place; weights and t-parameters
+         *          given apart, e.g. by the feasibility checks and the barrier without
+         *          t-parameters
+         * @tparam numeric_stability enable/disable numerical offset
+         * @tparam kondition numerical offset
+         * @param lipschitz lipschitz constant
+         * @param weights network weights
+         * @param tparam hyperparameter T of matrix chi
+         * @param value cholesky decomposition; the return value
+         * @throw std::invalid_argument if chi is not positive definite
+         */
+
+        template<bool numeric_stability = true, typename kondition = std::ratio<1,100>,
+                 typename WEIGHTS, typename TPARAM,
+                 typename = typename std::enable_if<kondition::den != 0>::type>
+        static inline void chol_blocks( const T lipschitz, const WEIGHTS &weights,
+                                        const TPARAM &tparam, cholesky_t &value ) {
+            [[maybe_unused]] scoped_timer_t<phase_t::CHOL> timer;
+            constexpr T ratio = ( (T) kondition::num )/( (T) kondition::den );
+
+            std::get<0>( value.D ) = lipschitz;
 
             std::get<0>( value.L ) =  -blaze::trans(
-                         blaze::expand<at<0,N...>()>( blaze::trans( std::get<0>( var.t ) )) %
-                         blaze::trans( std::get<0>( var.W ).weight ) / lipschitz );
+                         blaze::expand<at<0,N...>()>( blaze::trans( std::get<0>( tparam ) )) %
+                         blaze::trans( std::get<0>( weights ).weight ) / lipschitz );
 
             std::for_range<1,LN::value>([&]<auto I>(){
                 typedef matrix_t<at<I,N...>(),at<I,N...>()> smatrix_t;
 
-                smatrix_t X; blaze::diagonal( X ) = 2*std::get<I-1>( var.t );
-                X -= std::get<I-1>( value.L ) * blaze::trans(
-                                 std::get<I-1>( value.L ) );
+                smatrix_t X; blaze::diagonal( X ) = 2*std::get<I-1>( tparam );
+                block_syrk_sub( X, std::get<I-1>( value.L ) );
 
                 if constexpr ( numeric_stability )
                     X += ratio*eye( at<I,N...>() );
 
-                blaze::llh( X , std::get<I>( value.D ) );
+                block_llh( X , std::get<I>( value.D ) );
 
-                auto Z = blaze::trans( std::get<I>( var.W ).weight )
-                           % blaze::expand<at<I,N...>()>( blaze::trans( std::get<I>( var.t ) ) );
+                const matrix_t<at<I,N...>(), at<I+1,N...>()> Z = blaze::trans( std::get<I>( weights ).weight )
+                           % blaze::expand<at<I,N...>()>( blaze::trans( std::get<I>( tparam ) ) );
                 std::get<I>( value.L ) = - blaze::trans(
-                      blaze::solve( std::get<I>( value.D ), Z ) );
+                      block_solve( std::get<I>( value.D ), Z ) );
 
             });
 
             typedef matrix_t<at<LN::value,N...>(), at<LN::value,N...>()> s1matrix_t;
             typedef matrix_t<at<LN::value+1,N...>(), at<LN::value+1,N...>()> s2matrix_t;
 
-            s1matrix_t X1; blaze::diagonal( X1 ) = 2*std::get<LN::value-1>( var.t );
-            X1 -= std::get<LN::value-1>( value.L ) * blaze::trans(
-                             std::get<LN::value-1>( value.L ) );
+            s1matrix_t X1; blaze::diagonal( X1 ) = 2*std::get<LN::value-1>( tparam );
+            block_syrk_sub( X1, std::get<LN::value-1>( value.L ) );
 
             if constexpr ( numeric_stability )
                 X1 += ratio*eye( at<LN::value,N...>() );
 
-            blaze::llh( X1 , std::get<LN::value>( value.D ) );
+            block_llh( X1 , std::get<LN::value>( value.D ) );
 
 
             std::get<LN::value>( value.L ) = - blaze::trans(
-                  blaze::solve( std::get<LN::value>( value.D ), blaze::trans(
-                                    std::get<LN::value>( var.W  ).weight  ) ) );
+                  block_solve( std::get<LN::value>( value.D ), matrix_t<at<LN::value,N...>(), at<LN::value+1,N...>()>(
+                                    blaze::trans( std::get<LN::value>( weights ).weight ) ) ) );
 
             s2matrix_t X2 = eye( at<LN::value+1,N...>() );
 
             if constexpr ( numeric_stability )
                 X2 += ratio*eye( at<LN::value+1,N...>() );
 
-            X2 -= std::get<LN::value>( value.L ) * blaze::trans(
-                             std::get<LN::value>( value.L ) );
-            blaze::llh( X2 , std::get<LN::value+1>( value.D ) );
+            block_syrk_sub( X2, std::get<LN::value>( value.L ) );
+            block_llh( X2 , std::get<LN::value+1>( value.D ) );
+        }
 
-            return std::move( value );
+        /**
+         * @brief compare weights and t-parameters of two positions
+         * @param var current position
+         * @param old position of the cached decomposition
+         * @return true if nothing changed
+         */
+
+        inline bool unchanged( const variable_t &var, const variable_t &old ) const {
+            bool same = true;
+
+            std::for_range<0,L::value>([&]<auto I>(){
+                same = same && std::get<I>( var.W ).weight == std::get<I>( old.W ).weight;
+                if constexpr ( I < LN::value )
+                    same = same && std::get<I>( var.t ) == std::get<I>( old.t );
+            });
+
+            return same;
+        }
+
+        /**
+         * @brief cholesky decomposition and gradient terms with cache. The cache serves
+         *          re-evaluations at an unchanged position, e.g. the gradient after the
+         *          admissibility test of the accepted step or the barrier value of the
+         *          same iterate; every step of the optimizer changes the first block
+         *          (W0), thus a moved position is always factorised completely. A
+         *          decomposition without offset also serves requests with offset,
+         *          not vice versa.
+         * @tparam numeric_stability enable/disable numerical offset
+         * @param lipschitz lipschitz constant
+         * @param var current position
+         * @param cache cache of the previous call; updated
+         * @throw std::invalid_argument if chi is not positive definite; the cache is invalid
+         */
+
+        template<bool numeric_stability = true>
+        inline void factorise( const T lipschitz, const variable_t &var, cache_t &cache ) const {
+            if( cache.valid && cache.lipschitz == lipschitz && ( numeric_stability || !cache.offset )
+                    && unchanged( var, cache.var ) ) {
+                cache.hits++; return;
+            }
+
+            cache.misses++; cache.valid = false;
+            chol_blocks<numeric_stability>( lipschitz, var, cache.L );
+            cache.G = terms( cache.L );
+            cache.var = var; cache.lipschitz = lipschitz;
+            cache.offset = numeric_stability; cache.valid = true;
+        }
+
+        /**
+         * @brief log determinant of chi from its cholesky decomposition; the first
+         *          diagonal block is lipschitz times the identity
+         * @param val cholesky decomposition (e.g L)
+         */
+
+        inline T logdet( const cholesky_t &val ) const {
+            T res = 2 * at<0,N...>() * std::log( std::get<0>( val.D ) );
+
+            std::for_range<1, LN::value+2>([&]<auto I>(){
+                res += 2 * blaze::sum( blaze::log( blaze::diagonal( std::get<I>( val.D ) ) ) );
+            });
+
+            return res;
+        }
+
+        /**
+         * @brief factorise without throwing; chi is positive definite iff every
+         *          diagonal block of the block cholesky decomposition exists. The test
+         *          is on chi itself, without the numerical offset of chol. On success
+         *          the cache holds this decomposition and the gradient and barrier
+         *          value of the accepted position reuse it, thus they are computed
+         *          without offset; on failure the cache is invalidated.
+         * @param lipschitz lipschitz constant
+         * @param var trial position
+         * @param cache cache of the previous call; updated
+         * @return true if var is strictly feasible
+         * @see factorise( const T lipschitz, const variable_t &var, cache_t &cache )
+         */
+
+        inline bool try_factorise( const T lipschitz, const variable_t &var, cache_t &cache ) const {
+            try {
+                factorise<false>( lipschitz, var, cache );
+            } catch ( const std::exception & ) {
+                return false;
+            }
+            return true;
+        }
+
+
+        /**
+         * @brief compute the gradient terms from the cholesky factors; same recursion
+         *          as inv, but the diagonal blocks are only kept for the next step and
+         *          the triangular factors are inverted instead of solved against
+         *          identity matrices
+         * @param val cholesky decomposition (e.g L)
+         * @see inv( const cholesky_t &val )
+         */
+
+        inline terms_t terms( const cholesky_t &val ) const {
+            [[maybe_unused]] scoped_timer_t<phase_t::TERMS> timer;
+            typedef blaze::DynamicMatrix<T, blaze::rowMajor> dmatrix_t;
+
+            terms_t res;
+
+            // diagonal block of the inverse behind the current one
+            dmatrix_t Pp;
+            {
+                auto Dinv = std::get<LN::value+1>( val.D );
+                block_invert( Dinv );
+                Pp = blaze::trans( Dinv ) * Dinv;
+            }
+
+            std::for_range<0, LN::value>([&]<auto I>(){
+                auto& K = std::get<LN::value-I>( res.K );
+
+                auto& L = std::get<LN::value-I>( val.L );
+                auto& D = std::get<LN::value-I>( val.D );
+
+                const auto tmp = block_solve_trans( D, matrix_t<at<LN::value-I,N...>(),
+                                             at<LN::value-I+1,N...>()>( blaze::trans(L) ) );
+                K = -blaze::trans( tmp*Pp );
+
+                auto Dinv = D;
+                block_invert( Dinv );
+
+                dmatrix_t P = blaze::trans( Dinv ) * Dinv - blaze::trans( tmp*K );
+                std::get<LN::value-I-1>( res.p ) = blaze::diagonal( P );
+                Pp = std::move( P );
+            });
+
+            std::get<0>( res.K ) = - blaze::trans( Pp )
+                    * std::get<0>(val.L)  / std::get<0>(val.D);
+
+            return std::move( res );
         }
 
 
@@ -341,6 +616,7 @@ namespace lipnet {
          */
         
         inline inverse_t inv( const cholesky_t &val ) const {
+            [[maybe_unused]] scoped_timer_t<phase_t::INV> timer;
             typedef matrix_t<at<LN::value+1,N...>(),
                     at<LN::value+1,N...>()> imat;
 
@@ -31,6 +31,7 @@
 
 
 #include <lipnet/traits.hpp>
+#include <lipnet/profile.hpp>
 #include <lipnet/tensor.hpp>
 #include <lipnet/tuple.hpp>
 #include <lipnet/variable.hpp>
@@ -38,6 +39,7 @@
 #include <lipnet/network/network.hpp>
 
 #include <lipnet/lipschitz/topology.hpp>
+#include <lipnet/lipschitz/barrier.hpp>
 
 namespace lipnet {
 
@@ -69,6 +71,9 @@ namespace lipnet {
         typedef typename parameter_tparam<T,N...>::type tparam_t ;
 
         typedef std::integral_constant<size_t, sizeof... (N)-2> LN;
+
+        static_assert ( sizeof... (N) > 2,
+                        "chi requires at least one hidden layer");
         typedef std::integral_constant<size_t, sizeof... (N)-1> L;
 
         T lipschitz;
@@ -111,7 +116,8 @@ namespace lipnet {
         }
 
         /**
-         * @brief execute cholesky decomposition
+         * @brief execute cholesky decomposition; the one of barrierfunction_t
+         *          without numerical offset
          * @param lipschitz lipschitz constant
          * @param weights weights
          * @param tparam hyperparameter T of matrix chi
@@ -119,47 +125,8 @@ namespace lipnet {
         
         inline cholesky_t chol(const T lipschitz, const variable_t &weights,
                               const tparam_t &tparam ) const {
-
             cholesky_t value;
-
-            std::get<0>( value.D ) = lipschitz;
-            std::get<0>( value.L ) =  -blaze::trans(
-                         blaze::expand<at<0,N...>()>( blaze::trans( std::get<0>( tparam ) )) %
-                         blaze::trans( std::get<0>( weights ).weight ) / lipschitz );
-
-            std::for_range<1,LN::value>([&]<auto I>(){
-                typedef matrix_t<at<I,N...>(),at<I,N...>()> smatrix_t;
-
-                smatrix_t X; blaze::diagonal( X ) = 2*std::get<I-1>(tparam);
-                X -= std::get<I-1>( value.L ) * blaze::trans(
-                                 std::get<I-1>( value.L ) );
-                blaze::llh( X , std::get<I>( value.D ) );
-
-                auto Z = blaze::trans( std::get<I>( weights ).weight )
-                           % blaze::expand<at<I,N...>()>(  blaze::trans( std::get<I>(tparam) ) );
-                std::get<I>( value.L ) = - blaze::trans(
-                      blaze::solve( std::get<I>( value.D ), Z ) );
-
-            });
-
-            typedef matrix_t<at<LN::value,N...>(), at<LN::value,N...>()> s1matrix_t;
-            typedef matrix_t<at<LN::value+1,N...>(), at<LN::value+1,N...>()> s2matrix_t;
-
-            s1matrix_t X1; blaze::diagonal( X1 ) = 2*std::get<LN::value-1>(tparam);
-            X1 -= std::get<LN::value-1>( value.L ) * blaze::trans(
-                             std::get<LN::value-1>( value.L ) );
-            blaze::llh( X1 , std::get<LN::value>( value.D ) );
-
-
-            std::get<LN::value>( value.L ) = - blaze::trans(
-                  blaze::solve( std::get<LN::value>( value.D ), blaze::trans(
-                                    std::get<LN::value>( weights ).weight  ) ) );
-
-            s2matrix_t X2 = blaze::IdentityMatrix<T>( at<LN::value+1,N...>() );
-            X2 -= std::get<LN::value>( value.L ) * blaze::trans(
-                             std::get<LN::value>( value.L ) );
-            blaze::llh( X2 , std::get<LN::value+1>( value.D ) );
-
+            barrierfunction_t<T,N...>::template chol_blocks<false>( lipschitz, weights, tparam, value );
             return std::move( value );
         }
 
@@ -170,6 +137,7 @@ namespace lipnet {
          */
 
         inline inverse_t inv( const cholesky_t &val ) const {
+            [[maybe_unused]] scoped_timer_t<phase_t::INV> timer;
             typedef matrix_t<at<LN::value+1,N...>(),
                     at<LN::value+1,N...>()> imat;
 
@@ -28,9 +28,11 @@
 #include <utility>
 #include <initializer_list>
 #include <deque>
+#include <cmath>
 
 
 #include <lipnet/traits.hpp>
+#include <lipnet/profile.hpp>
 #include <lipnet/tensor.hpp>
 #include <lipnet/tuple.hpp>
 #include <lipnet/variable.hpp>
@@ -47,6 +49,131 @@ namespace lipnet {
 
 
 
+    /**
+     * @brief chi_definite_t; structure exploiting definiteness test of the
+     *          block-tridiagonal matrix chi and bisection of the maximal feasible
+     *          stepsize. A test is a block cholesky decomposition, thus linear
+     *          in the number of layers instead of cubic in the number of neurons
+     *
+     * @tparam T numerical value type
+     * @tparam N network topology
+     */
+
+    template<typename T, size_t ...N>
+    struct chi_definite_t {
+
+        template<size_t NN1, size_t NN2>
+        using matrix_t = blaze::StaticMatrix<T, NN1, NN2, blaze::rowMajor>;
+
+        typedef blaze::IdentityMatrix<T> eye;
+
+        typedef typename cholesky_topology<T,N...>::type cholesky_t;
+
+        typedef std::integral_constant<size_t, sizeof... (N)-2> LN;
+
+        static_assert ( sizeof... (N) > 2,
+                        "chi requires at least one hidden layer");
+
+        /// smallest probed stepsize is limit / 2^bisections; smaller steps are returned as zero
+        size_t bisections = 30;
+
+        /// relative accuracy of the returned stepsize
+        T tolerance = 1e-3;
+
+        /// maximal returned stepsize
+        T limit = 1e3;
+
+
+        /**
+         * @brief test if chi is positive definite; the block cholesky
+         *          decomposition of barrierfunction_t without numerical offset
+         * @param rho squared lipschitz constant
+         * @param weights network weights
+         * @param tparam hyperparameter T of matrix chi
+         * @see barrierfunction_t::chol_blocks
+         */
+
+        template<typename WEIGHTS, typename TPARAM>
+        static bool definite( const T rho, const WEIGHTS &weights, const TPARAM &tparam ) {
+            if( !( rho > 0 ) ) return false;
+
+            cholesky_t value;
+            try {
+                barrierfunction_t<T,N...>::template chol_blocks<false>( std::sqrt( rho ), weights, tparam, value );
+            }
+            catch( const std::exception& ) { return false; }
+
+            return true;
+        }
+
+
+        /**
+         * @brief maximal stepsize alpha in (0, limit] for which feasible( alpha ) holds;
+         *          the interval is expanded from limit / 2^bisections upwards and the
+         *          first infeasible probe is bisected. With varying t-parameters chi is
+         *          quadratic in alpha and the feasible set need not be an interval, thus
+         *          the search starts at zero and does not skip over infeasible gaps of
+         *          the first steps.
+         * @param feasible predicate; true if the position at stepsize alpha is feasible
+         * @see bisect_interval
+         */
+
+        template<typename F>
+        T bisect( F &&feasible ) const {
+            T lo = 0, hi = std::ldexp( limit, -int( bisections ) );
+
+            while( feasible( hi ) ) {
+                if( hi >= limit ) return limit;
+                lo = hi; hi = std::min( 2*hi, limit );
+            }
+
+            return lo > 0 ? refine( feasible, lo, hi ) : lo;
+        }
+
+        /**
+         * @brief maximal stepsize alpha in (0, limit] for which feasible( alpha ) holds,
+         *          if the feasible set is an interval containing zero, e.g. if chi is
+         *          affine in alpha; [0, limit] is bisected directly
+         * @param feasible predicate; true if the position at stepsize alpha is feasible
+         */
+
+        template<typename F>
+        T bisect_interval( F &&feasible ) const {
+            if( feasible( limit ) ) return limit;
+
+            const T floor = std::ldexp( limit, -int( bisections ) );
+            T lo = 0, hi = limit;
+
+            while( lo == 0 && hi > floor ) {
+                const T mid = hi / 2;
+                if( feasible( mid ) ) lo = mid;
+                else hi = mid;
+            }
+
+            return lo > 0 ? refine( feasible, lo, hi ) : lo;
+        }
+
+        /**
+         * @brief bisection of a bracket until its width is tolerance relative to its end
+         * @param feasible predicate; true if the position at stepsize alpha is feasible
+         * @param lo feasible stepsize
+         * @param hi infeasible stepsize
+         */
+
+        template<typename F>
+        T refine( F &&feasible, T lo, T hi ) const {
+            while( hi - lo > tolerance*hi ) {
+                const T mid = ( lo + hi ) / 2;
+                if( feasible( mid ) ) lo = mid;
+                else hi = mid;
+            }
+
+            return lo;
+        }
+
+    };
+
+
     /**
      * @brief feasibilitycheck_wot_t; Implementation of the feasibility check 
      *          for eigenvalue problem (not quadratic)
@@ -58,7 +185,7 @@ namespace lipnet {
      */
 
     template<typename T, size_t ...N>
-    struct feasibilitycheck_wot_t {
+    struct feasibilitycheck_wot_t : public chi_definite_t<T,N...> {
 
         template<size_t NN>
         using vector_t = blaze::StaticVector<T, NN, blaze::columnVector>;
@@ -78,22 +205,41 @@ namespace lipnet {
 
 
         /**
-         * @brief solve eigenvalue problem
+         * @brief maximal feasible stepsize by bisection on the block cholesky
+         *          decomposition of chi; with fixed t-parameters chi is affine in the
+         *          stepsize and its feasible set an interval
+         * @param tparam hyperparamater T of matrix chi
+         * @param lipschitz lipschitz constant
+         * @param pos current position
+         * @param gradient update direction
+         */
+
+        T compute( const tparam_t& tparam, const T lipschitz,
+                   const variable_t& pos, const variable_t& gradient ) const {
+            [[maybe_unused]] scoped_timer_t<phase_t::FEASIBILITY> timer;
+            // one trial position for all probes
+            variable_t x;
+            return this->bisect_interval( [&]( const T alpha ){
+                x = pos;
+                update_t<T,variable_t>::axpy( x, -alpha, gradient );
+                return chi_definite_t<T,N...>::definite( lipschitz*lipschitz, x, tparam );
+            });
+        }
+
+        /**
+         * @brief solve eigenvalue problem; dense reference implementation
          * @param tparam hyperparamater T of matrix chi
          * @param var cholesky decomposition of matrix P
          * @param gradient update direction e.g. matrix D
          */
         
-        T compute( const tparam_t& tparam, const cholesky_t& var, const variable_t& gradient ) const {
+        T compute_dense( const tparam_t& tparam, const cholesky_t& var, const variable_t& gradient ) const {
 
-            auto B = generate_lipschitz_train_b<T,N...>();
-            auto A = generate_lipschitz_train_a<T,N...>( gradient );
             auto Q = generate_lipschitz_train_q_direction<T,N...>( gradient );
-            auto Z = generate_lipschitz_train_t<T,N...>( tparam );
             matrix_t<NN::value,NN::value> L = generate_lipschitz_train_l<T,N...>( var );
 
-
-            matrix_t<NN::value,NN::value> D = blaze::trans(B)*Z*A + blaze::trans(A)*Z*B + Q;
+            // trans(B)*Z*A + trans(A)*Z*B
+            matrix_t<NN::value,NN::value> D = generate_lipschitz_train_bza<T,N...>( gradient, tparam ) + Q;
             matrix_t<NN::value,NN::value> V = blaze::trans( blaze::solve( L, D ) );
             matrix_t<NN::value,NN::value> R = - blaze::solve( L, V ); // -
 
@@ -121,7 +267,7 @@ namespace lipnet {
      */
 
     template<typename T, size_t ...N>
-    struct feasibilitycheck_t {
+    struct feasibilitycheck_t : public chi_definite_t<T,N...> {
 
         template<size_t NN>
         using vector_t = blaze::StaticVector<T, NN, blaze::columnVector>;
@@ -143,7 +289,26 @@ namespace lipnet {
 
 
         /**
-         * @brief solve generalized eigenvalue problem
+         * @brief maximal feasible stepsize by bisection on the block cholesky
+         *          decomposition of chi
+         * @param pos current position
+         * @param gradient update direction
+         * @param rho squared lipschitz constant
+         */
+
+        T compute( const variable_t& pos, const variable_t& gradient, const T rho ) const {
+            [[maybe_unused]] scoped_timer_t<phase_t::FEASIBILITY> timer;
+            // one trial position for all probes
+            variable_t x;
+            return this->bisect( [&]( const T alpha ){
+                x = pos;
+                update_t<T,variable_t>::axpy( x, -alpha, gradient );
+                return chi_definite_t<T,N...>::definite( rho, x.W, x.t );
+            });
+        }
+
+        /**
+         * @brief solve generalized eigenvalue problem; dense reference implementation
          * @tparam kondition init matrix N with that value
          * @param pos current position 
          * @param gradient update direction
@@ -152,17 +317,20 @@ namespace lipnet {
         
         template<typename kondition = std::ratio<2,1>,
                  typename = typename std::enable_if<kondition::den != 0>::type>
-        T compute( const variable_t& pos, const variable_t& gradient, const T rho ) const {
+        T compute_dense( const variable_t& pos, const variable_t& gradient, const T rho ) const {
             constexpr T ratio = ( (T) kondition::num )/( (T) kondition::den );
 
-            auto B = generate_lipschitz_train_b<T,N...>();
-            auto Ag = generate_lipschitz_train_a<T,N...>( gradient.W );
             auto Qg = generate_lipschitz_train_q_direction<T,N...>( gradient.W );
-            auto Zg = generate_lipschitz_train_t<T,N...>( gradient.t );
-
-            auto Ap = generate_lipschitz_train_a<T,N...>( pos.W );
             auto Qp = generate_lipschitz_train_q<T,N...>( pos.W, rho );
-            auto Zp = generate_lipschitz_train_t<T,N...>( pos.t );
+
+            // the products trans(B)*Z*A + trans(A)*Z*B and trans(B)*Z*B of the
+            // selection B and the diagonal Z are assembled blockwise
+            auto BApg = generate_lipschitz_train_bza<T,N...>( gradient.W, pos.t );
+            auto BAgp = generate_lipschitz_train_bza<T,N...>( pos.W, gradient.t );
+            auto BApp = generate_lipschitz_train_bza<T,N...>( pos.W, pos.t );
+            auto BAgg = generate_lipschitz_train_bza<T,N...>( gradient.W, gradient.t );
+            auto BBg = generate_lipschitz_train_bzb<T,N...>( gradient.t );
+            auto BBp = generate_lipschitz_train_bzb<T,N...>( pos.t );
 
 
             matrix_t<2*NN::value,2*NN::value> A, C;
@@ -170,18 +338,15 @@ namespace lipnet {
             blaze::submatrix<0,NN::value,NN::value,NN::value>(A) =
                     ratio*blaze::IdentityMatrix<T>( NN::value );
             blaze::submatrix<NN::value,NN::value,NN::value,NN::value>(A) =
-                    blaze::trans(B)*Zp*Ag + blaze::trans(Ag)*Zp*B + Qg
-                  + blaze::trans(B)*Zg*Ap + blaze::trans(Ap)*Zg*B
-                  - 2*blaze::trans(B)*Zg*B;
+                    BApg + Qg + BAgp - 2*BBg;
             blaze::submatrix<NN::value,0,NN::value,NN::value>(A) =
-                    blaze::trans(B)*Zp*Ap + blaze::trans(Ap)*Zp*B + Qp
-                  - 2*blaze::trans(B)*Zp*B;
+                    BApp + Qp - 2*BBp;
 
 
             blaze::submatrix<0,0,NN::value,NN::value>(C) =
                     ratio*blaze::IdentityMatrix<T>( NN::value );
             blaze::submatrix<NN::value,NN::value,NN::value,NN::value>(C) =
-                    - blaze::trans(B)*Zg*Ag - blaze::trans(Ag)*Zg*B;
+                    - BAgg;
 
 
             blaze::StaticVector<std::complex<T>,2*NN::value,blaze::columnVector> alpha;
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_LIPSCHITZ_KERNELS_HPP__
+#define __LIPNET_LIPSCHITZ_KERNELS_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <stdexcept>
+#include <cmath>
+
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+
+
+
+
+namespace lipnet {
+
+    /**
+     * Kernels of the block cholesky decomposition of chi. The blocks of small networks
+     * are a few rows wide, for them the dispatch of blaze (and lapack for llh and solve)
+     * costs more than the flops. Up to block_kernel_limit rows the loops below have
+     * compile time bounds; they are unrolled and the blocks stay in registers. Larger
+     * blocks use blaze.
+     */
+
+    /// largest dimension of the unrolled kernels
+    inline constexpr size_t block_kernel_limit = 16;
+
+    /// true if all dimensions are handled by the unrolled kernels
+    template<size_t ...D>
+    inline constexpr bool block_kernel_v = ( ( D <= block_kernel_limit ) && ... );
+
+
+    /**
+     * @brief cholesky decomposition A = L trans(L); only the lower part of A is read
+     * @param A symmetric positive definite matrix
+     * @param L lower factor; the return value
+     * @throw std::invalid_argument if A is not positive definite, like blaze::llh
+     */
+
+    template<typename T, size_t NN, bool SO>
+    inline void block_llh( const blaze::StaticMatrix<T,NN,NN,SO> &A,
+                           blaze::LowerMatrix<blaze::StaticMatrix<T,NN,NN,SO>> &L ) {
+        if constexpr ( block_kernel_v<NN> ) {
+            blaze::StaticMatrix<T,NN,NN,SO> R( T(0) );
+
+            for( size_t j = 0; j < NN; ++j ) {
+                T d = A(j,j);
+                for( size_t k = 0; k < j; ++k )
+                    d -= R(j,k)*R(j,k);
+
+                if( !( d > T(0) ) )
+                    throw std::invalid_argument( "decomposition of a non positive definite matrix" );
+
+                d = std::sqrt( d ); R(j,j) = d;
+
+                const T inv = T(1) / d;
+                for( size_t i = j+1; i < NN; ++i ) {
+                    T s = A(i,j);
+                    for( size_t k = 0; k < j; ++k )
+                        s -= R(i,k)*R(j,k);
+                    R(i,j) = s*inv;
+                }
+            }
+
+            L = blaze::decllow( R );
+        } else {
+            blaze::llh( A, L );
+        }
+    }
+
+
+    /**
+     * @brief forward substitution; X = D^-1 B
+     * @param D lower triangular matrix
+     * @param B right hand sides, one per column
+     */
+
+    template<typename T, size_t NN, size_t M, bool SO, bool SOB>
+    inline blaze::StaticMatrix<T,NN,M,SOB> block_solve( const blaze::LowerMatrix<blaze::StaticMatrix<T,NN,NN,SO>> &D,
+                                                         const blaze::StaticMatrix<T,NN,M,SOB> &B ) {
+        if constexpr ( block_kernel_v<NN,M> ) {
+            blaze::StaticMatrix<T,NN,M,SOB> X( B );
+
+            for( size_t i = 0; i < NN; ++i ) {
+                for( size_t k = 0; k < i; ++k ) {
+                    const T d = D(i,k);
+                    for( size_t j = 0; j < M; ++j )
+                        X(i,j) -= d*X(k,j);
+                }
+                const T inv = T(1) / D(i,i);
+                for( size_t j = 0; j < M; ++j )
+                    X(i,j) *= inv;
+            }
+
+            return X;
+        } else {
+            return blaze::solve( D, B );
+        }
+    }
+
+
+    /**
+     * @brief backward substitution with the transposed factor; X = trans(D)^-1 B
+     * @param D lower triangular matrix
+     * @param B right hand sides, one per column
+     */
+
+    template<typename T, size_t NN, size_t M, bool SO, bool SOB>
+    inline blaze::StaticMatrix<T,NN,M,SOB> block_solve_trans( const blaze::LowerMatrix<blaze::StaticMatrix<T,NN,NN,SO>> &D,
+                                                               const blaze::StaticMatrix<T,NN,M,SOB> &B ) {
+        if constexpr ( block_kernel_v<NN,M> ) {
+            blaze::StaticMatrix<T,NN,M,SOB> X( B );
+
+            for( size_t i = NN; i-- > 0; ) {
+                for( size_t k = i+1; k < NN; ++k ) {
+                    const T d = D(k,i);
+                    for( size_t j = 0; j < M; ++j )
+                        X(i,j) -= d*X(k,j);
+                }
+                const T inv = T(1) / D(i,i);
+                for( size_t j = 0; j < M; ++j )
+                    X(i,j) *= inv;
+            }
+
+            return X;
+        } else {
+            return blaze::solve( blaze::declupp( blaze::trans( D ) ), B );
+        }
+    }
+
+
+    /**
+     * @brief in place inversion of a lower triangular matrix
+     * @param D lower triangular matrix; its inverse on return
+     */
+
+    template<typename T, size_t NN, bool SO>
+    inline void block_invert( blaze::LowerMatrix<blaze::StaticMatrix<T,NN,NN,SO>> &D ) {
+        if constexpr ( block_kernel_v<NN> ) {
+            blaze::StaticMatrix<T,NN,NN,SO> X( T(0) );
+
+            // column j of the inverse; entries above the diagonal stay zero
+            for( size_t j = 0; j < NN; ++j ) {
+                X(j,j) = T(1) / D(j,j);
+                for( size_t i = j+1; i < NN; ++i ) {
+                    T s = 0;
+                    for( size_t k = j; k < i; ++k )
+                        s -= D(i,k)*X(k,j);
+                    X(i,j) = s / D(i,i);
+                }
+            }
+
+            D = blaze::decllow( X );
+        } else {
+            blaze::invert( D );
+        }
+    }
+
+
+    /**
+     * @brief symmetric rank update; X -= L trans(L)
+     * @param X symmetric matrix; updated in place
+     * @param L factor
+     */
+
+    template<typename T, size_t NN, size_t K, bool SO, bool SOL>
+    inline void block_syrk_sub( blaze::StaticMatrix<T,NN,NN,SO> &X, const blaze::StaticMatrix<T,NN,K,SOL> &L ) {
+        if constexpr ( block_kernel_v<NN,K> ) {
+            for( size_t i = 0; i < NN; ++i )
+                for( size_t j = 0; j <= i; ++j ) {
+                    T s = 0;
+                    for( size_t k = 0; k < K; ++k )
+                        s += L(i,k)*L(j,k);
+                    X(i,j) -= s;
+                    if( i != j ) X(j,i) -= s;
+                }
+        } else {
+            X -= L * blaze::trans( L );
+        }
+    }
+
+}
+
+#endif // __LIPNET_LIPSCHITZ_KERNELS_HPP__
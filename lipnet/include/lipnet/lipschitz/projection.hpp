@@ -0,0 +1,187 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_LIPSCHITZ_PROJECTION_HPP__
+#define __LIPNET_LIPSCHITZ_PROJECTION_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+#include <lipnet/tuple.hpp>
+#include <lipnet/variable.hpp>
+
+#include <lipnet/network/network.hpp>
+
+#include <lipnet/lipschitz/topology.hpp>
+#include <lipnet/lipschitz/structure.hpp>
+#include <lipnet/lipschitz/feasibility.hpp>
+
+
+namespace lipnet {
+
+    /**
+     * @brief The first_order_projection_t struct. Compute the projection of the reference
+     *          weights without a conic solver; admm with eigenvalue clipping on the
+     *          psd block and a closed form weight update
+     *
+     *              @f[ \arg \min_{W,S} \quad \frac{1}{2} || W - W_\mathrm{ref} ||^2
+     *                      \quad \mathrm{s.t} \quad \chi(\Psi^2,W) = S \succeq 0 @f]
+     *
+     *          Every weight only appears in one pair of off-diagonal blocks of chi, hence
+     *          the weight update is a row-wise scaling. The result is pulled back to
+     *          the feasible set along the ray towards W = 0, which is strictly feasible.
+     *          Same interface as mosek_projection_wot_t.
+     *
+     * @tparam T numerical value type
+     * @tparam N network topology
+     */
+
+    template<typename T, size_t ...N>
+    struct first_order_projection_t {
+
+        template<size_t NN>
+        using vector_t = blaze::StaticVector<T, NN, blaze::columnVector>;
+
+        template<size_t NN1, size_t NN2>
+        using matrix_t = blaze::StaticMatrix<T, NN1, NN2, blaze::rowMajor>;
+
+        typedef blaze::DynamicMatrix<T, blaze::rowMajor> dmatrix_t;
+
+        typedef std::integral_constant<size_t, sizeof... (N)-1> L;
+        typedef std::integral_constant<size_t, (N + ... )> NL;
+
+        typedef typename network_t<T, identity_activation_t, N...>::layer_t variable_t;
+        typedef typename parameter_tparam<T,N...>::type tparam_t;
+
+
+        /// squared lipschitz constant
+        T rho;
+
+        /// hyperparameter T of chi matrix
+        tparam_t tparam;
+
+        /// admm penalty parameter (default = 1)
+        T penalty = 1.0;
+
+        /// maximal admm iterations (default = 200)
+        size_t max_iter = 200;
+
+        /// stopping criterion primal residual (default = 1e-6)
+        T tolerance = 1e-6;
+
+        /// psd block and scaled dual of the last projection; warm start
+        dmatrix_t S, U;
+
+
+        /**
+         * @brief first_order_projection_t; default constructor
+         * @param lipschitz lipschitz integral_constant
+         * @param tinitval hyperparameter T of chi matrix
+         */
+
+        first_order_projection_t( const T lipschitz, const T &tinitval )
+            : rho{ lipschitz*lipschitz }, tparam{ generator_t<tparam_t>::make( tinitval ) } {
+            dmatrix_t X = generate_lipschitz_chi<T,N...>(
+                        generator_t<variable_t>::make( T(0) ), tparam, rho );
+            S = X; U = dmatrix_t( NL::value, NL::value, T(0) );
+        }
+
+
+        /**
+         * @brief Compute projetion of weights into feasible set
+         * @param ref reference weights; computed during gradient descent step
+         */
+
+        variable_t project( variable_t &&ref ) {
+            variable_t result = ref;
+
+            for( size_t k = 0; k < max_iter; ++k ) {
+                dmatrix_t M = S - U;
+
+                // weight update; closed form
+                std::for_range<0,L::value>([&]<auto I>(){
+                    auto& W = std::get<I>( result ).weight;
+                    auto& R = std::get<I>( ref ).weight;
+
+                    auto Msub = blaze::submatrix<sum<I+1,N...>(), sum<I,N...>(),
+                                        at<I+1,N...>(), at<I,N...>() >( M );
+
+                    if constexpr ( I < L::value-1 ) {
+                        auto t = blaze::expand<at<I,N...>()>( std::get<I>( tparam ) );
+                        W = blaze::map( R - 2*penalty*( t % Msub ), t, [&]( const T r, const T ti ){
+                                return r / ( 1 + 2*penalty*ti*ti ); });
+                    }
+
+                    if constexpr ( I == L::value-1 )
+                        W = ( R - 2*penalty*Msub ) / ( 1 + 2*penalty );
+                });
+
+                // psd update; eigenvalue clipping
+                dmatrix_t X = generate_lipschitz_chi<T,N...>( result, tparam, rho );
+                blaze::SymmetricMatrix<dmatrix_t> Y = blaze::declsym( X + U );
+
+                blaze::DynamicVector<T, blaze::columnVector> w;
+                dmatrix_t V;
+                blaze::eigen( Y, w, V );
+
+                w = blaze::max( w, T(0) );
+                S = blaze::trans( V ) * ( blaze::expand( w, NL::value ) % V );
+
+                // dual update
+                X -= S;
+                U += X;
+
+                if( blaze::norm( X ) < tolerance )
+                    break;
+            }
+
+            // pull back into the feasible set
+            const auto feasible = [&]( const T s ){
+                variable_t x = result;
+                std::for_range<0,L::value>([&]<auto I>(){ std::get<I>( x ).weight *= s; });
+                return chi_definite_t<T,N...>::definite( rho, x, tparam );
+            };
+
+            if( !feasible( T(1) ) ) {
+                T lo = 0, hi = 1;
+                for( size_t i = 0; i < 30; ++i ) {
+                    const T mid = ( lo + hi ) / 2;
+                    if( feasible( mid ) ) lo = mid;
+                    else hi = mid;
+                }
+
+                std::for_range<0,L::value>([&]<auto I>(){ std::get<I>( result ).weight *= lo; });
+            }
+
+            return std::move( result );
+        }
+
+    };
+
+}
+
+#endif // __LIPNET_LIPSCHITZ_PROJECTION_HPP__
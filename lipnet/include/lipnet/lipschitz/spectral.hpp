@@ -0,0 +1,130 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_LIPSCHITZ_SPECTRAL_HPP__
+#define __LIPNET_LIPSCHITZ_SPECTRAL_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <cmath>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/tuple.hpp>
+#include <cereal/types/array.hpp>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+#include <lipnet/tuple.hpp>
+
+#include <lipnet/network/topology.hpp>
+
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief The spectral_estimator_t struct; tracks the spectral norms of the weights
+     *          during training with power iteration. The right singular vectors are
+     *          kept between calls, thus an update with slowly changing weights costs
+     *          only W*v and trans(W)*u per layer and step. The estimates approach the
+     *          spectral norms from below; their product estimates the trivial bound.
+     * @tparam T numerical value type
+     * @tparam N network topology
+     * @see calculate_lipschitz_t::trivial_lipschitz
+     */
+
+    template<typename T, size_t ...N>
+    struct spectral_estimator_t {
+
+        typedef std::integral_constant<size_t, sizeof... (N)-1> L;
+        typedef typename network_topology<T, N...>::type variable_t;
+
+        /// right singular vector estimates; one per layer (the last entry is unused)
+        typename generate_data<T, N...>::type vectors;
+
+        /// spectral norm estimates of the last update
+        std::array<T, L::value> sigma{};
+
+        /// power iterations per update (default = 1)
+        size_t steps = 1;
+
+        /// power iterations of the first update (default = 20)
+        size_t warmup = 20;
+
+        bool initialized = false;
+
+
+        /**
+         * @brief continue the power iterations with the current weights
+         * @param var network weights
+         * @return product of the spectral norm estimates
+         */
+
+        T update( const variable_t &var ) {
+            const size_t n = initialized ? steps : std::max( steps, warmup );
+
+            T lipschitz = 1.0;
+
+            std::for_range<0, L::value>([&]<auto I>(){
+                auto &v = std::get<I>( vectors );
+                const auto &w = std::get<I>( var ).weight;
+
+                if( !initialized )
+                    for( size_t k = 0; k < v.size(); ++k )
+                        v[k] = T(1) + T(0.5)*std::sin( T(k+1) );
+
+                for( size_t s = 0; s < n; ++s ) {
+                    const blaze::StaticVector<T, at<I+1,N...>(), blaze::columnVector> u = w * v;
+                    const T nu = blaze::norm( u );
+                    if( nu == T(0) ) { sigma[I] = 0; break; }
+
+                    v = blaze::trans( w ) * u;
+                    const T nv = blaze::norm( v );
+                    sigma[I] = nv / nu;
+                    v /= nv;
+                }
+
+                lipschitz *= sigma[I];
+            });
+
+            initialized = true;
+            return lipschitz;
+        }
+
+        /// forget the singular vectors, e.g. after a jump of the weights
+        inline void reset() {
+            initialized = false;
+        }
+
+        /// @cite cereallib
+        template<class Archive> void serialize( Archive & archive ) {
+            archive( vectors, sigma, initialized );
+        }
+    };
+
+}
+
+#endif // __LIPNET_LIPSCHITZ_SPECTRAL_HPP__
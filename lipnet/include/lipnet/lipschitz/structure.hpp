@@ -174,6 +174,111 @@ namespace lipnet {
 
 
 
+    /**
+     * @brief structured product trans(B)*Z*A + trans(A)*Z*B; B selects the hidden
+     *          neurons and Z = diag(tparam), thus the product is the block
+     *          tridiagonal embedding of the scaled hidden weights. Assembled
+     *          blockwise in O(nnz) instead of two sparse triple products.
+     * @param weights network weights (matrix A)
+     * @param tparam hyperparameter T of matrix chi (matrix Z)
+     * @see generate_lipschitz_train_a
+     * @see generate_lipschitz_train_b
+     * @see generate_lipschitz_train_t
+     */
+
+    template<typename T, size_t ...N, typename variable_t
+             = typename network_topology<T, N...>::type >
+    inline auto generate_lipschitz_train_bza( const variable_t &weights,
+                                              const typename parameter_tparam<T,N...>::type &tparam ) {
+        typedef std::integral_constant<size_t, sizeof... (N)-1 > L;
+        typedef std::integral_constant<size_t, (N + ...) > NN;
+
+        auto S = blaze::CompressedMatrix<T, blaze::columnMajor>(
+                    NN::value, NN::value );
+
+        std::for_range<0,L::value-1>([&]<auto I>(){
+            const blaze::StaticMatrix<T, at<I+1,N...>(), at<I,N...>(), blaze::rowMajor> ZA
+                    = blaze::expand<at<I,N...>()>( std::get<I>( tparam ) ) % std::get<I>( weights ).weight;
+
+            blaze::submatrix<sum<I+1,N...>(), sum<I,N...>(),
+                    at<I+1,N...>(), at<I,N...>() >( S ) = ZA;
+            blaze::submatrix<sum<I,N...>(), sum<I+1,N...>(),
+                    at<I,N...>(), at<I+1,N...>() >( S ) = blaze::trans( ZA );
+        });
+
+        return std::move(S);
+    }
+
+
+    /**
+     * @brief structured product trans(B)*Z*B; the diagonal of the hidden neurons
+     * @param tparam hyperparameter T of matrix chi (matrix Z)
+     * @see generate_lipschitz_train_bza
+     */
+
+    template<typename T, size_t ...N>
+    inline auto generate_lipschitz_train_bzb( const typename parameter_tparam<T,N...>::type &tparam ) {
+        typedef std::integral_constant<size_t, (N + ...) > NN;
+
+        auto S = blaze::CompressedMatrix<T, blaze::columnMajor>(
+                    NN::value, NN::value );
+
+        std::for_range<0,sizeof... (N)-2>([&]<auto I>(){
+            blaze::subvector<sum<I+1,N...>(),at<I+1,N...>()>(
+                    blaze::diagonal( S )) = std::get<I>( tparam );
+        });
+
+        return std::move(S);
+    }
+
+
+
+    /**
+     * @brief dense matrix chi for fixed hyperparameter T; the matrix of the
+     *          feasibility constraint chi(rho,W) >= 0
+     * @param weights network weights
+     * @param tparam hyperparameter T of matrix chi
+     * @param rho squared lipschitz constant
+     */
+
+    template<typename T, size_t ...N, typename variable_t
+             = typename network_topology<T, N...>::type >
+    inline auto generate_lipschitz_chi( const variable_t &weights,
+                                        const typename parameter_tparam<T,N...>::type &tparam, const T rho ) {
+        typedef std::integral_constant<size_t, sizeof... (N)-1 > L;
+        typedef std::integral_constant<size_t, (N + ...) > NN;
+
+        blaze::DynamicMatrix<T, blaze::rowMajor> X( NN::value, NN::value, T(0) );
+
+        blaze::submatrix<0,0,at<0,N...>(),at<0,N...>()>( X )
+                 = rho * blaze::IdentityMatrix<T>( at<0,N...>() );
+
+        std::for_range<0,L::value>([&]<auto I>(){
+            auto sub = blaze::submatrix<sum<I+1,N...>(), sum<I,N...>(),
+                                    at<I+1,N...>(), at<I,N...>() >( X );
+            auto sup = blaze::submatrix<sum<I,N...>(), sum<I+1,N...>(),
+                                    at<I,N...>(), at<I+1,N...>() >( X );
+            auto diag = blaze::submatrix<sum<I+1,N...>(), sum<I+1,N...>(),
+                                    at<I+1,N...>(), at<I+1,N...>() >( X );
+
+            if constexpr ( I < L::value-1 ) {
+                sub = - blaze::expand<at<I,N...>()>( std::get<I>( tparam ) ) % std::get<I>( weights ).weight;
+                blaze::diagonal( diag ) = 2*std::get<I>( tparam );
+            }
+
+            if constexpr ( I == L::value-1 ) {
+                sub = - std::get<I>( weights ).weight;
+                diag = blaze::IdentityMatrix<T>( at<I+1,N...>() );
+            }
+
+            sup = blaze::trans( sub );
+        });
+
+        return std::move(X);
+    }
+
+
+
     template<typename T, size_t ...N, typename variable_t
              = typename network_topology<T, N...>::type >
     inline auto generate_lipschitz_train_l( const typename cholesky_topology<T,N...>::type &lower ) {
@@ -202,9 +307,9 @@ namespace lipnet {
 
     template<typename T, size_t ...N, typename variable_t
              = typename network_topology<T, N...>::type >
-    inline void extract_lipschitz_train_p( const blaze::StaticMatrix<double, (N + ...), (N + ...),
+    inline void extract_lipschitz_train_p( const blaze::StaticMatrix<T, (N + ...), (N + ...),
                                            blaze::columnMajor> &p,
-                                           const blaze::StaticVector<double, (N + ...) - at<0,N...>()
+                                           const blaze::StaticVector<T, (N + ...) - at<0,N...>()
                                                     - at<sizeof... (N)-1,N...>() > &Tmat, variable_t &weights ) {
 
          typedef std::integral_constant<size_t, sizeof... (N)-1 > L;
@@ -219,13 +324,13 @@ namespace lipnet {
 
 
             if constexpr ( I < L::value-1 ) {
-                auto Tsub = 1.0 / blaze::subvector<sum<I+1,N...>() - at<0,N...>(),
+                auto Tsub = T(1) / blaze::subvector<sum<I+1,N...>() - at<0,N...>(),
                                       at<I+1,N...>() >(Tmat);
-                W = -1.0 * blaze::expand<at<I,N...>()>( Tsub ) % Psub;
+                W = T(-1) * blaze::expand<at<I,N...>()>( Tsub ) % Psub;
             }
 
             if constexpr ( I == L::value )
-                W = -1.0 * Psub;
+                W = T(-1) * Psub;
         });
 
     }
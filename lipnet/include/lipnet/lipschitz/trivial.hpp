@@ -28,6 +28,7 @@
 #include <utility>
 #include <initializer_list>
 #include <deque>
+#include <cmath>
 
 
 #include <lipnet/traits.hpp>
@@ -74,6 +75,115 @@ namespace lipnet {
             return lipschitz;
 
         }
+
+        /**
+         * @brief product of sqrt( ||W||_1 ||W||_inf ) of the weights, the maximal
+         *          absolute column and row sums; cheap upper bound of the spectral norms
+         *          (||W||_2^2 <= ||W||_1 ||W||_inf) without a singular value decomposition
+         * @param var network weights
+         */
+
+        static T column_sum_lipschitz( const variable_t &var ) {
+
+            T lipschitz = 1.0;
+
+            std::for_range<0,sizeof... (N)-1>([&]<auto I>(){
+                auto &w = std::get<I>( var ).weight;
+                const T columns = blaze::max( blaze::reduce<blaze::columnwise>( blaze::abs( w ), blaze::Add() ) );
+                const T rows = blaze::max( blaze::reduce<blaze::rowwise>( blaze::abs( w ), blaze::Add() ) );
+                lipschitz *= std::sqrt( columns * rows );
+            });
+
+            return lipschitz;
+
+        }
+
+        /**
+         * @brief guaranteed upper bound of the spectral norm by repeated squaring of the
+         *          gram matrix A; lambda_max(A) <= ||A^p||_F^(1/p) with p = 2^squarings.
+         *          The bound overestimates by at most a factor n^(1/2p), n the smaller
+         *          dimension of w. The powers are normalised, the scale is kept as log.
+         * @param w weight matrix
+         * @param squarings number of squarings (default = 5)
+         */
+
+        template<typename MT>
+        static T spectral_norm_bound( const MT &w, const size_t squarings = 5 ) {
+            blaze::DynamicMatrix<T, blaze::rowMajor> A = ( w.rows() < w.columns() )
+                    ? blaze::DynamicMatrix<T, blaze::rowMajor>( w * blaze::trans( w ) )
+                    : blaze::DynamicMatrix<T, blaze::rowMajor>( blaze::trans( w ) * w );
+
+            T logscale = 0, p = 1;
+            for( size_t k = 0; k < squarings; ++k ) {
+                const T s = blaze::norm( A );
+                if( s == T(0) ) return 0;
+
+                A /= s; logscale = 2*( logscale + std::log( s ) ); p *= 2;
+                A = A * A;
+            }
+
+            const T s = blaze::norm( A );
+            if( s == T(0) ) return 0;
+
+            return std::sqrt( std::exp( ( logscale + std::log( s ) ) / p ) );
+        }
+
+        /**
+         * @brief product of the spectral norm bounds of the weights; upper bound without
+         *          a singular value decomposition
+         * @param var network weights
+         * @param squarings number of squarings per layer (default = 5)
+         * @see spectral_norm_bound
+         */
+
+        static T power_lipschitz( const variable_t &var, const size_t squarings = 5 ) {
+
+            T lipschitz = 1.0;
+
+            std::for_range<0,sizeof... (N)-1>([&]<auto I>(){
+                lipschitz *= spectral_norm_bound( std::get<I>( var ).weight, squarings );
+            });
+
+            return lipschitz;
+
+        }
+
+        /**
+         * @brief lower bound of every sdp bound of the network; spectral norm of the
+         *          linear network W_L ... W_1 (the identity is slope restricted as well),
+         *          estimated by power iteration. Any iterate is a lower bound.
+         * @param var network weights
+         * @param iterations number of power iterations (default = 20)
+         */
+
+        static T linear_lipschitz( const variable_t &var, const size_t iterations = 20 ) {
+            typedef std::integral_constant<size_t, sizeof... (N)-1> L;
+
+            blaze::DynamicVector<T, blaze::columnVector> v( at<0,N...>() ), u;
+            for( size_t i = 0; i < v.size(); ++i )
+                v[i] = T(1) + T(0.5)*std::sin( T(i+1) );
+
+            T lipschitz = 0;
+            for( size_t k = 0; k < iterations; ++k ) {
+                v /= blaze::norm( v );
+
+                u = v;
+                std::for_range<0,L::value>([&]<auto I>(){
+                    u = std::get<I>( var ).weight * u;
+                });
+
+                lipschitz = std::max( lipschitz, T( blaze::norm( u ) ) );
+                if( lipschitz == T(0) ) return 0;
+
+                v = u;
+                std::for_range<0,L::value>([&]<auto I>(){
+                    v = blaze::trans( std::get<L::value-1-I>( var ).weight ) * v;
+                });
+            }
+
+            return lipschitz;
+
+        }
     };
 
 
@@ -0,0 +1,305 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_BINARY_LOADER_HPP__
+#define __LIPNET_BINARY_LOADER_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <optional>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+
+#include <lipnet/network/data.hpp>
+
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief header of the binary dataset format; followed by the inputs and the
+     *          targets as unpadded column-major arrays (one sample per column),
+     *          both starting at a multiple of alignment bytes
+     */
+
+    struct binary_header_t {
+        static constexpr uint32_t magic_value = 0x4450494c; // "LIPD"
+        static constexpr uint32_t version_value = 1;
+        static constexpr uint64_t alignment = 64;
+
+        uint32_t magic = magic_value;
+        uint32_t version = version_value;
+        uint32_t dtype = 0;          /// size of the stored value type in bytes (4 = float, 8 = double)
+        uint32_t reserved = 0;
+        uint64_t samples = 0;        /// number of samples
+        uint64_t inputs = 0;         /// input dimension
+        uint64_t outputs = 0;        /// target dimension
+        uint64_t ioffset = 0;        /// byte offset of the inputs
+        uint64_t toffset = 0;        /// byte offset of the targets
+
+        /// round up to the alignment
+        static inline uint64_t align( const uint64_t bytes ) {
+            return ( bytes + alignment - 1 ) / alignment * alignment;
+        }
+    };
+
+
+    /**
+     * @brief read only memory mapping of a file; unmapped on destruction
+     */
+
+    struct mapped_file_t {
+        const char *data = nullptr;
+        size_t size = 0;
+
+        explicit mapped_file_t( const std::string &path ) {
+            const int fd = ::open( path.c_str(), O_RDONLY );
+            if( fd < 0 ) return;
+
+            struct stat st;
+            if( ::fstat( fd, &st ) == 0 && st.st_size > 0 ) {
+                void *ptr = ::mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+                if( ptr != MAP_FAILED ) {
+                    data = static_cast<const char*>( ptr );
+                    size = st.st_size;
+                }
+            }
+
+            ::close( fd );
+        }
+
+        mapped_file_t( const mapped_file_t& ) = delete;
+        mapped_file_t& operator=( const mapped_file_t& ) = delete;
+
+        ~mapped_file_t() {
+            if( data ) ::munmap( const_cast<char*>( data ), size );
+        }
+
+        inline bool valid() const { return data != nullptr; }
+    };
+
+
+    /**
+     * @brief struct for loading and storing the binary dataset format; the arrays
+     *          are mapped into memory and copied into the column layout of
+     *          network_data_t without parsing
+     * @tparam T numerical value type
+     */
+
+    template<typename T>
+    struct binary_loader_t
+    {
+        typedef blaze::DynamicMatrix<T, blaze::columnMajor> cmatrix_t;
+
+        /**
+         * @brief store matrices in the binary format
+         * @tparam S stored value type (e.g. float to halve the file size)
+         * @param path path to file on filesystem
+         * @param icols inputs; one sample per column
+         * @param tcols targets; one sample per column
+         * @return false if the file could not be written
+         */
+
+        template<typename S = T>
+        static bool save( const std::string &path, const cmatrix_t &icols, const cmatrix_t &tcols ) {
+            if( icols.columns() != tcols.columns() )
+                throw std::string{"number of inputs and targets differ"};
+
+            binary_header_t header;
+            header.dtype = sizeof(S);
+            header.samples = icols.columns();
+            header.inputs = icols.rows();
+            header.outputs = tcols.rows();
+            header.ioffset = binary_header_t::align( sizeof(binary_header_t) );
+            header.toffset = binary_header_t::align( header.ioffset
+                                   + header.inputs*header.samples*sizeof(S) );
+
+            std::ofstream os( path, std::ios::binary );
+            if( !os ) return false;
+
+            os.write( reinterpret_cast<const char*>( &header ), sizeof(header) );
+
+            const auto write = [&]( const cmatrix_t &m, const uint64_t offset ){
+                std::vector<char> pad( offset - os.tellp(), 0 );
+                os.write( pad.data(), pad.size() );
+
+                std::vector<S> column( m.rows() );
+                for( size_t j = 0UL; j < m.columns(); ++j ) {
+                    for( size_t i = 0UL; i < m.rows(); ++i )
+                        column[i] = static_cast<S>( m(i,j) );
+                    os.write( reinterpret_cast<const char*>( column.data() ), column.size()*sizeof(S) );
+                }
+            };
+
+            write( icols, header.ioffset );
+            write( tcols, header.toffset );
+
+            return (bool) os;
+        }
+
+        /**
+         * @brief store training data in the binary format
+         * @tparam S stored value type
+         * @param path path to file on filesystem
+         * @param data training data; either layout
+         */
+
+        template<typename S = T, size_t IN, size_t OUT>
+        static bool save( const std::string &path, const network_data_t<T, IN, OUT> &data ) {
+            if( data.columnwise() )
+                return save<S>( path, data.icols, data.tcols );
+            return save<S>( path, cmatrix_t( blaze::trans( data.idata ) ),
+                                 cmatrix_t( blaze::trans( data.tdata ) ) );
+        }
+
+
+        /**
+         * @brief read and validate the header of a mapped binary dataset
+         * @param file mapped file
+         * @param path path to file on filesystem; used in the error messages
+         * @return header; both arrays are contained in the file
+         */
+
+        static binary_header_t header( const mapped_file_t &file, const std::string &path ) {
+            binary_header_t header;
+            std::memcpy( &header, file.data, sizeof(header) );
+
+            if( header.magic != binary_header_t::magic_value
+                    || header.version != binary_header_t::version_value )
+                throw std::string{"not a binary dataset: "} + path;
+
+            if( header.dtype != sizeof(float) && header.dtype != sizeof(double) )
+                throw std::string{"unknown value type in binary dataset: "} + path;
+
+            if( header.ioffset + header.inputs*header.samples*header.dtype > file.size
+                    || header.toffset + header.outputs*header.samples*header.dtype > file.size )
+                throw std::string{"truncated binary dataset: "} + path;
+
+            return header;
+        }
+
+        /**
+         * @brief copy columns of a mapped array
+         * @param file mapped file
+         * @param header header of the file
+         * @param offset byte offset of the array
+         * @param rows rows of the array
+         * @param first first column
+         * @param count number of columns
+         * @param m the copied columns; the return value
+         */
+
+        static void columns( const mapped_file_t &file, const binary_header_t &header,
+                             const uint64_t offset, const uint64_t rows,
+                             const size_t first, const size_t count, cmatrix_t &m ) {
+            const auto copy = [&]<typename S>( S* ){
+                blaze::CustomMatrix<const S, blaze::unaligned, blaze::unpadded, blaze::columnMajor>
+                        view( reinterpret_cast<const S*>( file.data + offset ), rows, header.samples );
+                m = blaze::submatrix( view, 0UL, first, rows, count );
+            };
+
+            if( header.dtype == sizeof(float) ) copy( (float*) nullptr );
+            else copy( (double*) nullptr );
+        }
+
+        /**
+         * @brief load matrices from the binary format
+         * @param path path to file on filesystem
+         * @return inputs and targets; one sample per column
+         */
+
+        static std::optional<std::tuple<cmatrix_t, cmatrix_t>> load( const std::string &path ) {
+            mapped_file_t file( path );
+            if( !file.valid() || file.size < sizeof(binary_header_t) ) return std::nullopt;
+
+            const binary_header_t h = header( file, path );
+
+            cmatrix_t icols, tcols;
+            columns( file, h, h.ioffset, h.inputs, 0UL, h.samples, icols );
+            columns( file, h, h.toffset, h.outputs, 0UL, h.samples, tcols );
+
+            return std::make_tuple( std::move(icols), std::move(tcols) );
+        }
+
+        /**
+         * @brief load training data from the binary format; the data is stored
+         *          one sample per column
+         * @tparam IN input dimension
+         * @tparam OUT output dimension
+         * @param path path to file on filesystem
+         * @return training data
+         */
+
+        template<size_t IN, size_t OUT>
+        static std::optional<network_data_t<T, IN, OUT>> load_network_data( const std::string &path ) {
+            auto opt = load( path );
+            if( !opt.has_value() ) return std::nullopt;
+
+            auto &[ icols, tcols ] = opt.value();
+            if( icols.rows() != IN || tcols.rows() != OUT )
+                throw std::string{"dimensions of binary dataset do not match: "} + path;
+
+            network_data_t<T, IN, OUT> data;
+            data.icols = std::move( icols );
+            data.tcols = std::move( tcols );
+
+            return std::move(data);
+        }
+
+        /**
+         * @brief load training data of a runtime topology from the binary format; the
+         *          dimensions are taken from the header
+         * @param path path to file on filesystem
+         * @return training data
+         */
+
+        static std::optional<dynamic_data_t<T>> load_dynamic_data( const std::string &path ) {
+            auto opt = load( path );
+            if( !opt.has_value() ) return std::nullopt;
+
+            auto &[ icols, tcols ] = opt.value();
+
+            dynamic_data_t<T> data;
+            data.icols = std::move( icols );
+            data.tcols = std::move( tcols );
+
+            return std::move(data);
+        }
+
+    };
+
+}
+
+#endif // __LIPNET_BINARY_LOADER_HPP__
@@ -32,6 +32,8 @@
 #include <lipnet/traits.hpp>
 #include <lipnet/tensor.hpp>
 
+#include <lipnet/network/data.hpp>
+
 #include <csv2/csv2.hpp>
 
 #include <cereal/cereal.hpp>
@@ -125,6 +127,95 @@ namespace lipnet {
             return std::move(data);
         }
 
+        /**
+         * @brief load training data from csv file; each row holds the inputs
+         *          followed by the label
+         * @tparam IN input dimension
+         * @tparam OUT number of classes
+         * @param path path to file on filesystem
+         * @param columnwise store one sample per column; the layout used in the
+         *          backpropagation, which is then used without conversion
+         * @param labels keep the class labels instead of one-hot targets
+         * @return training data
+         */
+
+        template<size_t IN, size_t OUT>
+        static std::optional<network_data_t<T, IN, OUT>> load_network_data( const std::string &path,
+                                                                           const bool columnwise = false,
+                                                                           const bool labels = false ) {
+            auto opt = load( path );
+            if( !opt.has_value() ) return std::nullopt;
+
+            network_data_t<T, IN, OUT> data;
+            assign( opt.value(), IN, OUT, columnwise, labels, path, data );
+
+            return std::move(data);
+        }
+
+        /**
+         * @brief load training data of a runtime topology from csv file; all but the
+         *          last column are the inputs
+         * @param path path to file on filesystem
+         * @param outputs number of classes
+         * @param columnwise store one sample per column
+         * @param labels keep the class labels instead of one-hot targets
+         * @return training data
+         * @see load_network_data( const std::string &path, const bool columnwise, const bool labels )
+         */
+
+        static std::optional<dynamic_data_t<T>> load_dynamic_data( const std::string &path, const size_t outputs,
+                                                                  const bool columnwise = true,
+                                                                  const bool labels = false ) {
+            auto opt = load( path );
+            if( !opt.has_value() ) return std::nullopt;
+
+            const dmatrix_t &raw = opt.value();
+            if( raw.rows() < 2 )
+                throw std::string{"no inputs in "} + path;
+
+            dynamic_data_t<T> data;
+            assign( raw, raw.rows()-1, outputs, columnwise, labels, path, data );
+
+            return std::move(data);
+        }
+
+        /**
+         * @brief split the raw csv matrix into inputs and targets
+         * @param raw one sample per column; the inputs followed by the label
+         * @param in input dimension
+         * @param out number of classes
+         * @param columnwise store one sample per column
+         * @param labels keep the class labels instead of one-hot targets
+         * @param path path to file on filesystem; used in the error messages
+         * @param data training data; the return value
+         */
+
+        template<typename DATA>
+        static void assign( const dmatrix_t &raw, const size_t in, const size_t out,
+                            const bool columnwise, const bool labels,
+                            const std::string &path, DATA &data ) {
+            auto inputs = blaze::submatrix( raw, 0, 0, in, raw.columns() );
+            auto last = blaze::row( raw, in );
+
+            if( labels ) {
+                data.labels.resize( raw.columns() );
+                for( size_t i = 0; i < raw.columns(); ++i ) {
+                    if( last[i] < 0 || last[i] >= out )
+                        throw std::string{"label out of range in "} + path;
+                    data.labels[i] = (size_t) last[i];
+                }
+
+                if( columnwise ) data.icols = inputs;
+                else data.idata = blaze::trans( inputs );
+            } else if( columnwise ) {
+                data.icols = inputs;
+                data.tcols = make_one_hot<T>( blaze::trans(last), out );
+            } else {
+                data.idata = blaze::trans( inputs );
+                data.tdata = blaze::trans( make_one_hot<T>( blaze::trans(last), out ) );
+            }
+        }
+
     };
 
 }
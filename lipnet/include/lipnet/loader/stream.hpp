@@ -0,0 +1,297 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_STREAM_LOADER_HPP__
+#define __LIPNET_STREAM_LOADER_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+
+#include <lipnet/loader/binary.hpp>
+
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief The data_stream_t struct; streaming source of training data. A reader thread
+     *          fills a bounded ring of chunks while the training consumes them, hence
+     *          only capacity chunks are held in memory and the training starts with the
+     *          first chunk. Chunks never span two passes over the file; the last chunk
+     *          of a pass holds the remainder. After the last chunk the reader is rewound.
+     *
+     * @tparam T numerical value type
+     * @tparam IN input dimension
+     * @tparam OUT output dimension
+     */
+
+    template<typename T, size_t IN, size_t OUT>
+    struct data_stream_t {
+
+        typedef blaze::DynamicMatrix<T, blaze::columnMajor> cmatrix_t;
+
+        /// read up to count samples, one sample per column; returns the number of read samples
+        typedef std::function<size_t ( cmatrix_t &input, cmatrix_t &target, const size_t count )> reader_t;
+        /// restart the reader at the first sample
+        typedef std::function<void ()> rewind_t;
+
+        /// chunk of samples; one sample per column
+        struct chunk_t {
+            cmatrix_t input, target;
+            size_t valid = 0;
+            /// pass over the file this chunk belongs to
+            size_t epoch = 0;
+        };
+
+        /// samples per chunk
+        const size_t chunk;
+
+        /**
+         * @brief data_stream_t; starts the reader thread
+         * @param r reader of the samples
+         * @param w rewind of the reader
+         * @param chunksize samples per chunk
+         * @param capacity number of buffered chunks
+         */
+
+        data_stream_t( reader_t &&r, rewind_t &&w, const size_t chunksize, const size_t capacity = 4 )
+            : chunk{ chunksize }, reader{ std::move(r) }, rewind{ std::move(w) },
+              ring( std::max<size_t>( 1, capacity ) ) {
+
+            if( chunk == 0 )
+                throw std::string{"empty data stream chunk"};
+
+            producer = std::thread( [this](){ produce(); } );
+        }
+
+        data_stream_t( const data_stream_t& ) = delete;
+        data_stream_t& operator=( const data_stream_t& ) = delete;
+
+        ~data_stream_t() {
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+                stop = true;
+            }
+            space.notify_all();
+            producer.join();
+        }
+
+        /**
+         * @brief next function; take the next chunk, blocks until it has been read;
+         *          the buffers of c are handed back to the ring
+         * @param c the next chunk; the return value
+         */
+
+        void next( chunk_t &c ) {
+            std::unique_lock<std::mutex> lock( mutex );
+            filled.wait( lock, [this](){ return count > 0 || error; } );
+
+            if( count == 0 )
+                std::rethrow_exception( error );
+
+            std::swap( c, ring[head] );
+            head = ( head + 1 ) % ring.size(); count--;
+
+            lock.unlock();
+            space.notify_one();
+        }
+
+
+        /**
+         * @brief binary function; stream a file in the binary dataset format. The file is
+         *          mapped and only the pages of the consumed chunks are read.
+         * @param path path to file on filesystem
+         * @param chunksize samples per chunk
+         * @param capacity number of buffered chunks
+         */
+
+        static std::shared_ptr<data_stream_t> binary( const std::string &path, const size_t chunksize,
+                                                      const size_t capacity = 4 ) {
+            typedef binary_loader_t<T> loader_t;
+
+            auto file = std::make_shared<mapped_file_t>( path );
+            if( !file->valid() || file->size < sizeof(binary_header_t) )
+                throw std::string{"could not open binary dataset: "} + path;
+
+            const binary_header_t header = loader_t::header( *file, path );
+            if( header.inputs != IN || header.outputs != OUT )
+                throw std::string{"dimensions of binary dataset do not match: "} + path;
+
+            ::madvise( const_cast<char*>( file->data ), file->size, MADV_SEQUENTIAL );
+
+            auto position = std::make_shared<size_t>( 0 );
+
+            reader_t r = [file, header, position]( cmatrix_t &input, cmatrix_t &target, const size_t count ) {
+                const size_t n = std::min<size_t>( count, header.samples - *position );
+                if( n == 0 ) return n;
+
+                loader_t::columns( *file, header, header.ioffset, IN, *position, n, input );
+                loader_t::columns( *file, header, header.toffset, OUT, *position, n, target );
+
+                *position += n;
+                return n;
+            };
+
+            return std::make_shared<data_stream_t>( std::move(r), [position](){ *position = 0; },
+                                                    chunksize, capacity );
+        }
+
+        /**
+         * @brief csv function; stream a csv file read line by line; each row holds the
+         *          inputs followed by the label, which is converted to a one-hot target
+         *          per chunk
+         * @param path path to file on filesystem
+         * @param chunksize samples per chunk
+         * @param capacity number of buffered chunks
+         */
+
+        static std::shared_ptr<data_stream_t> csv( const std::string &path, const size_t chunksize,
+                                                   const size_t capacity = 4 ) {
+            auto is = std::make_shared<std::ifstream>( path );
+            if( !*is )
+                throw std::string{"could not open csv file: "} + path;
+
+            reader_t r = [is, path]( cmatrix_t &input, cmatrix_t &target, const size_t count ) {
+                input.resize( IN, count, false );
+                target.resize( OUT, count, false );
+                target = 0;
+
+                size_t n = 0;
+                std::string line, cell;
+
+                while( n < count && std::getline( *is, line ) ) {
+                    if( line.find_first_not_of( " \t\r" ) == std::string::npos ) continue;
+
+                    std::istringstream ls( line );
+                    size_t i = 0;
+                    for( ; i <= IN && std::getline( ls, cell, ',' ); ++i ) {
+                        const T value = std::stod( cell );
+                        if( i < IN ) { input( i, n ) = value; continue; }
+
+                        if( value < 0 || value >= OUT )
+                            throw std::string{"label out of range in "} + path;
+                        target( (size_t) value, n ) = 1;
+                    }
+
+                    if( i != IN+1 )
+                        throw std::string{"malformed row in "} + path;
+                    n++;
+                }
+
+                if( n < count ) {
+                    input.resize( IN, n, true );
+                    target.resize( OUT, n, true );
+                }
+
+                return n;
+            };
+
+            return std::make_shared<data_stream_t>( std::move(r), [is](){ is->clear(); is->seekg( 0 ); },
+                                                    chunksize, capacity );
+        }
+
+        /**
+         * @brief open function; binary stream for files ending in .bin, csv otherwise
+         * @see binary, csv
+         */
+
+        static std::shared_ptr<data_stream_t> open( const std::string &path, const size_t chunksize,
+                                                    const size_t capacity = 4 ) {
+            if( path.size() > 4 && path.substr( path.size()-4 ) == ".bin" )
+                return binary( path, chunksize, capacity );
+            return csv( path, chunksize, capacity );
+        }
+
+    private:
+
+        /// fill the ring until stopped; a chunk is read outside the lock into a free slot
+        void produce() {
+            size_t epoch = 0, read = 0, tail = 0;
+
+            try {
+                while( true ) {
+                    {
+                        std::unique_lock<std::mutex> lock( mutex );
+                        space.wait( lock, [this](){ return count < ring.size() || stop; } );
+                        if( stop ) return;
+                    }
+
+                    chunk_t &c = ring[tail];
+                    c.valid = reader( c.input, c.target, chunk );
+                    c.epoch = epoch;
+
+                    if( c.valid == 0 ) {
+                        if( read == 0 )
+                            throw std::string{"empty data stream"};
+                        rewind(); epoch++; read = 0;
+                        continue;
+                    }
+
+                    read += c.valid;
+                    tail = ( tail + 1 ) % ring.size();
+
+                    {
+                        std::lock_guard<std::mutex> lock( mutex );
+                        count++;
+                    }
+                    filled.notify_one();
+                }
+            } catch( ... ) {
+                {
+                    std::lock_guard<std::mutex> lock( mutex );
+                    error = std::current_exception();
+                }
+                filled.notify_all();
+            }
+        }
+
+        reader_t reader;
+        rewind_t rewind;
+
+        std::vector<chunk_t> ring;
+        size_t head = 0, count = 0;
+        bool stop = false;
+        std::exception_ptr error;
+
+        std::mutex mutex;
+        std::condition_variable filled, space;
+
+        /// declared last so it is started after and joined before the other members go away
+        std::thread producer;
+    };
+
+}
+
+#endif // __LIPNET_STREAM_LOADER_HPP__
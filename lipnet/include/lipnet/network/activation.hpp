@@ -28,6 +28,7 @@
 #include <utility>
 #include <initializer_list>
 #include <deque>
+#include <cmath>
 
 #include <lipnet/traits.hpp>
 #include <lipnet/tensor.hpp>
@@ -52,6 +53,9 @@ namespace lipnet {
     template<typename T, atype_t TYPE>
     struct activation_t {
 
+        /// activation type; used when the network is exported
+        static constexpr atype_t type = TYPE;
+
         template<typename TT, size_t O, size_t I>
         using matrix_t =  blaze::StaticMatrix<TT,O,I, blaze::columnMajor>;
         template<typename TT, size_t N>
@@ -110,8 +114,46 @@ namespace lipnet {
                 return  1 - blaze::pow(blaze::tanh(val), 2);
 
             if constexpr ( TYPE == atype_t::NONE)
-                return TT(1);
+                return blaze::map( val, [](const T&){ return T(1); } );
+
+        }
+
+        /**
+         * @brief fused bias add, activation and derivative; one pass over the batch
+         *                  @f[ z \leftarrow z + b \quad x = \sigma(z) \quad d = \sigma'(z) @f]
+         * @param z layer output without bias; the bias is added in place
+         * @param bias bias vector
+         * @param out activation output; the return value
+         * @param deriv derivative of the activation at z; the return value
+         */
 
+        template<typename MT1, typename VT, typename MT2, typename MT3>
+        static inline void forward_fused( MT1 &z, const VT &bias, MT2 &out, MT3 &deriv ) {
+            const size_t rows = z.rows(), cols = z.columns();
+            blaze::resize( out, rows, cols, false );
+            blaze::resize( deriv, rows, cols, false );
+
+            for( size_t i = 0; i < rows; i++ ) {
+                const T b = bias[i];
+
+                for( size_t j = 0; j < cols; j++ ) {
+                    const T v = z(i,j) + b; z(i,j) = v;
+
+                    if constexpr ( TYPE == atype_t::SIGMOID) {
+                        const T sig = T(1) / ( T(1) + std::exp( -v ) );
+                        out(i,j) = sig; deriv(i,j) = sig * ( T(1) - sig );
+                    }
+
+                    if constexpr ( TYPE == atype_t::TANH) {
+                        const T th = std::tanh( v );
+                        out(i,j) = th; deriv(i,j) = T(1) - th * th;
+                    }
+
+                    if constexpr ( TYPE == atype_t::NONE) {
+                        out(i,j) = v; deriv(i,j) = T(1);
+                    }
+                }
+            }
         }
 
     };
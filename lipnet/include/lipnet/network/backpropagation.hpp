@@ -30,32 +30,50 @@
 #include <deque>
 
 #include <lipnet/traits.hpp>
+#include <lipnet/profile.hpp>
 #include <lipnet/tensor.hpp>
 #include <lipnet/tuple.hpp>
 #include <lipnet/variable.hpp>
+#include <lipnet/parallel.hpp>
+#include <lipnet/distributed.hpp>
 
+#include <lipnet/network/data.hpp>
 #include <lipnet/network/layer.hpp>
+#include <lipnet/network/sampler.hpp>
 #include <lipnet/network/loss.hpp>
 #include <lipnet/network/topology.hpp>
 #include <lipnet/network/network.hpp>
 #include <lipnet/network/activation.hpp>
 
+#include <lipnet/loader/stream.hpp>
+
 
 
 
 namespace lipnet {
 
     /**
-     * @brief The network_data_t struct; training dataset
-     * @tparam T numerical value type
-     * @tparam IN input dimension
-     * @tparam OUT output dimension
+     * @brief batch size value to select the runtime sized batch implementation
+     *        of backpropagation_batch_t
      */
 
-    template<typename T, size_t IN, size_t OUT>
-    struct network_data_t {
-        blaze::DynamicMatrix<T, blaze::rowMajor> idata, tdata;
-    };
+    inline constexpr size_t dynamic_batch = 0;
+
+
+    /**
+     * @brief numerical type of the forward and backward pass; with LIPNET_MIXED_PRECISION
+     *        double precision problems propagate in single precision while the
+     *        weights, the gradients and everything outside the backpropagation stay double
+     * @tparam T numerical type of the problem
+     */
+
+    template<typename T>
+    struct compute_type { typedef T type; };
+
+#ifdef LIPNET_MIXED_PRECISION
+    template<>
+    struct compute_type<double> { typedef float type; };
+#endif
 
 
     /**
@@ -71,12 +89,13 @@ namespace lipnet {
              template<typename> typename LOSS, size_t BATCH, size_t ...N>
     struct backpropagation_batch_t {
 
+        typedef typename compute_type<T>::type C;
 
         template<size_t NN>
-        using vector_t = blaze::StaticVector<T, NN, blaze::columnVector>;
+        using vector_t = blaze::StaticVector<C, NN, blaze::columnVector>;
 
         template<size_t NN1, size_t NN2>
-        using matrix_t = blaze::StaticMatrix<T, NN1, NN2, blaze::rowMajor>;
+        using matrix_t = blaze::StaticMatrix<C, NN1, NN2, blaze::rowMajor>;
 
         typedef std::integral_constant<size_t, sizeof... (N)-1> L;
         typedef std::integral_constant<size_t, (N + ... )> NL;
@@ -84,27 +103,145 @@ namespace lipnet {
 
 
         typedef typename network_t<T,ATYPE, N...>::layer_t variable_t;
+        typedef typename network_t<C,ATYPE, N...>::layer_t cvariable_t;
+
+        typedef typename generate_batch_data_remove_first<C, BATCH, N...>::type zdata_t;
+        typedef typename generate_batch_data<C, BATCH, N...>::type xdata_t;
 
-        typedef typename generate_batch_data_remove_first<T, BATCH, N...>::type zdata_t;
-        typedef typename generate_batch_data<T, BATCH, N...>::type xdata_t;
+        typedef data_stream_t<C, at<0,N...>(), at<L::value,N...>()> stream_t;
+
+        /// gathered batch of samples; one sample per column
+        struct batch_t {
+            matrix_t<at<0, N...>(), BATCH> input;
+            matrix_t<at<L::value, N...>(), BATCH> target;
+            /// class labels; used instead of target if the data is labeled
+            std::vector<size_t> labels;
+            size_t valid = 0;
+        };
+
+        /// activation buffers and sampler state
+        struct workspace_t {
+            xdata_t x; zdata_t z, delta;
+            /// activation derivatives of the hidden layers; the last entry is not used
+            zdata_t deriv;
+            cvariable_t params;
+
+            std::unique_ptr<batch_sampler_t> sampler;
+            std::vector<size_t> indices;
+            std::array<batch_t, 2> batches; size_t current = 0;
+            /// last chunk taken from the stream
+            typename stream_t::chunk_t chunk;
+
+            /// the other batch holds the prefetched next batch
+            bool ready = false;
+
+            /// persistent thread gathering the next batch; created by the first
+            /// prefetch, declared last so it is joined first
+            std::unique_ptr<worker_t> worker;
+
+            /// finish an outstanding prefetch
+            void settle() {
+                if( worker && worker->pending() ) { worker->wait(); ready = true; }
+            }
+        };
 
         struct metainfo_t {
-             size_t iter; metainfo_t() : iter{0} {}
+             size_t iter; std::unique_ptr<workspace_t> workspace;
+             metainfo_t() : iter{0}, workspace{ std::make_unique<workspace_t>() } {}
+
+             /// iteration count and sampler position of the next batch; a prefetched
+             /// batch is not stored, the sampler is rewound and draws it again on
+             /// resume. The position of a data stream is not stored.
+             /// @cite cereallib
+             template<class Archive> void save( Archive & archive ) const {
+                 workspace->settle();
+                 const bool sampled = bool( workspace->sampler );
+                 archive( iter, sampled );
+                 if( !sampled ) return;
+
+                 batch_sampler_t sampler = *workspace->sampler;
+                 if( workspace->ready ) sampler.rewind();
+                 archive( sampler );
+             }
+
+             /// @see save
+             template<class Archive> void load( Archive & archive ) {
+                 bool sampled = false;
+                 archive( iter, sampled );
+
+                 workspace->settle(); workspace->ready = false;
+                 workspace->sampler.reset();
+                 if( sampled ) {
+                     workspace->sampler = std::make_unique<batch_sampler_t>( 1, 1 );
+                     archive( *workspace->sampler );
+                 }
+             }
         };
 
-        network_data_t<T, at<0,N...>(), at<L::value,N...>() > training_data;
-        LOSS<T> loss;
+        /// read-only training data; shared with other problems if constructed from shared_data_t
+        shared_data_t<C, at<0,N...>(), at<L::value,N...>() > training_data;
+        LOSS<C> loss;
+
+        /// streaming source of the batches; replaces training_data in run if set
+        std::shared_ptr<stream_t> stream;
+
+        /// number of threads used in compute
+        size_t threads = default_threads();
+
+        /// ranks of a data parallel run, each with its own shard of the data; empty for local training
+        std::shared_ptr<const communicator_t> comm = default_communicator();
 
-        explicit backpropagation_batch_t( LOSS<T>&& l, network_data_t<T, at<0,N...>(), at<L::value,N...>() > &&data )
-            : training_data{ std::move(data) }, loss{ std::move(l) }  {
+        /// run uses the whole dataset instead of the next batch; deterministic
+        /// gradients, e.g. for lbfgs_t (default = false)
+        bool full_batch = false;
 
-            if(  training_data.idata.rows() % BATCH != 0)
-                throw std::string{"size not matching"};
+        /// shuffle the samples in every epoch
+        bool shuffle = true;
+        /// gather the next batch on a background thread
+        bool prefetch = true;
+        /// seed of the shuffling
+        size_t seed = 0;
 
+        explicit backpropagation_batch_t( LOSS<T>&& l, shared_data_t<T, at<0,N...>(), at<L::value,N...>() > data )
+            : training_data{ precision_cast<C>( data ) }, loss{ loss_cast( std::move(l) ) }  {
+
+            if( !training_data || training_data->samples() == 0 )
+                throw std::string{"empty training data"};
+
+            if( training_data->labeled() && !supports_labels<LOSS>::value )
+                throw std::string{"loss does not support label targets"};
         }
 
         /**
-         * @brief run function; compute backpropagation
+         * @brief backpropagation_batch_t; batches are pulled from a data stream in order,
+         *          training_data stays empty and only run is available
+         * @param l loss
+         * @param source data stream; the chunk size has to match the batch size
+         */
+
+        backpropagation_batch_t( LOSS<T>&& l, std::shared_ptr<stream_t> source )
+            : training_data{ std::make_shared<const network_data_t<C, at<0,N...>(), at<L::value,N...>() >>() },
+              loss{ loss_cast( std::move(l) ) }, stream{ std::move(source) } {
+
+            if( !stream )
+                throw std::string{"empty data stream"};
+            if( stream->chunk != BATCH )
+                throw std::string{"chunk size of the data stream differs from the batch size"};
+        }
+
+        /// loss in the numerical type of the propagation; the losses are stateless
+        static inline LOSS<C> loss_cast( LOSS<T> &&l ) {
+            if constexpr ( std::is_same<C, T>::value ) return std::move(l);
+            else return LOSS<C>{};
+        }
+
+        /// number of batches; the last batch holds the remainder
+        inline size_t batches() const {
+            return ( training_data->samples() + BATCH - 1 ) / BATCH;
+        }
+
+        /**
+         * @brief run function; compute backpropagation of the next batch of the sampler
          * @param var current position
          * @param info optimisation metainfo which are needed during the iterations
          * @param gradient the computed gradients; the return value
@@ -113,83 +250,267 @@ namespace lipnet {
          */
 
         void run( const variable_t& var, metainfo_t &info, variable_t& gradient, T& objective ) const {
-            xdata_t xvec; zdata_t zvec; zdata_t deltavec;
+            workspace_t &ws = *info.workspace; info.iter++;
+
+            // mean of the batch losses and gradients over the whole dataset (of all ranks)
+            if( full_batch ) {
+                T count = T( batches() );
+                if( comm ) comm->allreduce( &count, 1 );
+
+                variable_t g; T f = 0;
+                std::for_range<0,L::value>([&]<auto I>(){
+                    std::get<I>(g).weight = 0;
+                    std::get<I>(g).bias = 0;
+                });
+
+                compute( var, g, f );
+                gradient += ( T(1) / count ) * g;
+                objective += f / count;
+                return;
+            }
 
-            size_t i = (info.iter++) % (training_data.idata.rows() / BATCH);
+            ws.settle();
+            if( ws.ready ) {
+                ws.ready = false; ws.current = 1 - ws.current;
+            } else {
+                sample( ws, ws.batches[ws.current] );
+            }
 
-            std::get<0>( xvec ) = blaze::trans( blaze::rows( training_data.idata,
-                            [&i](size_t j){ return i*BATCH+j; }, BATCH ) );
+            if( prefetch ) {
+                if( !ws.worker ) ws.worker = std::make_unique<worker_t>();
+                ws.worker->post( [this, &ws]() { sample( ws, ws.batches[1 - ws.current] ); } );
+            }
 
-            matrix_t<at<L::value, N...>(), BATCH> target =
-                    blaze::trans( blaze::rows( training_data.tdata,
-                            [&i](size_t j){ return i*BATCH+j; }, BATCH ) );
+            const batch_t &b = ws.batches[ws.current];
+            step( var, b, ws, gradient, objective );
 
-            forward( var, xvec, zvec );
+            // gradient and objective hold the local batch only, the callers pass zeros
+            if( comm ) comm->average( gradient, objective );
+        }
 
-            std::get<L::value-1>(deltavec) = loss.template gradient<at<L::value, N...>(),BATCH>(
-                        target, std::get<L::value-1>(zvec) );
+        /**
+         * @brief compute function; compute backpropagation over the whole dataset;
+         *          the batches are split over threads with one accumulator each
+         * @param var current position
+         * @param gradient the computed gradients; the return value
+         * @param objective the loss at the current position
+         */
+
+        void compute( const variable_t& var, variable_t& gradient, T& objective ) const {
+            if( stream )
+                throw std::string{"compute requires in-memory training data"};
+
+            const size_t B = batches();
+            std::vector<variable_t> gradients( std::max<size_t>( 1, std::min( threads, B ) ) );
+            std::vector<T> objectives( gradients.size(), 0 );
+
+            for( auto &g : gradients )
+                std::for_range<0,L::value>([&]<auto I>(){
+                    std::get<I>(g).weight = 0;
+                    std::get<I>(g).bias = 0;
+                });
+
+            parallel_for( B, gradients.size(), [&]( const size_t p, const size_t begin, const size_t end ) {
+                auto workspace = std::make_unique<workspace_t>();
+                for( size_t i = begin; i < end ; i++) {
+                    const size_t valid = std::min( BATCH, training_data->samples() - i*BATCH );
+
+                    if( valid == BATCH ) {
+                        auto input = blaze::submatrix( training_data->icols, 0UL, i*BATCH, at<0, N...>(), BATCH );
+
+                        if( training_data->labeled() ) {
+                            auto &labels = workspace->batches[0].labels;
+                            labels.assign( training_data->labels.begin() + i*BATCH,
+                                           training_data->labels.begin() + (i+1)*BATCH );
+                            step( var, input, labels, valid, *workspace, gradients[p], objectives[p] );
+                        } else {
+                            step( var, input, blaze::submatrix( training_data->tcols, 0UL, i*BATCH, at<L::value, N...>(), BATCH ),
+                                  valid, *workspace, gradients[p], objectives[p] );
+                        }
+                    } else {
+                        auto &indices = workspace->indices;
+                        indices.resize( BATCH );
+                        for( size_t j = 0; j < BATCH; j++ )
+                            indices[j] = i*BATCH + ( j < valid ? j : 0 );
+
+                        batch_t &b = workspace->batches[0];
+                        gather( indices, valid, b );
+                        step( var, b, *workspace, gradients[p], objectives[p] );
+                    }
+                }
+            });
+
+            tree_reduce( gradients, []( variable_t &a, const variable_t &b ) { a += b; } );
+            tree_reduce( objectives, []( T &a, const T &b ) { a += b; } );
+
+            // sum over the batches of all shards
+            if( comm ) comm->sum( gradients[0], objectives[0] );
 
-            backward( var, gradient, xvec, deltavec, zvec );
+            gradient += gradients[0];
+            objective += objectives[0];
+        }
+
+        /**
+         * @brief sample function; draw the next batch from the sampler and gather it,
+         *          or take the next chunk of the stream
+         * @param ws workspace holding the sampler
+         * @param b the gathered batch; the return value
+         */
+
+        void sample( workspace_t &ws, batch_t &b ) const {
+            if( stream ) {
+                stream->next( ws.chunk );
+
+                const size_t valid = ws.chunk.valid;
+                ws.indices.resize( BATCH );
+                for( size_t j = 0; j < BATCH; j++ )
+                    ws.indices[j] = ( j < valid ? j : 0 );
+
+                b.input = blaze::columns( ws.chunk.input, ws.indices.data(), BATCH );
+                b.target = blaze::columns( ws.chunk.target, ws.indices.data(), BATCH );
+                b.valid = valid;
+                return;
+            }
 
-            objective += loss.template evaluate<at<L::value, N...>(),BATCH>(
-                        target, std::get<L::value-1>(zvec) ) / BATCH;
+            if( !ws.sampler )
+                ws.sampler = std::make_unique<batch_sampler_t>( training_data->samples(), BATCH, shuffle, seed );
 
+            const size_t valid = ws.sampler->next( ws.indices, true );
+            gather( ws.indices, valid, b );
         }
 
         /**
-         * @brief run function; compute backpropagation
+         * @brief gather function; copy the samples into a batch
+         * @param indices sample indices; exactly BATCH entries
+         * @param valid number of valid entries; the others are padding
+         * @param b the gathered batch; the return value
+         */
+
+        void gather( const std::vector<size_t> &indices, const size_t valid, batch_t &b ) const {
+            b.input = blaze::columns( training_data->icols, indices.data(), indices.size() );
+
+            if( training_data->labeled() ) {
+                b.labels.resize( indices.size() );
+                for( size_t j = 0; j < indices.size(); j++ )
+                    b.labels[j] = training_data->labels[indices[j]];
+            } else {
+                b.target = blaze::columns( training_data->tcols, indices.data(), indices.size() );
+            }
+
+            b.valid = valid;
+        }
+
+        /**
+         * @brief propagation_weights function; weights in the numerical type of the propagation
          * @param var current position
-         * @param info optimisation metainfo which are needed during the iterations
+         * @param ws workspace holding the converted copy
+         * @return var itself or the converted copy
+         */
+
+        inline const cvariable_t& propagation_weights( const variable_t& var, workspace_t &ws ) const {
+            if constexpr ( std::is_same<C, T>::value ) {
+                return var;
+            } else {
+                std::for_range<0,L::value>([&]<auto I>(){
+                    std::get<I>(ws.params).weight = std::get<I>(var).weight;
+                    std::get<I>(ws.params).bias = std::get<I>(var).bias;
+                });
+                return ws.params;
+            }
+        }
+
+        /**
+         * @brief step function; compute backpropagation of a gathered batch
+         * @param var current position
+         * @param b the gathered batch; the labels are used if the data is labeled
+         * @param ws activation buffers
          * @param gradient the computed gradients; the return value
          * @param objective the loss at the current position
          */
 
-        void compute( const variable_t& var, variable_t& gradient, T& objective ) const {
-            xdata_t xvec; zdata_t zvec; zdata_t deltavec;
+        void step( const variable_t& var, const batch_t &b, workspace_t &ws,
+                   variable_t& gradient, T& objective ) const {
+            if( training_data->labeled() )
+                step( var, b.input, b.labels, b.valid, ws, gradient, objective );
+            else
+                step( var, b.input, b.target, b.valid, ws, gradient, objective );
+        }
 
-            for( int i = 0; i < training_data.idata.rows() / BATCH ; i++) {
-                std::get<0>( xvec ) = blaze::trans( blaze::rows( training_data.idata, [&i](size_t j){ return i*BATCH+j; }, BATCH ) );
+        /**
+         * @brief step function; compute backpropagation of a single batch
+         * @param var current position
+         * @param input the input batch
+         * @param target the target batch or the class labels of the batch
+         * @param valid number of valid samples; the others are padding and masked
+         * @param ws activation buffers
+         * @param gradient the computed gradients; the return value
+         * @param objective the loss at the current position
+         */
 
-                matrix_t<at<L::value, N...>(), BATCH> target =
-                        blaze::trans( blaze::rows( training_data.tdata, [&i](size_t j){ return i*BATCH+j; }, BATCH ) );
+        template<typename INPUT, typename TARGET>
+        void step( const variable_t& var, const INPUT &input, const TARGET &target, const size_t valid,
+                   workspace_t &ws, variable_t& gradient, T& objective ) const {
 
-                forward( var, xvec, zvec );
+            const cvariable_t &params = propagation_weights( var, ws );
 
-                std::get<L::value-1>(deltavec) = loss.template gradient<at<L::value, N...>(),BATCH>(
-                          target, std::get<L::value-1>(zvec) );
+            forward( params, input, ws.x, ws.z, ws.deriv );
 
-                backward( var, gradient, xvec, deltavec, zvec );
+            auto &output = std::get<L::value-1>(ws.z);
+            auto &delta = std::get<L::value-1>(ws.delta);
 
-                objective += loss.template evaluate<at<L::value, N...>(),BATCH>(
-                            target, std::get<L::value-1>(zvec) ) / BATCH;
+            // label targets are only reachable with a label loss, the constructor rejects the others
+            if constexpr ( !std::is_same<TARGET, std::vector<size_t>>::value || supports_labels<LOSS>::value )
+                objective += loss.fused( target, output, delta, valid ) / valid;
+
+            if( valid != BATCH ) {
+                // mask the padding and rescale, backward divides by BATCH
+                blaze::submatrix( delta, 0UL, valid, at<L::value, N...>(), BATCH-valid ) = 0;
+                delta *= C(BATCH) / valid;
             }
 
+            backward( params, gradient, input, ws.x, ws.delta, ws.deriv );
         }
 
 
 
+        /**
+         * @brief layer_input function; input of layer I
+         * @param input view of the input batch
+         * @param x layer inputs
+         * @return the input view for the first layer, the layer input otherwise
+         */
+
+        template<size_t I, typename INPUT>
+        static inline decltype(auto) layer_input( const INPUT &input, const xdata_t &x ) {
+            if constexpr ( I == 0 ) return ( input );
+            else return ( std::get<I>(x) );
+        }
+
         /**
          * @brief forward function; compute forwardpropagation
          * @param layers weights and biases at each layer
-         * @param x
+         * @param input view of the input batch
+         * @param x layer inputs; the first entry is not used, the input view is read instead
          * @param z
+         * @param deriv activation derivatives; the return value
          */
 
-        void forward( const variable_t &layers, xdata_t &x, zdata_t &z) const {
+        template<typename INPUT>
+        void forward( const cvariable_t &layers, const INPUT &input, xdata_t &x, zdata_t &z, zdata_t &deriv ) const {
+            [[maybe_unused]] scoped_timer_t<phase_t::FORWARD> timer;
 
             std::for_range<0,L::value-1>([&]<auto I>(){
                 auto& layer = std::get<I>(layers);
 
-                std::get<I>(z) =  layer.weight * std::get<I>(x) + blaze::expand<BATCH>(layer.bias);
-                std::get<I+1>(x) = ATYPE<T>::template forward<at<I+1,N...>(),BATCH>(
-                                        std::get<I>(z) );
-
+                std::get<I>(z) =  layer.weight * layer_input<I>( input, x );
+                ATYPE<C>::forward_fused( std::get<I>(z), layer.bias,
+                                         std::get<I+1>(x), std::get<I>(deriv) );
 
             });
 
             auto& layer = std::get<L::value-1>(layers);
             std::get<L::value-1>(z) = layer.weight *
-                    std::get<L::value-1>(x) + blaze::expand<BATCH>( layer.bias );
+                    layer_input<L::value-1>( input, x ) + blaze::expand<BATCH>( layer.bias );
 
         }
 
@@ -197,13 +518,16 @@ namespace lipnet {
          * @brief backward function; compute backpropagation
          * @param layers weights and biases at each layer
          * @param gradient gradient with respect to the weights and biases
-         * @param x
+         * @param input view of the input batch
+         * @param x layer inputs; the first entry is not used
          * @param delta gradients with respect to the layer inputs
-         * @param z
+         * @param deriv activation derivatives computed in the forward pass
          */
 
-          void backward( const variable_t &layers, variable_t &gradient,
-                         xdata_t &x, zdata_t &delta, zdata_t &z) const {
+          template<typename INPUT>
+          void backward( const cvariable_t &layers, variable_t &gradient, const INPUT &input,
+                         xdata_t &x, zdata_t &delta, zdata_t &deriv ) const {
+              [[maybe_unused]] scoped_timer_t<phase_t::BACKWARD> timer;
 
               std::for_range<0,L::value-1>([&]<auto I>(){
 
@@ -216,8 +540,7 @@ namespace lipnet {
                   auto tmp1 = blaze::trans( std::get<L::value-I-1>(delta) )
                                            * std::get<L::value-I-1>(layers).weight;
 
-                  auto tmp2 = blaze::trans( ATYPE<T>::template
-                            derivative<at<L::value-I-2,N...>(),BATCH>(  std::get<L::value-I-2>(z) ));
+                  auto tmp2 = blaze::trans( std::get<L::value-I-2>(deriv) );
 
                   std::get<L::value-I-2>(delta) = blaze::trans( tmp1 % tmp2 );
 
@@ -227,7 +550,466 @@ namespace lipnet {
 
               auto &grad = std::get<0>(gradient);
               grad.bias += blaze::reduce<blaze::rowwise>(std::get<0>(delta), blaze::Add()) / BATCH;
-              grad.weight +=  std::get<0>(delta) *  blaze::trans( std::get<0>(x) ) / BATCH;
+              grad.weight +=  std::get<0>(delta) *  blaze::trans( input ) / BATCH;
+
+
+          }
+
+
+    };
+
+
+
+
+
+
+    /**
+     * @brief The backpropagation_batch_t struct; implmentation of backtracking with batches
+     *        of runtime size; all activations are heap allocated and kept in the metainfo
+     *        so they are reused over the iterations
+     * @tparam T numerical type
+     * @tparam ATYPE activation function type
+     * @tparam LOSS loss function type
+     * @tparam N network topology
+     */
+
+    template<typename T, template<typename> typename ATYPE,
+             template<typename> typename LOSS, size_t ...N>
+    struct backpropagation_batch_t<T, ATYPE, LOSS, dynamic_batch, N...> {
+
+
+        typedef typename compute_type<T>::type C;
+        typedef blaze::DynamicMatrix<C, blaze::rowMajor> dmatrix_t;
+
+        typedef std::integral_constant<size_t, sizeof... (N)-1> L;
+        typedef std::integral_constant<size_t, (N + ... )> NL;
+        typedef std::integer_sequence<size_t, N...> DIMS;
+
+
+        typedef typename network_t<T,ATYPE, N...>::layer_t variable_t;
+        typedef typename network_t<C,ATYPE, N...>::layer_t cvariable_t;
+
+        typedef typename generate_dynamic_batch_data_remove_first<C, N...>::type zdata_t;
+        typedef typename generate_dynamic_batch_data<C, N...>::type xdata_t;
+
+        typedef data_stream_t<C, at<0,N...>(), at<L::value,N...>()> stream_t;
+
+        /// gathered batch of samples; one sample per column
+        struct batch_t {
+            dmatrix_t input, target;
+            /// class labels; used instead of target if the data is labeled
+            std::vector<size_t> labels;
+            size_t valid = 0;
+        };
+
+        /// activation buffers and sampler state
+        struct workspace_t {
+            xdata_t x; zdata_t z, delta;
+            /// activation derivatives of the hidden layers; the last entry is not used
+            zdata_t deriv;
+            cvariable_t params;
+
+            std::unique_ptr<batch_sampler_t> sampler;
+            std::vector<size_t> indices;
+            std::array<batch_t, 2> batches; size_t current = 0;
+            /// last chunk taken from the stream
+            typename stream_t::chunk_t chunk;
+
+            /// the other batch holds the prefetched next batch
+            bool ready = false;
+
+            /// persistent thread gathering the next batch; created by the first
+            /// prefetch, declared last so it is joined first
+            std::unique_ptr<worker_t> worker;
+
+            /// finish an outstanding prefetch
+            void settle() {
+                if( worker && worker->pending() ) { worker->wait(); ready = true; }
+            }
+        };
+
+        struct metainfo_t {
+             size_t iter; std::unique_ptr<workspace_t> workspace;
+             metainfo_t() : iter{0}, workspace{ std::make_unique<workspace_t>() } {}
+
+             /// iteration count and sampler position of the next batch; a prefetched
+             /// batch is not stored, the sampler is rewound and draws it again on
+             /// resume. The position of a data stream is not stored.
+             /// @cite cereallib
+             template<class Archive> void save( Archive & archive ) const {
+                 workspace->settle();
+                 const bool sampled = bool( workspace->sampler );
+                 archive( iter, sampled );
+                 if( !sampled ) return;
+
+                 batch_sampler_t sampler = *workspace->sampler;
+                 if( workspace->ready ) sampler.rewind();
+                 archive( sampler );
+             }
+
+             /// @see save
+             template<class Archive> void load( Archive & archive ) {
+                 bool sampled = false;
+                 archive( iter, sampled );
+
+                 workspace->settle(); workspace->ready = false;
+                 workspace->sampler.reset();
+                 if( sampled ) {
+                     workspace->sampler = std::make_unique<batch_sampler_t>( 1, 1 );
+                     archive( *workspace->sampler );
+                 }
+             }
+        };
+
+        /// read-only training data; shared with other problems if constructed from shared_data_t
+        shared_data_t<C, at<0,N...>(), at<L::value,N...>() > training_data;
+        LOSS<C> loss;
+
+        /// streaming source of the batches; replaces training_data in run if set
+        std::shared_ptr<stream_t> stream;
+
+        /// number of threads used in compute
+        size_t threads = default_threads();
+
+        /// ranks of a data parallel run, each with its own shard of the data; empty for local training
+        std::shared_ptr<const communicator_t> comm = default_communicator();
+
+        /// batch size; zero means the whole dataset
+        size_t batch;
+
+        /// run uses the whole dataset instead of the next batch; deterministic
+        /// gradients, e.g. for lbfgs_t (default = false)
+        bool full_batch = false;
+
+        /// shuffle the samples in every epoch
+        bool shuffle = true;
+        /// gather the next batch on a background thread
+        bool prefetch = true;
+        /// seed of the shuffling
+        size_t seed = 0;
+
+        explicit backpropagation_batch_t( LOSS<T>&& l, shared_data_t<T, at<0,N...>(), at<L::value,N...>() > data,
+                                          const size_t batchsize = 0 )
+            : training_data{ precision_cast<C>( data ) }, loss{ loss_cast( std::move(l) ) }, batch{ batchsize } {
+
+            if( !training_data || training_data->samples() == 0 )
+                throw std::string{"empty training data"};
+
+            if( training_data->labeled() && !supports_labels<LOSS>::value )
+                throw std::string{"loss does not support label targets"};
+
+        }
+
+        /**
+         * @brief backpropagation_batch_t; batches are pulled from a data stream in order,
+         *          training_data stays empty and only run is available
+         * @param l loss
+         * @param source data stream; the chunk size is the batch size
+         */
+
+        backpropagation_batch_t( LOSS<T>&& l, std::shared_ptr<stream_t> source )
+            : training_data{ std::make_shared<const network_data_t<C, at<0,N...>(), at<L::value,N...>() >>() },
+              loss{ loss_cast( std::move(l) ) }, stream{ std::move(source) } {
+
+            if( !stream )
+                throw std::string{"empty data stream"};
+            batch = stream->chunk;
+        }
+
+        /// number of samples per batch
+        inline size_t batchsize() const {
+            if( stream ) return stream->chunk;
+            return ( batch == 0 ) ? training_data->samples()
+                                  : std::min( batch, training_data->samples() );
+        }
+
+        /// loss in the numerical type of the propagation; the losses are stateless
+        static inline LOSS<C> loss_cast( LOSS<T> &&l ) {
+            if constexpr ( std::is_same<C, T>::value ) return std::move(l);
+            else return LOSS<C>{};
+        }
+
+        /// number of batches; the last batch holds the remainder
+        inline size_t batches() const {
+            return ( training_data->samples() + batchsize() - 1 ) / batchsize();
+        }
+
+        /**
+         * @brief run function; compute backpropagation of the next batch of the sampler
+         * @param var current position
+         * @param info optimisation metainfo which are needed during the iterations
+         * @param gradient the computed gradients; the return value
+         * @param objective the loss at the current position
+         * @see compute( const variable_t& var, variable_t& gradient, T& objective ) const
+         */
+
+        void run( const variable_t& var, metainfo_t &info, variable_t& gradient, T& objective ) const {
+            workspace_t &ws = *info.workspace; info.iter++;
+
+            // mean of the batch losses and gradients over the whole dataset (of all ranks)
+            if( full_batch ) {
+                T count = T( batches() );
+                if( comm ) comm->allreduce( &count, 1 );
+
+                variable_t g; T f = 0;
+                std::for_range<0,L::value>([&]<auto I>(){
+                    std::get<I>(g).weight = 0;
+                    std::get<I>(g).bias = 0;
+                });
+
+                compute( var, g, f );
+                gradient += ( T(1) / count ) * g;
+                objective += f / count;
+                return;
+            }
+
+            ws.settle();
+            if( ws.ready ) {
+                ws.ready = false; ws.current = 1 - ws.current;
+            } else {
+                sample( ws, ws.batches[ws.current] );
+            }
+
+            if( prefetch ) {
+                if( !ws.worker ) ws.worker = std::make_unique<worker_t>();
+                ws.worker->post( [this, &ws]() { sample( ws, ws.batches[1 - ws.current] ); } );
+            }
+
+            const batch_t &b = ws.batches[ws.current];
+            step( var, b, ws, gradient, objective );
+
+            // gradient and objective hold the local batch only, the callers pass zeros
+            if( comm ) comm->average( gradient, objective );
+        }
+
+        /**
+         * @brief compute function; compute backpropagation over the whole dataset;
+         *          the batches are split over threads with one accumulator each
+         * @param var current position
+         * @param gradient the computed gradients; the return value
+         * @param objective the loss at the current position
+         */
+
+        void compute( const variable_t& var, variable_t& gradient, T& objective ) const {
+            if( stream )
+                throw std::string{"compute requires in-memory training data"};
+
+            const size_t B = batches();
+            std::vector<variable_t> gradients( std::max<size_t>( 1, std::min( threads, B ) ) );
+            std::vector<T> objectives( gradients.size(), 0 );
+
+            for( auto &g : gradients )
+                std::for_range<0,L::value>([&]<auto I>(){
+                    std::get<I>(g).weight = 0;
+                    std::get<I>(g).bias = 0;
+                });
+
+            parallel_for( B, gradients.size(), [&]( const size_t p, const size_t begin, const size_t end ) {
+                auto workspace = std::make_unique<workspace_t>();
+                for( size_t i = begin; i < end ; i++) {
+                    const size_t first = i*batchsize();
+                    const size_t size = std::min( batchsize(), training_data->samples() - first );
+
+                    auto input = blaze::submatrix( training_data->icols, 0UL, first, at<0, N...>(), size );
+
+                    if( training_data->labeled() ) {
+                        auto &labels = workspace->batches[0].labels;
+                        labels.assign( training_data->labels.begin() + first,
+                                       training_data->labels.begin() + first + size );
+                        step( var, input, labels, *workspace, gradients[p], objectives[p] );
+                    } else {
+                        step( var, input, blaze::submatrix( training_data->tcols, 0UL, first, at<L::value, N...>(), size ),
+                              *workspace, gradients[p], objectives[p] );
+                    }
+                }
+            });
+
+            tree_reduce( gradients, []( variable_t &a, const variable_t &b ) { a += b; } );
+            tree_reduce( objectives, []( T &a, const T &b ) { a += b; } );
+
+            // sum over the batches of all shards
+            if( comm ) comm->sum( gradients[0], objectives[0] );
+
+            gradient += gradients[0];
+            objective += objectives[0];
+        }
+
+        /**
+         * @brief sample function; draw the next batch from the sampler and gather it,
+         *          or take the next chunk of the stream
+         * @param ws workspace holding the sampler
+         * @param b the gathered batch; the return value
+         */
+
+        void sample( workspace_t &ws, batch_t &b ) const {
+            if( stream ) {
+                stream->next( ws.chunk );
+                b.input = ws.chunk.input;
+                b.target = ws.chunk.target;
+                b.valid = ws.chunk.valid;
+                return;
+            }
+
+            if( !ws.sampler )
+                ws.sampler = std::make_unique<batch_sampler_t>( training_data->samples(), batchsize(), shuffle, seed );
+
+            b.valid = ws.sampler->next( ws.indices, false );
+            b.input = blaze::columns( training_data->icols, ws.indices.data(), ws.indices.size() );
+
+            if( training_data->labeled() ) {
+                b.labels.resize( ws.indices.size() );
+                for( size_t j = 0; j < ws.indices.size(); j++ )
+                    b.labels[j] = training_data->labels[ws.indices[j]];
+            } else {
+                b.target = blaze::columns( training_data->tcols, ws.indices.data(), ws.indices.size() );
+            }
+        }
+
+        /**
+         * @brief propagation_weights function; weights in the numerical type of the propagation
+         * @param var current position
+         * @param ws workspace holding the converted copy
+         * @return var itself or the converted copy
+         */
+
+        inline const cvariable_t& propagation_weights( const variable_t& var, workspace_t &ws ) const {
+            if constexpr ( std::is_same<C, T>::value ) {
+                return var;
+            } else {
+                std::for_range<0,L::value>([&]<auto I>(){
+                    std::get<I>(ws.params).weight = std::get<I>(var).weight;
+                    std::get<I>(ws.params).bias = std::get<I>(var).bias;
+                });
+                return ws.params;
+            }
+        }
+
+        /**
+         * @brief step function; compute backpropagation of a gathered batch
+         * @param var current position
+         * @param b the gathered batch; the labels are used if the data is labeled
+         * @param ws activation buffers
+         * @param gradient the computed gradients; the return value
+         * @param objective the loss at the current position
+         */
+
+        void step( const variable_t& var, const batch_t &b, workspace_t &ws,
+                   variable_t& gradient, T& objective ) const {
+            if( training_data->labeled() )
+                step( var, b.input, b.labels, ws, gradient, objective );
+            else
+                step( var, b.input, b.target, ws, gradient, objective );
+        }
+
+        /**
+         * @brief step function; compute backpropagation of a single batch
+         * @param var current position
+         * @param input the input batch
+         * @param target the target batch or the class labels of the batch
+         * @param ws activation buffers
+         * @param gradient the computed gradients; the return value
+         * @param objective the loss at the current position
+         */
+
+        template<typename INPUT, typename TARGET>
+        void step( const variable_t& var, const INPUT &input, const TARGET &target,
+                   workspace_t &ws, variable_t& gradient, T& objective ) const {
+            const size_t size = input.columns();
+
+            const cvariable_t &params = propagation_weights( var, ws );
+
+            forward( params, input, ws.x, ws.z, ws.deriv );
+
+            auto &output = std::get<L::value-1>(ws.z);
+
+            // label targets are only reachable with a label loss, the constructor rejects the others
+            if constexpr ( !std::is_same<TARGET, std::vector<size_t>>::value || supports_labels<LOSS>::value )
+                objective += loss.fused( target, output, std::get<L::value-1>(ws.delta), size ) / size;
+
+            backward( params, gradient, input, ws.x, ws.delta, ws.deriv );
+        }
+
+
+
+        /**
+         * @brief layer_input function; input of layer I
+         * @param input view of the input batch
+         * @param x layer inputs
+         * @return the input view for the first layer, the layer input otherwise
+         */
+
+        template<size_t I, typename INPUT>
+        static inline decltype(auto) layer_input( const INPUT &input, const xdata_t &x ) {
+            if constexpr ( I == 0 ) return ( input );
+            else return ( std::get<I>(x) );
+        }
+
+        /**
+         * @brief forward function; compute forwardpropagation
+         * @param layers weights and biases at each layer
+         * @param input view of the input batch
+         * @param x layer inputs; the first entry is not used, the input view is read instead
+         * @param z
+         * @param deriv activation derivatives; the return value
+         */
+
+        template<typename INPUT>
+        void forward( const cvariable_t &layers, const INPUT &input, xdata_t &x, zdata_t &z, zdata_t &deriv ) const {
+            [[maybe_unused]] scoped_timer_t<phase_t::FORWARD> timer;
+            const size_t size = input.columns();
+
+            std::for_range<0,L::value-1>([&]<auto I>(){
+                auto& layer = std::get<I>(layers);
+
+                std::get<I>(z) =  layer.weight * layer_input<I>( input, x );
+                ATYPE<C>::forward_fused( std::get<I>(z), layer.bias,
+                                         std::get<I+1>(x), std::get<I>(deriv) );
+            });
+
+            auto& layer = std::get<L::value-1>(layers);
+            std::get<L::value-1>(z) = layer.weight *
+                    layer_input<L::value-1>( input, x ) + blaze::expand( layer.bias, size );
+
+        }
+
+        /**
+         * @brief backward function; compute backpropagation
+         * @param layers weights and biases at each layer
+         * @param gradient gradient with respect to the weights and biases
+         * @param input view of the input batch
+         * @param x layer inputs; the first entry is not used
+         * @param delta gradients with respect to the layer inputs
+         * @param deriv activation derivatives computed in the forward pass
+         */
+
+          template<typename INPUT>
+          void backward( const cvariable_t &layers, variable_t &gradient, const INPUT &input,
+                         xdata_t &x, zdata_t &delta, zdata_t &deriv ) const {
+              [[maybe_unused]] scoped_timer_t<phase_t::BACKWARD> timer;
+              const C size = input.columns();
+
+              std::for_range<0,L::value-1>([&]<auto I>(){
+
+                  auto &grad = std::get<L::value-I-1>(gradient);
+                  grad.bias += blaze::reduce<blaze::rowwise>(std::get<L::value-I-1>(delta),
+                                               blaze::Add()) / size;
+                  grad.weight +=  std::get<L::value-I-1>(delta)
+                       *  blaze::trans( std::get<L::value-I-1>(x) ) / size ;
+
+                  auto tmp1 = blaze::trans( std::get<L::value-I-1>(delta) )
+                                           * std::get<L::value-I-1>(layers).weight;
+
+                  auto tmp2 = blaze::trans( std::get<L::value-I-2>(deriv) );
+
+                  std::get<L::value-I-2>(delta) = blaze::trans( tmp1 % tmp2 );
+
+
+              });
+
+
+              auto &grad = std::get<0>(gradient);
+              grad.bias += blaze::reduce<blaze::rowwise>(std::get<0>(delta), blaze::Add()) / size;
+              grad.weight +=  std::get<0>(delta) *  blaze::trans( input ) / size;
 
 
           }
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_NETWORK_DATA_HPP__
+#define __LIPNET_NETWORK_DATA_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief The network_data_t struct; training dataset
+     *
+     * The samples are either stored one sample per row (idata, tdata) or one sample
+     * per column in column-major order (icols, tcols). The second layout is the one
+     * the forward pass consumes; a batch of consecutive samples is a contiguous block
+     * of memory and can be used as submatrix view without copying.
+     *
+     * Classification data can store the class label of every sample instead of the
+     * one-hot targets; the target matrices are empty then.
+     *
+     * @tparam T numerical value type
+     * @tparam IN input dimension
+     * @tparam OUT output dimension
+     */
+
+    template<typename T, size_t IN, size_t OUT>
+    struct network_data_t {
+        typedef blaze::DynamicMatrix<T, blaze::rowMajor> rmatrix_t;
+        typedef blaze::DynamicMatrix<T, blaze::columnMajor> cmatrix_t;
+
+        /// one sample per row
+        rmatrix_t idata, tdata;
+
+        /// one sample per column
+        cmatrix_t icols, tcols;
+
+        /// class label per sample; replaces the targets if not empty
+        std::vector<size_t> labels;
+
+        /// number of samples
+        inline size_t samples() const {
+            return ( icols.columns() > 0 ) ? icols.columns() : idata.rows();
+        }
+
+        /// true if the targets are stored as class labels
+        inline bool labeled() const {
+            return !labels.empty();
+        }
+
+        /// true if the samples are stored column by column
+        inline bool columnwise() const {
+            return icols.columns() > 0 || idata.rows() == 0;
+        }
+
+        /**
+         * @brief convert to the column layout; the row layout is released
+         */
+
+        void make_columnwise() {
+            if( idata.rows() == 0 ) return;
+
+            icols = blaze::trans( idata );
+            tcols = blaze::trans( tdata );
+
+            idata = rmatrix_t(); tdata = rmatrix_t();
+        }
+    };
+
+
+    /**
+     * @brief training data of networks with runtime topology; the dimensions are
+     *          only known from the matrices (e.g. icols.rows() inputs)
+     * @tparam T numerical value type
+     */
+
+    template<typename T>
+    using dynamic_data_t = network_data_t<T, 0, 0>;
+
+
+    /**
+     * @brief precision_cast function; convert training data to another numerical type
+     * @tparam C target numerical value type
+     * @param data training data
+     * @return converted training data; data itself if the types match
+     */
+
+    template<typename C, typename T, size_t IN, size_t OUT>
+    network_data_t<C, IN, OUT> precision_cast( network_data_t<T, IN, OUT> &&data ) {
+        if constexpr ( std::is_same<C, T>::value ) {
+            return std::move(data);
+        } else {
+            network_data_t<C, IN, OUT> res;
+            res.idata = data.idata; res.tdata = data.tdata;
+            res.icols = data.icols; res.tcols = data.tcols;
+            res.labels = std::move( data.labels );
+            return res;
+        }
+    }
+
+
+    /**
+     * @brief The shared_data_t struct; read-only training dataset shared between
+     *          several problems, e.g. the configurations of a sweep. A dataset passed
+     *          by value is converted to the column layout and moved into the shared
+     *          storage, thus the problems can be constructed from both.
+     * @tparam T numerical value type
+     * @tparam IN input dimension
+     * @tparam OUT output dimension
+     */
+
+    template<typename T, size_t IN, size_t OUT>
+    struct shared_data_t : public std::shared_ptr<const network_data_t<T, IN, OUT>> {
+        typedef std::shared_ptr<const network_data_t<T, IN, OUT>> base_t;
+
+        shared_data_t() = default;
+
+        shared_data_t( base_t data ) : base_t( std::move(data) ) {}
+
+        shared_data_t( network_data_t<T, IN, OUT> &&data ) : base_t( share( std::move(data) ) ) {}
+
+    private:
+        static base_t share( network_data_t<T, IN, OUT> &&data ) {
+            data.make_columnwise();
+            return std::make_shared<const network_data_t<T, IN, OUT>>( std::move(data) );
+        }
+    };
+
+
+    /**
+     * @brief precision_cast function; convert shared training data to another numerical type
+     * @tparam C target numerical value type
+     * @param data shared training data
+     * @return data itself if the types match and the samples are stored column by
+     *          column, a converted copy otherwise
+     */
+
+    template<typename C, typename T, size_t IN, size_t OUT>
+    shared_data_t<C, IN, OUT> precision_cast( const shared_data_t<T, IN, OUT> &data ) {
+        if( !data )
+            return shared_data_t<C, IN, OUT>();
+
+        if constexpr ( std::is_same<C, T>::value )
+            if( data->columnwise() ) return data;
+
+        network_data_t<T, IN, OUT> copy = *data;
+        return shared_data_t<C, IN, OUT>( precision_cast<C>( std::move(copy) ) );
+    }
+
+}
+
+#endif // __LIPNET_NETWORK_DATA_HPP__
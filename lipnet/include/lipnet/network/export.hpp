@@ -0,0 +1,115 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_NETWORK_EXPORT_HPP__
+#define __LIPNET_NETWORK_EXPORT_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+
+#include <lipnet/network/network.hpp>
+#include <lipnet/network/frozen.hpp>
+
+#include <lipnet/dynamic/network.hpp>
+
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief freeze function; copy the layers of a trained network into the runtime
+     *          sized inference network
+     * @tparam C numerical value type of the inference
+     * @param nn trained network
+     * @return frozen network
+     */
+
+    template<typename C, typename T, template<typename> typename ATYPE, size_t ...N>
+    frozen_network_t<C> freeze( const network_t<T, ATYPE, N...> &nn ) {
+        typedef typename network_t<T, ATYPE, N...>::L L;
+
+        frozen_network_t<C> res;
+        res.activation = static_cast<typename frozen_network_t<C>::activation_t>( ATYPE<T>::type );
+        res.layers.resize( L::value );
+
+        std::for_range<0,L::value>([&]<auto I>(){
+            res.layers[I].weight = std::get<I>( nn.layers ).weight;
+            res.layers[I].bias = std::get<I>( nn.layers ).bias;
+        });
+
+        return res;
+    }
+
+    /**
+     * @brief freeze function; copy the layers of a trained network with runtime
+     *          topology into the inference network
+     * @tparam C numerical value type of the inference
+     * @param nn trained network
+     * @return frozen network
+     */
+
+    template<typename C, typename T, template<typename> typename ATYPE>
+    frozen_network_t<C> freeze( const dynamic_network_t<T, ATYPE> &nn ) {
+        frozen_network_t<C> res;
+        res.activation = static_cast<typename frozen_network_t<C>::activation_t>( ATYPE<T>::type );
+        res.layers.resize( nn.layers.size() );
+
+        for( size_t l = 0; l < nn.layers.size(); ++l ) {
+            res.layers[l].weight = nn.layers[l].weight;
+            res.layers[l].bias = nn.layers[l].bias;
+        }
+
+        return res;
+    }
+
+    /**
+     * @brief export_frozen function; write a trained network in the frozen model format
+     * @param nn trained network
+     * @param path path to file on filesystem
+     * @return false if the file could not be written
+     * @see frozen_network_t
+     */
+
+    template<typename T, template<typename> typename ATYPE, size_t ...N>
+    bool export_frozen( const network_t<T, ATYPE, N...> &nn, const std::string &path ) {
+        return freeze<double>( nn ).save( path );
+    }
+
+    /**
+     * @see export_frozen( const network_t<T, ATYPE, N...> &nn, const std::string &path )
+     */
+
+    template<typename T, template<typename> typename ATYPE>
+    bool export_frozen( const dynamic_network_t<T, ATYPE> &nn, const std::string &path ) {
+        return freeze<double>( nn ).save( path );
+    }
+
+}
+
+#endif // __LIPNET_NETWORK_EXPORT_HPP__
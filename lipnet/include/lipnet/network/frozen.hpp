@@ -0,0 +1,253 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_NETWORK_FROZEN_HPP__
+#define __LIPNET_NETWORK_FROZEN_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <fstream>
+#include <cstdint>
+#include <cmath>
+
+#include <blaze/Blaze.h>
+
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief header of the frozen model format; followed by the layers+1 dimensions as
+     *          uint64 and the weights (row-major) and biases of every layer as double
+     */
+
+    struct frozen_header_t {
+        static constexpr uint32_t magic_value = 0x4d50494c; // "LIPM"
+        static constexpr uint32_t version_value = 1;
+
+        uint32_t magic = magic_value;
+        uint32_t version = version_value;
+        uint32_t activation = 0;     /// activation of the hidden layers; values of atype_t
+        uint32_t layers = 0;         /// number of layers
+    };
+
+
+    /**
+     * @brief The frozen_network_t struct; forward pass of a trained network with runtime
+     *          sized layers. Only depends on blaze, the topology is read from the model
+     *          file. The weights are held in padded, aligned matrices which the blaze
+     *          kernels consume directly, the bias and activation are applied in one
+     *          pass after every product.
+     *
+     * @tparam T numerical value type of the inference; independent of the stored type
+     */
+
+    template<typename T>
+    struct frozen_network_t {
+
+        typedef blaze::DynamicMatrix<T, blaze::rowMajor> dmatrix_t;
+        typedef blaze::DynamicVector<T, blaze::columnVector> dvector_t;
+
+        /// activation of the hidden layers; same values as atype_t
+        enum activation_t : uint32_t { SIGMOID = 0, TANH = 1, NONE = 2 };
+
+        struct layer_t {
+            dmatrix_t weight; dvector_t bias;
+        };
+
+        /// reusable activation buffers of a query
+        struct workspace_t {
+            dmatrix_t x, z;
+        };
+
+        std::vector<layer_t> layers;
+        activation_t activation = TANH;
+
+
+        /// input dimension
+        inline size_t inputs() const { return layers.front().weight.columns(); }
+
+        /// output dimension
+        inline size_t outputs() const { return layers.back().weight.rows(); }
+
+
+        /**
+         * @brief query_batch function; compute the outputs of a batch
+         * @param input inputs; one sample per column
+         * @param ws activation buffers; reused over the queries
+         * @return outputs; one sample per column
+         */
+
+        template<typename MT>
+        const dmatrix_t& query_batch( const MT &input, workspace_t &ws ) const {
+            if( layers.empty() || input.rows() != inputs() )
+                throw std::string{"wrong input dimension"};
+
+            ws.x = input;
+
+            for( size_t l = 0; l < layers.size(); ++l ) {
+                ws.z = layers[l].weight * ws.x;
+                std::swap( ws.x, ws.z );
+                activate( ws.x, layers[l].bias, l+1 < layers.size() ? activation : NONE );
+            }
+
+            return ws.x;
+        }
+
+        /**
+         * @see query_batch( const MT &input, workspace_t &ws )
+         */
+
+        template<typename MT>
+        dmatrix_t query_batch( const MT &input ) const {
+            workspace_t ws;
+            query_batch( input, ws );
+            return std::move( ws.x );
+        }
+
+        /**
+         * @brief query function; compute the output of a single sample
+         * @param input input vector
+         * @return output vector
+         */
+
+        template<typename VT>
+        dvector_t query( const VT &input ) const {
+            dmatrix_t in( input.size(), 1 );
+            blaze::column( in, 0 ) = input;
+            return blaze::column( query_batch( in ), 0 );
+        }
+
+
+        /**
+         * @brief save function; write the model in the frozen format
+         * @param path path to file on filesystem
+         * @return false if the file could not be written
+         */
+
+        bool save( const std::string &path ) const {
+            std::ofstream os( path, std::ios::binary );
+            if( !os ) return false;
+
+            frozen_header_t header;
+            header.activation = activation;
+            header.layers = layers.size();
+            os.write( reinterpret_cast<const char*>( &header ), sizeof(header) );
+
+            std::vector<uint64_t> dims{ inputs() };
+            for( const auto &layer : layers ) dims.push_back( layer.weight.rows() );
+            os.write( reinterpret_cast<const char*>( dims.data() ), dims.size()*sizeof(uint64_t) );
+
+            for( const auto &layer : layers ) {
+                std::vector<double> values;
+                values.reserve( layer.weight.rows()*layer.weight.columns() + layer.bias.size() );
+
+                for( size_t i = 0; i < layer.weight.rows(); ++i )
+                    for( size_t j = 0; j < layer.weight.columns(); ++j )
+                        values.push_back( layer.weight(i,j) );
+                for( size_t i = 0; i < layer.bias.size(); ++i )
+                    values.push_back( layer.bias[i] );
+
+                os.write( reinterpret_cast<const char*>( values.data() ), values.size()*sizeof(double) );
+            }
+
+            return (bool) os;
+        }
+
+        /**
+         * @brief load function; read a model in the frozen format
+         * @param path path to file on filesystem
+         * @return the model
+         */
+
+        static frozen_network_t load( const std::string &path ) {
+            std::ifstream is( path, std::ios::binary );
+            if( !is )
+                throw std::string{"could not open frozen model: "} + path;
+
+            frozen_header_t header;
+            is.read( reinterpret_cast<char*>( &header ), sizeof(header) );
+
+            if( !is || header.magic != frozen_header_t::magic_value
+                    || header.version != frozen_header_t::version_value )
+                throw std::string{"not a frozen model: "} + path;
+            if( header.layers == 0 || header.activation > NONE )
+                throw std::string{"corrupt frozen model: "} + path;
+
+            std::vector<uint64_t> dims( header.layers+1 );
+            is.read( reinterpret_cast<char*>( dims.data() ), dims.size()*sizeof(uint64_t) );
+
+            frozen_network_t res;
+            res.activation = static_cast<activation_t>( header.activation );
+            res.layers.resize( header.layers );
+
+            std::vector<double> values;
+            for( size_t l = 0; l < header.layers; ++l ) {
+                const size_t rows = dims[l+1], cols = dims[l];
+
+                values.resize( rows*cols + rows );
+                is.read( reinterpret_cast<char*>( values.data() ), values.size()*sizeof(double) );
+                if( !is )
+                    throw std::string{"truncated frozen model: "} + path;
+
+                auto &layer = res.layers[l];
+                layer.weight.resize( rows, cols, false );
+                layer.bias.resize( rows, false );
+
+                for( size_t i = 0; i < rows; ++i )
+                    for( size_t j = 0; j < cols; ++j )
+                        layer.weight(i,j) = values[i*cols+j];
+                for( size_t i = 0; i < rows; ++i )
+                    layer.bias[i] = values[rows*cols+i];
+            }
+
+            return res;
+        }
+
+    private:
+
+        /// add the bias and apply the activation in place; one pass over the batch
+        static void activate( dmatrix_t &z, const dvector_t &bias, const activation_t type ) {
+            const auto apply = [&]( auto &&f ) {
+                for( size_t i = 0; i < z.rows(); i++ ) {
+                    const T b = bias[i];
+                    for( size_t j = 0; j < z.columns(); j++ )
+                        z(i,j) = f( z(i,j) + b );
+                }
+            };
+
+            switch( type ) {
+            case SIGMOID: apply( []( const T v ){ return T(1) / ( T(1) + std::exp( -v ) ); } ); break;
+            case TANH:    apply( []( const T v ){ return std::tanh( v ); } ); break;
+            case NONE:    apply( []( const T v ){ return v; } ); break;
+            }
+        }
+
+    };
+
+}
+
+#endif // __LIPNET_NETWORK_FROZEN_HPP__
@@ -214,6 +214,52 @@ namespace lipnet {
     };
 
 
+    template<typename T, size_t I, size_t O>
+    struct update_t<T, layer_t<T,I,O>> {
+        typedef update_t<T, typename layer_t<T,I,O>::MT> wupdate_t;
+        typedef update_t<T, typename layer_t<T,I,O>::VT> bupdate_t;
+
+        static inline void scale_add( layer_t<T,I,O> &y, const T a, const layer_t<T,I,O> &x, const T b ) {
+            wupdate_t::scale_add( y.weight, a, x.weight, b );
+            bupdate_t::scale_add( y.bias, a, x.bias, b );
+        }
+
+        static inline void scale_add_square( layer_t<T,I,O> &y, const T a, const layer_t<T,I,O> &x, const T b ) {
+            wupdate_t::scale_add_square( y.weight, a, x.weight, b );
+            bupdate_t::scale_add_square( y.bias, a, x.bias, b );
+        }
+
+        static inline void axpy( layer_t<T,I,O> &y, const T a, const layer_t<T,I,O> &x ) {
+            wupdate_t::axpy( y.weight, a, x.weight );
+            bupdate_t::axpy( y.bias, a, x.bias );
+        }
+
+        static inline void adam_direction( layer_t<T,I,O> &d, const layer_t<T,I,O> &m, const layer_t<T,I,O> &v,
+                                           const T c1, const T c2, const T eps ) {
+            wupdate_t::adam_direction( d.weight, m.weight, v.weight, c1, c2, eps );
+            bupdate_t::adam_direction( d.bias, m.bias, v.bias, c1, c2, eps );
+        }
+    };
+
+
+    template<typename T, size_t I, size_t O>
+    struct flat_t<T, layer_t<T,I,O>> {
+        typedef flat_t<T, typename layer_t<T,I,O>::MT> wflat_t;
+        typedef flat_t<T, typename layer_t<T,I,O>::VT> bflat_t;
+        static constexpr size_t size = wflat_t::size + bflat_t::size;
+
+        static inline void pack( const layer_t<T,I,O> &m, T *dst ) {
+            wflat_t::pack( m.weight, dst );
+            bflat_t::pack( m.bias, dst + wflat_t::size );
+        }
+
+        static inline void unpack( const T *src, layer_t<T,I,O> &m ) {
+            wflat_t::unpack( src, m.weight );
+            bflat_t::unpack( src + wflat_t::size, m.bias );
+        }
+    };
+
+
     template<typename T, size_t I1, size_t O1, size_t I2, size_t O2>
     struct prod_t<T, layer_t<T,I1,O1>, layer_t<T,I2,O2>> {
         static inline T inner( const layer_t<T,I1,O1> &m1, const layer_t<T,I2,O2> &m2 ) {
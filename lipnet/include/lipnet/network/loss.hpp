@@ -29,6 +29,7 @@
 #include <initializer_list>
 #include <deque>
 #include <iostream>
+#include <cmath>
 
 #include <lipnet/traits.hpp>
 #include <lipnet/tensor.hpp>
@@ -104,6 +105,44 @@ namespace lipnet {
             return 2*(data-target);
         }
 
+        /**
+         * @brief The evaluate function for runtime sized batches
+         * @see evaluate(const matrix_t<T,N, BATCH> &target, const matrix_t<T,N, BATCH> &data)
+         */
+
+        template<bool SO>
+        T evaluate(const blaze::DynamicMatrix<T, SO> &target, const blaze::DynamicMatrix<T, SO> &data) const {
+            blaze::DynamicMatrix<T, SO> diff = data-target;
+            return blaze::inner(diff,diff);
+        }
+
+        /**
+         * @brief The gradient function for runtime sized batches
+         * @see gradient(const matrix_t<T,N, BATCH> &target, const matrix_t<T,N, BATCH> &data)
+         */
+
+        template<bool SO>
+        auto gradient(const blaze::DynamicMatrix<T, SO> &target, const blaze::DynamicMatrix<T, SO> &data) const {
+            return 2*(data-target);
+        }
+
+        /**
+         * @brief The fused function; compute loss and gradient in one pass
+         * @param target real value; one sample per column
+         * @param data estimated value; one sample per column
+         * @param gradient gradient of the loss; the return value
+         * @param valid number of leading columns summed in the loss
+         * @return loss
+         */
+
+        template<typename TT, typename MT, typename GT>
+        T fused(const TT &target, const MT &data, GT &gradient, const size_t valid) const {
+            gradient = data - target;
+            const T loss = blaze::sqrNorm( blaze::submatrix( gradient, 0UL, 0UL, gradient.rows(), valid ) );
+            gradient *= T(2);
+            return loss;
+        }
+
     };
 
 
@@ -146,7 +185,7 @@ namespace lipnet {
         template<size_t N, size_t BATCH = 0, typename std::enable_if<BATCH <= 0,int>::type = 0>
         T evaluate(const vector_t<T, N> &target, const vector_t<T, N> &data) const {
             auto soft = blaze::softmax( data );
-            return - std::log( blaze::inner(target, soft) + 1e-8);
+            return - std::log( blaze::inner(target, soft) + T(1e-8) );
         }
 
         /**
@@ -176,9 +215,151 @@ namespace lipnet {
             return o;
         }
 
-        
+        /**
+         * @brief The evaluate function for runtime sized batches
+         * @see evaluate(const matrix_t<T, N, BATCH> &target, const matrix_t<T, N, BATCH> &data)
+         */
+
+        template<bool SO>
+        T evaluate(const blaze::DynamicMatrix<T, SO> &target, const blaze::DynamicMatrix<T, SO> &data) const {
+            auto soft = blaze::softmax<blaze::columnwise>( data );
+            blaze::DynamicMatrix<T, SO> tmp = target % soft;
+            return - blaze::sum( blaze::log(  blaze::reduce<blaze::columnwise>(tmp, blaze::Add() ) ));
+        }
+
+        /**
+         * @brief The gradient function for runtime sized batches
+         * @see gradient(const matrix_t<T, N, BATCH> &target, const matrix_t<T, N, BATCH> &data)
+         */
+
+        template<bool SO>
+        auto gradient(const blaze::DynamicMatrix<T, SO> &target, const blaze::DynamicMatrix<T, SO> &data) const {
+            blaze::DynamicMatrix<T, SO> o = blaze::softmax<blaze::columnwise>( data ) - target;
+            return o;
+        }
+
+        /**
+         * @brief The evaluate function for class label targets; the softmax is indexed
+         *        directly instead of masking it with a one-hot matrix
+         *        @f[ \mathcal{L}(x,y) = \log \sum_i \exp{x_i} - x_y @f]
+         * @param labels class label of every column; at least as many as columns
+         * @param data estimated value; one sample per column
+         * @return loss
+         */
+
+        template<typename MT>
+        T evaluate(const std::vector<size_t> &labels, const MT &data) const {
+            T loss = 0;
+            for( size_t j = 0; j < data.columns(); ++j ) {
+                auto col = blaze::column( data, j );
+                const T m = blaze::max( col );
+                loss += std::log( blaze::sum( blaze::exp( col - m ) ) ) + m - data( labels[j], j );
+            }
+            return loss;
+        }
+
+        /**
+         * @brief The gradient function for class label targets
+         * @see evaluate(const std::vector<size_t> &labels, const MT &data)
+         */
+
+        template<typename MT>
+        auto gradient(const std::vector<size_t> &labels, const MT &data) const {
+            typename MT::ResultType o = blaze::softmax<blaze::columnwise>( data );
+            for( size_t j = 0; j < o.columns(); ++j )
+                o( labels[j], j ) -= T(1);
+            return o;
+        }
+
+        /**
+         * @brief The fused function; compute loss and gradient in one pass. Column by
+         *        column the maximum, the shifted exponentials and their sum, the target
+         *        logit, the loss and the gradient (normalised exponentials minus the
+         *        target) are computed while the column is in cache.
+         * @param target real value; one sample per column
+         * @param data estimated value; one sample per column
+         * @param gradient gradient of the loss; the return value
+         * @param valid number of leading columns summed in the loss
+         * @return loss
+         */
+
+        template<typename TT, typename MT, typename GT>
+        T fused(const TT &target, const MT &data, GT &gradient, const size_t valid) const {
+            blaze::resize( gradient, data.rows(), data.columns(), false );
+
+            T loss = 0;
+            for( size_t j = 0; j < data.columns(); ++j ) {
+                const auto [ m, s ] = exponentials( data, gradient, j );
+                const T inv = T(1) / s;
+
+                // logit of the target from the data, not from the exponentials which can underflow
+                T td = 0;
+                for( size_t i = 0; i < data.rows(); ++i ) {
+                    td += target(i,j) * data(i,j);
+                    gradient(i,j) = gradient(i,j) * inv - target(i,j);
+                }
+
+                if( j < valid )
+                    loss += std::log( s ) + m - td;
+            }
+            return loss;
+        }
+
+        /**
+         * @brief The fused function for class label targets
+         * @see fused(const TT &target, const MT &data, GT &gradient, const size_t valid)
+         */
+
+        template<typename MT, typename GT>
+        T fused(const std::vector<size_t> &labels, const MT &data, GT &gradient, const size_t valid) const {
+            blaze::resize( gradient, data.rows(), data.columns(), false );
+
+            T loss = 0;
+            for( size_t j = 0; j < data.columns(); ++j ) {
+                const auto [ m, s ] = exponentials( data, gradient, j );
+                const T inv = T(1) / s;
+
+                for( size_t i = 0; i < data.rows(); ++i )
+                    gradient(i,j) *= inv;
+                gradient( labels[j], j ) -= T(1);
+
+                if( j < valid )
+                    loss += std::log( s ) + m - data( labels[j], j );
+            }
+            return loss;
+        }
+
+    private:
+
+        /// exponentials of column j shifted by its maximum; returns the maximum and the sum
+        template<typename MT, typename GT>
+        static std::pair<T,T> exponentials(const MT &data, GT &e, const size_t j) {
+            T m = data(0,j);
+            for( size_t i = 1; i < data.rows(); ++i )
+                m = std::max( m, T( data(i,j) ) );
+
+            T s = 0;
+            for( size_t i = 0; i < data.rows(); ++i ) {
+                e(i,j) = std::exp( data(i,j) - m );
+                s += e(i,j);
+            }
+            return { m, s };
+        }
+
     };
 
+
+    /**
+     * @brief supports_labels trait; true if the loss evaluates class label targets
+     */
+
+    template<template<typename> typename LOSS>
+    struct supports_labels : std::false_type {};
+
+    /// @see supports_labels
+    template<>
+    struct supports_labels<cross_entropy_t> : std::true_type {};
+
 }
 
 #endif // __LIPNET_LOSS_HPP__
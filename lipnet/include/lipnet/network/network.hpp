@@ -42,6 +42,7 @@
 #include <lipnet/traits.hpp>
 #include <lipnet/tensor.hpp>
 #include <lipnet/problem.hpp>
+#include <lipnet/parallel.hpp>
 
 #include <lipnet/network/layer.hpp>
 #include <lipnet/network/loss.hpp>
@@ -99,6 +100,8 @@ namespace lipnet {
         typedef blaze::StaticVector<T, at<0, N...>(),
                         blaze::columnVector> invec_t;
 
+        typedef blaze::DynamicMatrix<T, blaze::rowMajor> dmatrix_t;
+
 
         /// serialization helper struct
         struct topology_serialization_t {
@@ -149,6 +152,49 @@ namespace lipnet {
 
         }
 
+        /**
+         * @brief query the neural network with a batch of inputs; every layer is one
+         *          matrix product over the batch
+         * @param input inputs; one sample per column
+         * @param threads number of threads; the columns are split in contiguous blocks
+         * @return outputs; one sample per column
+         */
+
+        template<typename MT>
+        dmatrix_t query_batch( const MT &input, const size_t threads = 1 ) const {
+            if( input.rows() != at<0, N...>() )
+                throw std::string{"wrong input dimension"};
+
+            dmatrix_t output( at<L::value, N...>(), input.columns() );
+
+            parallel_for( input.columns(), threads, [&]( const size_t, const size_t begin, const size_t end ) {
+                blaze::submatrix( output, 0UL, begin, at<L::value, N...>(), end-begin ) =
+                        propagate( blaze::submatrix( input, 0UL, begin, at<0, N...>(), end-begin ) );
+            });
+
+            return output;
+        }
+
+        /**
+         * @brief propagate a batch of inputs through the layers
+         * @param input inputs; one sample per column
+         * @return outputs; one sample per column
+         */
+
+        template<typename MT>
+        dmatrix_t propagate( const MT &input ) const {
+            dmatrix_t x( input ), z;
+
+            std::for_range<0,L::value-1>([&]<auto I>(){
+                auto& layer = std::get<I>(layers);
+                z = layer.weight * x + blaze::expand( layer.bias, x.columns() );
+                x = ATYPE<T>::template forward<at<I+1,N...>(),1>( z );
+            });
+
+            auto& layer = std::get<L::value-1>(layers);
+            return layer.weight * x + blaze::expand( layer.bias, x.columns() );
+        }
+
 
 
         /// serialize network
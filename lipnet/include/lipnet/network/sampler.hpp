@@ -0,0 +1,144 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_NETWORK_SAMPLER_HPP__
+#define __LIPNET_NETWORK_SAMPLER_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/string.hpp>
+
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief The batch_sampler_t struct; produces the sample indices of the mini batches.
+     *          Each epoch visits every sample once; with shuffling enabled the order is
+     *          permuted at the start of every epoch. The last batch of an epoch holds the
+     *          remainder and can be padded to the full batch size.
+     */
+
+    struct batch_sampler_t {
+
+        size_t samples, batch;
+        bool shuffle;
+
+        std::mt19937_64 engine;
+        std::vector<size_t> order;
+
+        /// index of the next batch within the epoch
+        size_t position;
+        size_t epoch;
+
+        /// order and engine before the last shuffle; restored by rewind
+        std::vector<size_t> previous_order;
+        std::mt19937_64 previous_engine;
+
+        explicit batch_sampler_t( const size_t nsamples, const size_t batchsize,
+                                  const bool shuffled = true, const size_t seed = 0 )
+            : samples{ nsamples }, batch{ batchsize }, shuffle{ shuffled }, engine{ seed },
+              order( nsamples ), position{ 0 }, epoch{ 0 } {
+
+            if( samples == 0 || batch == 0 )
+                throw std::string{"empty sampler"};
+
+            std::iota( order.begin(), order.end(), 0UL );
+            if( shuffle ) std::shuffle( order.begin(), order.end(), engine );
+        }
+
+        /// number of batches per epoch
+        inline size_t batches() const {
+            return ( samples + batch - 1 ) / batch;
+        }
+
+        /**
+         * @brief next function; indices of the next batch
+         * @param indices the sample indices; the return value
+         * @param pad fill the remainder batch up to the batch size; the padding
+         *          entries repeat the first index of the batch and have to be masked
+         * @return number of valid indices
+         */
+
+        size_t next( std::vector<size_t> &indices, const bool pad ) {
+            if( position == batches() ) {
+                position = 0; epoch++;
+                if( shuffle ) {
+                    previous_order = order; previous_engine = engine;
+                    std::shuffle( order.begin(), order.end(), engine );
+                }
+            }
+
+            const size_t first = position*batch;
+            const size_t valid = std::min( batch, samples - first );
+
+            indices.assign( order.begin() + first, order.begin() + first + valid );
+            if( pad ) indices.resize( batch, order[first] );
+
+            position++;
+            return valid;
+        }
+
+        /**
+         * @brief rewind function; undo the last call of next, e.g. for a batch which was
+         *          prefetched but not used. Only one call can be undone.
+         */
+
+        void rewind() {
+            if( position == 0 ) return;
+
+            if( position > 1 || epoch == 0 ) { position--; return; }
+
+            // first batch of an epoch; back to the end of the previous one
+            position = batches(); epoch--;
+            if( shuffle ) { order = previous_order; engine = previous_engine; }
+        }
+
+
+        /// @cite cereallib
+        template<class Archive> void save( Archive & archive ) const {
+            std::ostringstream os; os << engine;
+            archive( samples, batch, shuffle, order, position, epoch, os.str() );
+        }
+
+        /// @cite cereallib
+        template<class Archive> void load( Archive & archive ) {
+            std::string state;
+            archive( samples, batch, shuffle, order, position, epoch, state );
+            std::istringstream is( state ); is >> engine;
+        }
+
+    };
+
+}
+
+#endif // __LIPNET_NETWORK_SAMPLER_HPP__
@@ -152,6 +152,37 @@ namespace lipnet {
 
 
 
+
+
+
+
+    /// helper struct for data with runtime batch size
+    template<typename T, size_t N, size_t ...NS>
+    struct generate_dynamic_batch_data {
+
+      typedef blaze::DynamicMatrix<T, blaze::rowMajor> matrix_t;
+
+      typedef typename generate_dynamic_batch_data<T, NS...>::type next;
+      typedef typename join_tuples<std::tuple<matrix_t>, next>::type type;
+    };
+
+    /// helper struct for data with runtime batch size
+    template<typename T, size_t N>
+    struct generate_dynamic_batch_data<T, N>{
+
+        typedef blaze::DynamicMatrix<T, blaze::rowMajor> matrix_t;
+
+        typedef std::tuple<matrix_t> type; };
+
+    /// helper struct for data with runtime batch size
+    template<typename T, size_t N, size_t ...NS>
+    struct generate_dynamic_batch_data_remove_first {
+        typedef typename generate_dynamic_batch_data<T, NS...>::type type;
+    };
+
+
+
+
 }
 
 #endif // __LIPNET_NETWORK_TOPOLOGY_HPP__
@@ -36,6 +36,7 @@
 #include <lipnet/tensor.hpp>
 #include <lipnet/problem.hpp>
 #include <lipnet/statistics.hpp>
+#include <lipnet/profile.hpp>
 
 //#include <lipnet/optimizer/gradient_descent.hpp>
 #include <lipnet/optimizer/fast_gradient_descent.hpp>
@@ -48,6 +49,7 @@
 #include <lipnet/optimizer/adam_momentum.hpp>
 #include <lipnet/optimizer/adam_barrier.hpp>
 #include <lipnet/optimizer/adam_projected.hpp>
+#include <lipnet/optimizer/lbfgs.hpp>
 
 #include <lipnet/optimizer/admm_optimizer.hpp>
 //#include <lipnet/optimizer/augmented_lagrangian.hpp>
@@ -110,15 +112,19 @@ namespace lipnet {
         /**
          * @brief The main_statistics_t struct.
          * @details Just contains a variable to, which stores th computation time to solve
-         *          the problem. The variable stores it's value in milliseconds.
+         *          the problem. The variable stores it's value in milliseconds. If compiled
+         *          with LIPNET_PROFILE the time spent in every phase is stored as well.
          */
 
         struct main_statistics_t : public IMPL::statistics_t, public statistics_problem_t  {
             std::chrono::milliseconds duration;
+            profile_statistics_t profile;
 
             template<class Archive> void serialize(Archive & archive)
                 {   static_cast<typename IMPL::statistics_t>(*this).serialize( archive );
-                    archive( cereal::make_nvp("optimization-time",  duration.count() ) ); }
+                    archive( cereal::make_nvp("optimization-time",  duration.count() ) );
+                    if constexpr ( profile_t::enabled )
+                        archive( cereal::make_nvp("profile", profile ) ); }
         };
 
 
@@ -136,17 +142,24 @@ namespace lipnet {
         inline std::tuple<VARS...,T> run( P &prob, VARS&& ...vars ,  typename std::conditional<stats_enabled,
                                           main_statistics_t, std::void_type >::type &stats ) const {
 
+            const profile_statistics_t p1 = profile_t::global().snapshot();
             auto t1 = std::chrono::high_resolution_clock::now();
             auto res = std::invoke( &IMPL::template run<stats_enabled>, *this,
                                     prob, std::forward<VARS>(vars)..., stats );
             auto t2 = std::chrono::high_resolution_clock::now();
+            const profile_statistics_t profile = profile_t::global().snapshot() - p1;
 
-            if constexpr (stats_enabled)
+            if constexpr (stats_enabled) {
                 stats.duration = std::chrono::duration_cast<
                                     std::chrono::milliseconds>(t2-t1);
+                stats.profile = profile;
+            }
 
             std::cout << "\n\n ===> duration: " << std::chrono::duration_cast<
-                         std::chrono::milliseconds>(t2-t1).count() << "\n\n";
+                         std::chrono::milliseconds>(t2-t1).count() << "\n";
+            if constexpr ( profile_t::enabled )
+                profile.print( std::cout );
+            std::cout << "\n";
 
             return std::move(res);
         }
@@ -215,6 +228,9 @@ namespace lipnet {
     template<typename T, typename P, typename VAR, typename GRAD>
     using adam_projected_t = optimizer_t<T, P, adam_projected_t_impl<T, P, VAR, GRAD>, VAR>;
 
+    template<typename T, typename P, typename VAR, typename GRAD>
+    using lbfgs_t = optimizer_t<T, P, lbfgs_t_impl<T, P, VAR, GRAD>, VAR>;
+
 
     //template<typename T, typename P, typename VAR, typename GRAD, typename HESS>
     //using newton_method_t = optimizer_t<T, P, newton_method_t_impl<T, P, VAR, GRAD, HESS>, VAR>;
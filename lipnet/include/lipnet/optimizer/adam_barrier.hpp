@@ -39,6 +39,7 @@
 #include <lipnet/problem.hpp>
 #include <lipnet/variable.hpp>
 #include <lipnet/statistics.hpp>
+#include <lipnet/checkpoint.hpp>
 
 
 
@@ -91,6 +92,11 @@ namespace lipnet {
 
             T eps;                  /// numerical offset (default = 1e-8)
 
+            checkpoint_t checkpoint = {}; /// periodic checkpoints; resumed if the file exists (default = disabled)
+
+            size_t lipschitz_every = 0; /// iterations between two lipschitz estimates of the problem (default = 0, disabled)
+            T lipschitz_stop = 0;       /// stop once the lipschitz estimate exceeds this value (default = 0, disabled)
+            size_t backtracking = 0;    /// maximal step halvings if a step leaves the feasible set of the problem (default = 0, disabled)
         };
 
 
@@ -99,14 +105,41 @@ namespace lipnet {
         /// @cite cereallib
         struct statistics_t {
             series_t<T> loss;
+            series_t<T> lipschitz;
 
             template<class Archive> void serialize(Archive & archive)
-                {  archive( cereal::make_nvp("loss", loss) ); }
+                {  archive( cereal::make_nvp("loss", loss),
+                            cereal::make_nvp("lipschitz", lipschitz) ); }
+        };
+
+
+        /**
+         * @brief The state_t struct; full optimizer state between two iterations,
+         *          references to the variables of run. The metainfo holds the sampler
+         *          position and the singular vectors of the lipschitz estimate; the
+         *          gradient and the feasibility step are recomputed from x on resume.
+         * @tparam STATS statistics holder or void_type
+         */
+
+        template<typename STATS>
+        struct state_t {
+            VAR &x; GRAD &momentum, &velocity;
+            T &gamma, &alpha, &fx, &fxl, &avglossdecrease;
+            size_t &j, &i;
+            metainfo_t<P> &info;
+            STATS &stats;
+
+            template<class Archive> void serialize(Archive & archive)
+                {  archive( x, momentum, velocity, gamma, alpha, fx, fxl, avglossdecrease, j, i, info );
+                   if constexpr ( !std::is_same<STATS, std::void_type>::value )
+                       archive( stats ); }
         };
 
 
         /// variables to optimize
         parameter_t param;
+        /// optional statistics file; replaces the in-memory loss series if set
+        std::shared_ptr<statistics_sink_t<T>> sink;
 
         /**
          * @brief Default constructor.
@@ -135,37 +168,65 @@ namespace lipnet {
             GRAD gradient; feasibility_t<P,T,VAR> step;
             T fx; T fxl = std::numeric_limits<T>::max();
 
-            GRAD momentum, velocity;
+            GRAD momentum, velocity, direction;
 
             T gamma = param.gamma;
             T alpha = param.alpha;
 
+            // && avglossdecrease < -1e-8
+            T avglossdecrease = -10; //&& avglossdecrease < -diff
+            size_t j = 0, i = 0;
+
+            typedef typename std::remove_reference<decltype(stats)>::type stats_t;
+            state_t<stats_t> state{ x, momentum, velocity, gamma, alpha, fx, fxl,
+                                    avglossdecrease, j, i, info, stats };
+            bool resume = param.checkpoint.load( "adam-barrier", state );
+
+            // cheap lipschitz estimate of the problem every lipschitz_every iterations
+            T estimate = 0; bool stop = false;
+            const auto track = [&]( const size_t it ) {
+                if constexpr ( lipschitz_estimate_helper::exists<P>::value ) {
+                    if( param.lipschitz_every == 0 || it % param.lipschitz_every != 0 ) return;
+
+                    estimate = prob.lipschitz_estimate( x, info );
+                    if constexpr ( stats_enabled )
+                        if( !sink ) stats.lipschitz << estimate;
+
+                    stop = param.lipschitz_stop > 0 && estimate > param.lipschitz_stop;
+                }
+            };
+
 
-            for(int j = 0; j < param.cpsteps; j++){
+            for( ; j < param.cpsteps && !stop; j++){
 
                 // get current stopping criterion for each step in central path
-                T diff = param.diff*std::pow(param.beta3,param.cpsteps-j);
-                T threshold = param.threshold*std::pow(param.beta3,param.cpsteps-j);
+                T diff = param.diff*std::pow(param.beta3,(T)(param.cpsteps-j));
+                T threshold = param.threshold*std::pow(param.beta3,(T)(param.cpsteps-j));
 
 
                 unpack( prob( x, info, step, gamma ) , gradient, fx );
-                if constexpr ( stats_enabled )
-                        stats.loss << fx;
 
-                // && avglossdecrease < -1e-8
-                T avglossdecrease = -10; //&& avglossdecrease < -diff
-                size_t i = 0; fxl = std::numeric_limits<T>::max();
-                while( (abs(fxl-fx) > diff && i++ < param.max_iter && avglossdecrease < -threshold ) ) {
+                // a resumed central path step continues its iteration count and window
+                if( !resume ) {
+                    avglossdecrease = -10;
+                    i = 0; fxl = std::numeric_limits<T>::max();
 
-                    momentum = param.beta1 * momentum + (1-param.beta1)*gradient;
-                    velocity = param.beta2 * velocity + (1-param.beta2)*function_t<GRAD>::square(gradient);
+                    track( i );
+                    if( sink ) (*sink)( 0, j, fx, 0, gamma, estimate );
+                    else if constexpr ( stats_enabled )
+                        stats.loss << fx;
+                }
+                resume = false;
 
-                    GRAD t_momentum = (T(1)/(T(1)- std::pow(param.beta1,(T)i) )) * momentum;
-                    GRAD t_velocity = (T(1)/(T(1)- std::pow(param.beta2,(T)i) )) * velocity;
+                while( (!stop && abs(fxl-fx) > diff && i++ < param.max_iter && avglossdecrease < -threshold ) ) {
 
+                    update_t<T,GRAD>::scale_add( momentum, param.beta1, gradient, 1-param.beta1 );
+                    update_t<T,GRAD>::scale_add_square( velocity, param.beta2, gradient, 1-param.beta2 );
 
-                    auto tmp = param.eps + function_t<GRAD>::sqrt(t_velocity);
-                    auto direction = t_momentum / tmp;
+                    // bias corrected direction
+                    update_t<T,GRAD>::adam_direction( direction, momentum, velocity,
+                                    T(1)/(T(1)- std::pow(param.beta1,(T)i) ),
+                                    T(1)/(T(1)- std::pow(param.beta2,(T)i) ), param.eps );
 
 
 
@@ -180,11 +241,35 @@ namespace lipnet {
                             }
                     }
 
-                    x -= alpha * dalpha * direction;
+                    // backtracking; halve the step until the problem admits it, the
+                    // decomposition of the accepted step is reused by the gradient. The
+                    // moments are kept, only the step is shortened
+                    bool stepped = false;
+                    if constexpr ( admissible_helper::exists<P>::value ) {
+                        if( param.backtracking > 0 ) {
+                            const VAR previous = x;
+                            update_t<T,GRAD>::axpy( x, -alpha * dalpha, direction );
+
+                            size_t halvings = 0;
+                            while( !prob.admissible( x, info ) ) {
+                                x = previous;
+                                if( halvings++ == param.backtracking ) { dalpha = 0; break; }
+
+                                dalpha /= 2;
+                                update_t<T,GRAD>::axpy( x, -alpha * dalpha, direction );
+                            }
+                            stepped = true;
+                        }
+                    }
+
+                    if( !stepped )
+                        update_t<T,GRAD>::axpy( x, -alpha * dalpha, direction );
 
                     fxl = fx;
                     unpack( prob( x, info, step, gamma ) , gradient, fx );
-                    if constexpr ( stats_enabled )
+                    track( i );
+                    if( sink ) (*sink)( i, j, fx, alpha * dalpha, gamma, estimate );
+                    else if constexpr ( stats_enabled )
                             stats.loss << fx;
 
 
@@ -195,15 +280,25 @@ namespace lipnet {
                     if( i % 100 == 0) {
                         std::cout << " => (" << i << ") loss: " << fx  << "\n";
                     }
+
+                    if( param.checkpoint.due( i ) )
+                        param.checkpoint.save( "adam-barrier", state );
                 }
 
 
+                if( stop )
+                    std::cout << " => lipschitz estimate " << estimate << " exceeds "
+                              << param.lipschitz_stop << ", stopping\n";
+
                 // update stepsize and gamma
                 gamma *= param.gammadec;
                 alpha *= param.alphadec;
 
             }
 
+            param.checkpoint.clear();
+            if( sink ) sink->flush();
+
             return std::make_tuple( std::move(x),  fx );
         }
 
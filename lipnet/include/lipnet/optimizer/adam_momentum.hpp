@@ -91,10 +91,28 @@ namespace lipnet {
         };
 
 
+        /**
+         * @brief The state_t struct; adam moments and iteration count to continue
+         *          a previous run (e.g. repeated subproblems)
+         */
+        struct state_t {
+            GRAD momentum, velocity;
+            size_t iter = 0;
+
+            /// @cite cereallib
+            template<class Archive> void serialize(Archive & archive)
+                {  archive( momentum, velocity, iter ); }
+        };
+
+
         /// variables to optimize
         parameter_t param;
         /// custom stopping criterion
         criterion_t criterion;
+        /// optional warm start; the moments are read at the start and written at the end of a run
+        std::shared_ptr<state_t> state;
+        /// optional statistics file; replaces the in-memory loss series if set
+        std::shared_ptr<statistics_sink_t<T>> sink;
 
         /**
          * @brief Default constructor.
@@ -123,7 +141,14 @@ namespace lipnet {
             GRAD gradient; metainfo_t<P> info;
             T fx; T fxl = std::numeric_limits<T>::max();
 
-            GRAD momentum, velocity;
+            GRAD momentum, velocity, direction;
+            size_t offset = 0;
+
+            if( state ) {
+                momentum = state->momentum;
+                velocity = state->velocity;
+                offset = state->iter;
+            }
 
             unpack( prob( x, info ) , gradient, fx );
             std::cout << "START => loss: " << fx
@@ -134,28 +159,30 @@ namespace lipnet {
             //std::cout << std::get<1>(gradient).weight << "\n";
             //std::cout << std::get<>(gradient).weight << "\n";
 
-            if constexpr ( stats_enabled )
+            if( sink ) (*sink)( offset, 0, fx );
+            else if constexpr ( stats_enabled )
                     stats.loss << fx;
 
             size_t i = 0; // norm_t<T,GRAD>::norm(gradient) > eps    //  (fxl-fx) > eps
             while( (abs(fxl-fx) > param.diff && norm_t<T,GRAD>::norm(gradient) > param.graddiff
                     && i++ < param.max_iter) && criterion(fx,x,gradient) ) {
 
-                momentum = param.beta1 * momentum + (1-param.beta1)*gradient;
-                velocity = param.beta2 * velocity + (1-param.beta2)*function_t<GRAD>::square(gradient);
-
-                GRAD t_momentum = (T(1)/(T(1)- std::pow(param.beta1,(T)i) )) * momentum;
-                GRAD t_velocity = (T(1)/(T(1)- std::pow(param.beta2,(T)i) )) * velocity;
+                update_t<T,GRAD>::scale_add( momentum, param.beta1, gradient, 1-param.beta1 );
+                update_t<T,GRAD>::scale_add_square( velocity, param.beta2, gradient, 1-param.beta2 );
 
+                // bias corrected direction
+                update_t<T,GRAD>::adam_direction( direction, momentum, velocity,
+                                T(1)/(T(1)- std::pow(param.beta1,(T)(i+offset)) ),
+                                T(1)/(T(1)- std::pow(param.beta2,(T)(i+offset)) ), param.eps );
 
-                auto tmp = param.eps + function_t<GRAD>::sqrt(t_velocity);
-                x -= param.alpha * t_momentum / tmp;
+                update_t<T,GRAD>::axpy( x, -param.alpha, direction );
 
 
                 fxl = fx;
                 unpack( prob( x, info ) , gradient, fx );
 
-                if constexpr ( stats_enabled )
+                if( sink ) (*sink)( i+offset, 0, fx, param.alpha );
+                else if constexpr ( stats_enabled )
                         stats.loss << fx;
 
                 if( i % 100 == 0) {
@@ -166,6 +193,14 @@ namespace lipnet {
             }
 
 
+            if( sink ) sink->flush();
+
+            if( state ) {
+                state->momentum = std::move( momentum );
+                state->velocity = std::move( velocity );
+                state->iter = offset + std::min( i, param.max_iter );
+            }
+
             unpack( prob( x, info ) , gradient, fx );
             std::cout << "END => loss: " << fx
                       << "     -- norm: "
@@ -81,6 +81,9 @@ namespace lipnet {
             T beta1;                /// adam meta parameter beta1 (default = 0.9)
             T beta2;                /// adam meta parameter beta2 (default = 0.999)
             T eps;                  /// numerical offset (default = 1e-8)
+
+            size_t lipschitz_every = 0; /// iterations between two lipschitz estimates of the problem (default = 0, disabled)
+            T lipschitz_stop = 0;       /// stop once the lipschitz estimate exceeds this value (default = 0, disabled)
         };
 
 
@@ -89,13 +92,17 @@ namespace lipnet {
         /// @cite cereallib
         struct statistics_t {
             series_t<T> loss;
+            series_t<T> lipschitz;
 
             template<class Archive> void serialize(Archive & archive)
-                {  archive( cereal::make_nvp("loss", loss) ); }
+                {  archive( cereal::make_nvp("loss", loss),
+                            cereal::make_nvp("lipschitz", lipschitz) ); }
         };
 
         /// variables to optimize
         parameter_t param;
+        /// optional statistics file; replaces the in-memory loss series if set
+        std::shared_ptr<statistics_sink_t<T>> sink;
 
 
         /**
@@ -121,35 +128,54 @@ namespace lipnet {
                                statistics_t, std::void_type >::type &stats ) const {
 
             GRAD gradient; T fx, fxl;
-            GRAD momentum, velocity;
+            GRAD momentum, velocity, direction;
             metainfo_t<P> info;
 
             T avglossdecrease = -1.0;
 
+            // cheap lipschitz estimate of the problem every lipschitz_every iterations
+            T estimate = 0; bool stop = false;
+            const auto track = [&]( const size_t it ) {
+                if constexpr ( lipschitz_estimate_helper::exists<P>::value ) {
+                    if( param.lipschitz_every == 0 || it % param.lipschitz_every != 0 ) return;
+
+                    estimate = prob.lipschitz_estimate( x, info );
+                    if constexpr ( stats_enabled )
+                        if( !sink ) stats.lipschitz << estimate;
+
+                    stop = param.lipschitz_stop > 0 && estimate > param.lipschitz_stop;
+                }
+            };
+
             unpack( prob( x, info ) , gradient, fx );
-            if constexpr ( stats_enabled )
+            track( 0 );
+            if( sink ) (*sink)( 0, 0, fx, 0, 0, estimate );
+            else if constexpr ( stats_enabled )
                     stats.loss << fx;
 
             size_t i = 0; fxl = std::numeric_limits<T>::max();
-            while( norm_t<T,GRAD>::norm(gradient) > param.eps && i++ < param.max_iter &&
+            while( !stop && norm_t<T,GRAD>::norm(gradient) > param.eps && i++ < param.max_iter &&
                    std::abs( fx - fxl ) > param.diff &&  avglossdecrease < param.threshold ) {
 
-                momentum = param.beta1 * momentum + (1-param.beta1)*gradient;
-                velocity = param.beta2 * velocity + (1-param.beta2)*function_t<GRAD>::square(gradient);
-
-                GRAD t_momentum = (T(1)/(T(1)- std::pow(param.beta1,(T)i) )) * momentum;
-                GRAD t_velocity = (T(1)/(T(1)- std::pow(param.beta2,(T)i) )) * velocity;
+                update_t<T,GRAD>::scale_add( momentum, param.beta1, gradient, 1-param.beta1 );
+                update_t<T,GRAD>::scale_add_square( velocity, param.beta2, gradient, 1-param.beta2 );
 
+                // bias corrected direction
+                update_t<T,GRAD>::adam_direction( direction, momentum, velocity,
+                                T(1)/(T(1)- std::pow(param.beta1,(T)i) ),
+                                T(1)/(T(1)- std::pow(param.beta2,(T)i) ), param.eps );
 
-                auto tmp = param.eps + function_t<GRAD>::sqrt(t_velocity);
+                update_t<T,GRAD>::axpy( x, -param.alpha, direction );
 
                 // projection
-                x = project( prob, x - param.alpha * t_momentum / tmp );
+                x = project( prob, std::move(x) );
 
 
                 fxl = fx;
                 unpack( prob( x, info ) , gradient, fx );
-                if constexpr ( stats_enabled )
+                track( i );
+                if( sink ) (*sink)( i, 0, fx, param.alpha, 0, estimate );
+                else if constexpr ( stats_enabled )
                         stats.loss << fx;
 
 
@@ -164,6 +190,11 @@ namespace lipnet {
                 }
             }
 
+            if( stop )
+                std::cout << " => lipschitz estimate " << estimate << " exceeds "
+                          << param.lipschitz_stop << ", stopping\n";
+            if( sink ) sink->flush();
+
             return std::make_tuple( std::move(x),  fx );
         }
 
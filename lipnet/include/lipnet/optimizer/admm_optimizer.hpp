@@ -29,12 +29,15 @@
 #include <initializer_list>
 #include <deque>
 #include <iostream>
+#include <future>
+#include <optional>
 
 #include <lipnet/traits.hpp>
 #include <lipnet/tensor.hpp>
 #include <lipnet/problem.hpp>
 #include <lipnet/variable.hpp>
 #include <lipnet/statistics.hpp>
+#include <lipnet/checkpoint.hpp>
 
 
 
@@ -71,37 +74,40 @@ namespace lipnet {
          * @brief optimize first subproblem. \f$ \arg \min_x  L_v(x,z^t,y^t) \f$
          * @cite boyd2011distributed
          * @param prob problem
+         * @param rho augmented lagrange multiplier parameter
          * @param x variable
          * @param z const variable
          * @param d dual variable
          * @return optimal point x
          */
-        inline X optimize1( const P &prob, const X &x, const Z &z, const DUAL &d) const {
-            return std::invoke( &P::optimize1, prob, param.rho, x, z, d);
+        inline X optimize1( const P &prob, const T rho, const X &x, const Z &z, const DUAL &d) const {
+            return std::invoke( &P::optimize1, prob, rho, x, z, d);
         }
 
         /**
          * @brief optimize second subproblem. \f$ \arg \min_z  L_v(x^{t+1},z,y^t) \f$
          * @cite boyd2011distributed
          * @param prob problem
+         * @param rho augmented lagrange multiplier parameter
          * @param x const variable
          * @param z variable
          * @param d dual variable
          * @return optimal point z
          */
-        inline Z optimize2( const P &prob, const X &x, const Z &z, const DUAL &d) const {
-            return std::invoke( &P::optimize2, prob, param.rho, x, z, d);
+        inline Z optimize2( const P &prob, const T rho, const X &x, const Z &z, const DUAL &d) const {
+            return std::invoke( &P::optimize2, prob, rho, x, z, d);
         }
 
         /**
          * @brief evaluate augmented lagrangian
          * @param prob problem
+         * @param rho augmented lagrange multiplier parameter
          * @param x variable
          * @param z variable
          * @return loss/objectiv
          */
-        inline T evaluate( const P &prob, const X &x, const Z &z) const {
-            return std::invoke( &P::loss, prob, param.rho, x, z);
+        inline T evaluate( const P &prob, const T rho, const X &x, const Z &z) const {
+            return std::invoke( &P::loss, prob, rho, x, z);
         }
 
 
@@ -110,6 +116,17 @@ namespace lipnet {
             size_t max_iter;    /// max iterations (default = 1e4)
             T rho;              /// admm hyperparameter (augmented lagrange multiplier parameter) (default = 2)
             T eps;              /// numerical offset (default = 1e-8)
+
+            T relaxation = 1.0; /// over-relaxation factor; 1 disables, 1.5 - 1.8 is typical (default = 1)
+            bool adaptive = false; /// residual balancing of rho (default = false)
+            T mu = 10.0;        /// residual balancing; maximal ratio of the residual norms (default = 10)
+            T tau = 2.0;        /// residual balancing; factor of rho (default = 2)
+            T eps_primal = 0;   /// stopping criterion primal residual norm; 0 disables (default = 0)
+            T eps_dual = 0;     /// stopping criterion dual residual norm; 0 disables (default = 0)
+
+            checkpoint_t checkpoint = {}; /// periodic checkpoints; resumed if the file exists (default = disabled)
+
+            bool asynchronous = false; /// evaluate the loss on another thread while the first subproblem of the next iteration is solved (default = false)
         };
 
 
@@ -118,9 +135,38 @@ namespace lipnet {
         /// @cite cereallib
         struct statistics_t {
             series_t<T> loss;
+            series_t<T> primal;
+            series_t<T> dual;
+            series_t<T> rho;
+
+            template<class Archive> void serialize(Archive & archive)
+                {  archive( cereal::make_nvp("loss", loss),
+                            cereal::make_nvp("primal-residual", primal),
+                            cereal::make_nvp("dual-residual", dual),
+                            cereal::make_nvp("rho", rho) ); }
+        };
+
+        /**
+         * @brief The state_t struct; full optimizer state between two iterations,
+         *          references to the variables of run and the persistent state of the
+         *          problem (e.g. the moments of the subproblem solver)
+         * @tparam STATS statistics holder or void_type
+         */
+
+        template<typename STATS>
+        struct state_t {
+            X &x; Z &z; DUAL &dual;
+            T &loss, &last, &rho;
+            size_t &i;
+            P &prob;
+            STATS &stats;
 
             template<class Archive> void serialize(Archive & archive)
-                {  archive( cereal::make_nvp("loss", loss) ); }
+                {  archive( x, z, dual, loss, last, rho, i );
+                   if constexpr ( persistent_state_helper::exists<P>::value )
+                       archive( prob.persistent_state() );
+                   if constexpr ( !std::is_same<STATS, std::void_type>::value )
+                       archive( stats ); }
         };
 
         /// variables to optimize
@@ -153,27 +199,91 @@ namespace lipnet {
 
             DUAL dualvariable;
             T loss, last = std::numeric_limits<T>::max();
+            T rho = param.rho;
 
             size_t i = 0;
+
+            typedef typename std::remove_reference<decltype(stats)>::type stats_t;
+            state_t<stats_t> state{ x, z, dualvariable, loss, last, rho, i, prob, stats };
+            param.checkpoint.load( "admm", state );
+
+            // first subproblem of the next iteration; solved during the asynchronous evaluation
+            std::optional<X> ahead;
+
             while( abs(loss-last) > param.eps && i < param.max_iter ) {
                 i++; last = loss;
 
                 // first step -> first subproblem
-                x = optimize1( prob, x, z, dualvariable);
-                
-                // second step -> second subproblem
-                z = optimize2( prob, x, z, dualvariable);
+                if( ahead ) { x = std::move( *ahead ); ahead.reset(); }
+                else x = optimize1( prob, rho, x, z, dualvariable);
+
+                // over-relaxation; only for the consensus constraint x = z
+                X xr = x;
+                if constexpr ( std::is_same<X,Z>::value )
+                    if( param.relaxation != T(1) )
+                        update_t<T,X>::scale_add( xr, param.relaxation, z, T(1) - param.relaxation );
 
-                loss = evaluate( prob, x, z);
-                if constexpr ( stats_enabled )
+                // second step -> second subproblem
+                Z zl = z;
+                z = optimize2( prob, rho, xr, z, dualvariable);
+
+                // the loss only decides the stopping criterion; off the critical path
+                std::future<T> evaluation;
+                if( param.asynchronous )
+                    evaluation = std::async( std::launch::async, [this, &prob, rho, x, z](){
+                        return evaluate( prob, rho, x, z); });
+                else
+                    loss = evaluate( prob, rho, x, z);
+
+                // third step
+                DUAL r = residual( prob, xr, z);
+                dualvariable += r;
+
+                // primal and dual residual
+                const T primal = norm_t<T,DUAL>::norm( residual( prob, x, z) );
+                const T dual = rho * norm_t<T,Z>::norm( z - zl );
+                const T rhoi = rho;
+
+                const bool converged = param.eps_primal > 0 && param.eps_dual > 0
+                        && primal < param.eps_primal && dual < param.eps_dual;
+
+                // residual balancing; the dual variable is scaled ( u = y / rho ), thus it
+                // is rescaled with rho_old / rho_new to keep the multiplier y
+                if( param.adaptive && !converged ) {
+                    if( primal > param.mu * dual ) rho *= param.tau;
+                    else if( dual > param.mu * primal ) rho /= param.tau;
+
+                    if( rho != rhoi )
+                        dualvariable = ( rhoi / rho ) * dualvariable;
+                }
+
+                // speculative first subproblem; discarded if the loss stops the iterations
+                if( param.asynchronous ) {
+                    if( !converged )
+                        ahead = optimize1( prob, rho, x, z, dualvariable);
+                    loss = evaluation.get();
+                }
+
+                if constexpr ( stats_enabled ) {
                     stats.loss << loss;
+                    stats.primal << primal; stats.dual << dual; stats.rho << rhoi; }
+
+                if ( i % 1 == 0) std::cout << "loss: " << loss << "  primal: " << primal
+                                           << "  dual: " << dual << "  rho: " << rhoi << "\n";
 
-                // third step 
-                dualvariable += residual( prob, x, z);
+                if( converged )
+                    break;
 
-                if ( i % 1 == 0) std::cout << "loss: " << loss << "\n";
+                if( param.checkpoint.due( i ) )
+                    param.checkpoint.save( "admm", state );
             }
 
+            // background work of the problem, e.g. the last diagnostic report
+            if constexpr ( finish_helper::exists<P>::value )
+                prob.finish();
+
+            param.checkpoint.clear();
+
             return std::make_tuple( std::move(x),  std::move(z),  loss );
         }
 
@@ -115,7 +115,7 @@ namespace lipnet {
             while( norm_t<T,GRAD>::norm(gradient) > param.eps ) {
                 i++;
 
-                x -= param.gamma * gradient;
+                update_t<T,GRAD>::axpy( x, -param.gamma, gradient );
                 unpack( prob( x, info ) , gradient, fx );
                 if constexpr ( stats_enabled )
                         stats.loss << fx;
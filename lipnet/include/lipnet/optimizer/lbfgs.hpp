@@ -0,0 +1,287 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_LBFGS_HPP__
+#define __LIPNET_LBFGS_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <iostream>
+#include <cmath>
+#include <limits>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+#include <lipnet/problem.hpp>
+#include <lipnet/variable.hpp>
+#include <lipnet/statistics.hpp>
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief Limited memory BFGS method with backtracking line search. The two loop
+     *        recursion runs on the flat parameter buffer of the variable (flat_t).
+     *
+     *        The line search requires deterministic values; problems on training data
+     *        are evaluated on the whole dataset (full_batch) during the run.
+     *
+     *        Barrier problems (barrier_value) follow the central path like
+     *        adam_barrier_t; the line search includes the barrier term and rejects
+     *        steps without a cholesky decomposition of chi (admissible) before the
+     *        gradient is evaluated.
+     *
+     * @tparam T numerical value type
+     * @tparam P problem type
+     * @tparam VAR variable type
+     * @tparam GRAD gradient type
+     * @cite liu1989limited
+     */
+
+    template<typename T, typename P, typename VAR, typename GRAD>
+    struct lbfgs_t_impl
+    {
+
+        inline void unpack( std::tuple<GRAD,T> &&t, GRAD &dx, T &fx) const {
+            dx = std::move( std::get<0>(t) );
+            fx = std::move( std::get<1>(t) );
+        }
+
+        static_assert ( flat_t<T,VAR>::size == flat_t<T,GRAD>::size,
+                            "variable and gradient have to be of the same size");
+
+        typedef blaze::DynamicVector<T, blaze::columnVector> vector_t;
+
+        static constexpr bool barrier = barrier_value_helper::exists<P>::value;
+
+
+        /**
+         * @brief The parameter_t struct; all meta parameters for optimisation
+         */
+
+        struct parameter_t {
+            size_t max_iter;        /// maximal iterations per central path step (default = 1e3)
+            size_t memory;          /// number of stored correction pairs (default = 10)
+            size_t cpsteps;         /// central path steps; barrier problems only (default = 5)
+            T eps;                  /// stopping criterion gradient norm (default = 1e-6)
+            T diff;                 /// stopping criterion relative objective decrease (default = 1e-10)
+            T gamma;                /// barrier factor (default = 1)
+            T gammadec;             /// barrier factor decrease per central path step (default = 0.5)
+
+            T c1 = 1e-4;            /// sufficient decrease constant of the armijo condition (default = 1e-4)
+            T backtrack = 0.5;      /// step decrease factor of the line search (default = 0.5)
+            size_t linesearch = 40; /// maximal line search steps (default = 40)
+        };
+
+
+        /// @brief problem specific implementation of statistics_t
+        /// @see lipnet statistics_t
+        /// @cite cereallib
+        struct statistics_t {
+            series_t<T> loss;
+            size_t evaluations = 0;
+
+            template<class Archive> void serialize(Archive & archive)
+                {  archive( cereal::make_nvp("loss", loss),
+                            cereal::make_nvp("evaluations", evaluations) ); }
+        };
+
+
+        /// variables to optimize
+        parameter_t param;
+
+        /**
+         * @brief Default constructor.
+         * @param hyperparameter of optimisation. Init hyperparameters with
+         *          (size_t) 1e3, (size_t) 10, (size_t) 5, 1e-6, 1e-10, 1.0, 0.5
+         *
+         */
+        explicit lbfgs_t_impl( parameter_t &&param
+                        = parameter_t{ (size_t) 1e3, (size_t) 10, (size_t) 5, 1e-6, 1e-10, 1.0, 0.5 } )
+            : param{ std::move(param) } { }
+
+
+        /**
+         * @brief The run method. Implementation of the optimisation algorithm.
+         * @tparam stats_enabled enable/disable logging
+         * @param prob problem
+         * @param x start variable / inital variable / start point
+         * @param stats statistics holder
+         * @cite nocedal2006numerical
+         */
+        template<bool stats_enabled = false>
+        inline std::tuple<VAR,T> run( P &prob, VAR&& x, typename std::conditional<stats_enabled,
+                               statistics_t, std::void_type >::type &stats ) const {
+
+            constexpr size_t n = flat_t<T,VAR>::size;
+
+            metainfo_t<P> info;
+            GRAD gradient; T fx = 0, merit = 0;
+            T gamma = param.gamma;
+            size_t evaluations = 0;
+
+            // the mini batches would change between the points of the line search
+            [[maybe_unused]] bool previous = false;
+            if constexpr ( full_batch_helper::exists<P>::value ) {
+                previous = prob.full_batch;
+                prob.full_batch = true;
+            }
+
+            // loss, gradient and objective of the line search at v; false if v is not
+            // in the domain of the barrier
+            const auto evaluate = [&]( const VAR &v ) -> bool {
+                evaluations++;
+
+                if constexpr ( barrier ) {
+                    if constexpr ( admissible_helper::exists<P>::value )
+                        if( !prob.admissible( v, info ) ) return false;
+
+                    try { unpack( prob( v, info, gamma ), gradient, fx ); }
+                    catch( const std::exception & ) { return false; }
+
+                    merit = fx + prob.barrier_value( v, info, gamma );
+                } else {
+                    unpack( prob( v, info ), gradient, fx );
+                    merit = fx;
+                }
+                return true;
+            };
+
+            vector_t xk( n ), xt( n ), gk( n ), gn( n ), q( n ), d( n );
+            std::deque<vector_t> S, Y; std::deque<T> R;
+            std::vector<T> a( param.memory );
+            VAR trial = x;
+
+            if( !evaluate( x ) ) {
+                if constexpr ( full_batch_helper::exists<P>::value )
+                    prob.full_batch = previous;
+                throw std::string{"l-bfgs: the start point is not feasible"};
+            }
+
+            const size_t cpsteps = barrier ? param.cpsteps : 1;
+            for( size_t j = 0; j < cpsteps; j++ ) {
+
+                // the barrier term changes with gamma; start with an empty memory
+                if( j > 0 ) {
+                    evaluate( x );
+                    S.clear(); Y.clear(); R.clear();
+                }
+
+                flat_t<T,VAR>::pack( x, xk.data() );
+                flat_t<T,GRAD>::pack( gradient, gk.data() );
+
+                if constexpr ( stats_enabled )
+                    stats.loss << fx;
+
+                size_t i = 0;
+                while( i++ < param.max_iter && blaze::norm( gk ) > param.eps ) {
+
+                    // two loop recursion; d = - H g
+                    q = gk;
+                    for( size_t k = S.size(); k-- > 0; ) {
+                        a[k] = R[k] * blaze::dot( S[k], q );
+                        q -= a[k] * Y[k];
+                    }
+
+                    const T scale = S.empty() ? std::min( T(1), T(1) / blaze::norm( gk ) )
+                                              : blaze::dot( S.back(), Y.back() ) / blaze::dot( Y.back(), Y.back() );
+                    d = scale * q;
+
+                    for( size_t k = 0; k < S.size(); k++ ) {
+                        const T b = R[k] * blaze::dot( Y[k], d );
+                        d += ( a[k] - b ) * S[k];
+                    }
+                    d = -d;
+
+                    T slope = blaze::dot( gk, d );
+                    if( !( slope < 0 ) ) {
+                        S.clear(); Y.clear(); R.clear();
+                        d = - std::min( T(1), T(1) / blaze::norm( gk ) ) * gk;
+                        slope = blaze::dot( gk, d );
+                    }
+
+                    // backtracking; armijo condition on the objective with barrier term
+                    const T f0 = merit;
+                    T step = 1; bool accepted = false;
+                    for( size_t ls = 0; ls < param.linesearch; ls++ ) {
+                        xt = xk + step * d;
+                        flat_t<T,VAR>::unpack( xt.data(), trial );
+                        if( evaluate( trial ) && merit <= f0 + param.c1 * step * slope ) {
+                            accepted = true; break; }
+                        step *= param.backtrack;
+                    }
+
+                    if( !accepted ) {
+                        // restore the state of x; a second failure ends the central path step
+                        evaluate( x );
+                        flat_t<T,GRAD>::pack( gradient, gk.data() );
+                        if( S.empty() ) break;
+                        S.clear(); Y.clear(); R.clear();
+                        continue;
+                    }
+
+                    std::swap( x, trial );
+                    flat_t<T,GRAD>::pack( gradient, gn.data() );
+
+                    // correction pair; skipped without positive curvature
+                    vector_t s = step * d, y = gn - gk;
+                    const T sy = blaze::dot( s, y );
+                    if( param.memory > 0 && sy > std::numeric_limits<T>::epsilon() * blaze::dot( y, y ) ) {
+                        if( S.size() == param.memory ) { S.pop_front(); Y.pop_front(); R.pop_front(); }
+                        S.push_back( std::move(s) ); Y.push_back( std::move(y) ); R.push_back( T(1) / sy );
+                    }
+
+                    xk = xt; gk = gn;
+
+                    if constexpr ( stats_enabled )
+                        stats.loss << fx;
+
+                    if( i % 100 == 0) {
+                        std::cout << " => (" << i << ") loss: " << fx  << "\n";
+                    }
+
+                    if( std::abs( f0 - merit ) <= param.diff * std::max( T(1), std::abs( merit ) ) )
+                        break;
+                }
+
+                gamma *= param.gammadec;
+            }
+
+            if constexpr ( stats_enabled )
+                stats.evaluations = evaluations;
+
+            if constexpr ( full_batch_helper::exists<P>::value )
+                prob.full_batch = previous;
+
+            return std::make_tuple( std::move(x),  fx );
+        }
+
+
+    };
+
+}
+
+#endif // __LIPNET_LBFGS_HPP__
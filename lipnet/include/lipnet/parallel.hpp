@@ -0,0 +1,256 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_PARALLEL_HPP__
+#define __LIPNET_PARALLEL_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include <blaze/Blaze.h>
+
+
+
+
+namespace lipnet {
+
+    /**
+     * @brief default number of worker threads; the number of hardware threads
+     *          unless changed by the caller
+     * @return reference to the setting
+     */
+
+    inline size_t& default_threads() {
+        static size_t threads = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+        return threads;
+    }
+
+
+    /**
+     * @brief The resources_t struct; execution resources of the process. The lipnet
+     *          workers, the blaze threads and the threads of every mosek model are
+     *          configured together, thus several processes per node do not
+     *          oversubscribe the cores. Zero keeps the default of the library.
+     */
+
+    struct resources_t {
+        size_t workers = 0;     /// lipnet worker threads, e.g. backpropagation (default = hardware threads)
+        size_t blaze = 0;       /// blaze threads (default = blaze default)
+        size_t solver = 0;      /// mosek threads per model (default = mosek decides)
+        int pin = -1;           /// first core of the process; the process is pinned to the
+                                /// following cores, one per thread of the largest pool (default = -1, disabled)
+
+        /// number of cores of the process
+        inline size_t cores() const {
+            return std::max( { workers > 0 ? workers : default_threads(), blaze, solver } );
+        }
+    };
+
+
+    /**
+     * @brief execution resources of the process; set by configure
+     * @return reference to the setting
+     */
+
+    inline resources_t& resources() {
+        static resources_t res;
+        return res;
+    }
+
+
+    /**
+     * @brief configure the execution resources; call before any thread or mosek
+     *          model is created, the affinity is inherited by new threads
+     * @param res execution resources
+     */
+
+    inline void configure( const resources_t &res ) {
+        resources() = res;
+
+        if( res.workers > 0 )
+            default_threads() = res.workers;
+
+        if( res.pin >= 0 ) {
+#ifdef __linux__
+            cpu_set_t set; CPU_ZERO( &set );
+            for( size_t c = 0; c < res.cores(); ++c )
+                CPU_SET( ( res.pin + c ) % std::max<size_t>( 1, std::thread::hardware_concurrency() ), &set );
+
+            if( sched_setaffinity( 0, sizeof( set ), &set ) != 0 )
+                throw std::string{"failed to pin the process to its cores"};
+#else
+            throw std::string{"pinning is only supported on linux"};
+#endif
+        }
+
+        // the blaze pool is started here; its threads inherit the affinity of the pinned thread
+        if( res.blaze > 0 )
+            blaze::setNumThreads( res.blaze );
+    }
+
+
+    /**
+     * @brief parallel_for function; split the range [0,n) in contiguous chunks,
+     *          one per thread. The first chunk is processed by the calling thread.
+     *          The partition only depends on n and threads, so results which are
+     *          accumulated per chunk are reproducible.
+     * @param n number of tasks
+     * @param threads number of threads
+     * @param f callable f( chunk, begin, end )
+     * @return number of chunks used
+     */
+
+    template<typename F>
+    size_t parallel_for( const size_t n, const size_t threads, F&& f ) {
+        const size_t P = std::max<size_t>( 1, std::min( threads, n ) );
+
+        if( P == 1 ) {
+            f( 0UL, 0UL, n );
+            return P;
+        }
+
+        std::vector<std::thread> pool; pool.reserve( P-1 );
+        std::vector<std::exception_ptr> errors( P );
+
+        auto task = [&]( const size_t p ) {
+            try { f( p, p*n/P, (p+1)*n/P ); }
+            catch( ... ) { errors[p] = std::current_exception(); }
+        };
+
+        for( size_t p = 1; p < P; p++ )
+            pool.emplace_back( task, p );
+
+        task( 0 );
+
+        for( auto &thread : pool )
+            thread.join();
+
+        for( auto &error : errors )
+            if( error ) std::rethrow_exception( error );
+
+        return P;
+    }
+
+
+    /**
+     * @brief tree_reduce function; pairwise reduction of the partial results in a
+     *          fixed order; the result is stored in the first element
+     * @param parts partial results
+     * @param op callable op( a, b ) accumulating b into a
+     */
+
+    template<typename V, typename OP>
+    void tree_reduce( std::vector<V> &parts, OP&& op ) {
+        for( size_t s = 1; s < parts.size(); s *= 2 )
+            for( size_t p = 0; p + s < parts.size(); p += 2*s )
+                op( parts[p], parts[p+s] );
+    }
+
+
+    /**
+     * @brief The worker_t struct; one persistent background thread which runs one
+     *          job at a time, e.g. the gathering of the next batch. Posting a job
+     *          does not start a thread; the errors of a job are rethrown by wait.
+     *          Only one thread posts and waits.
+     */
+
+    struct worker_t {
+
+        worker_t() : thread{ [this](){ loop(); } } {}
+
+        ~worker_t() {
+            { std::lock_guard<std::mutex> lock( mutex ); stop = true; }
+            signal.notify_all();
+            thread.join();
+        }
+
+        worker_t( const worker_t& ) = delete;
+        worker_t& operator=( const worker_t& ) = delete;
+
+        /**
+         * @brief run a job on the worker; the previous job has to be waited for
+         * @param f callable f()
+         */
+
+        void post( std::function<void()> f ) {
+            { std::lock_guard<std::mutex> lock( mutex ); job = std::move( f ); busy = true; }
+            posted = true;
+            signal.notify_all();
+        }
+
+        /// true if a job was posted and not waited for
+        inline bool pending() const { return posted; }
+
+        /// wait for the posted job; rethrows its error
+        void wait() {
+            std::unique_lock<std::mutex> lock( mutex );
+            signal.wait( lock, [this](){ return !busy; } );
+            posted = false;
+
+            if( error ) std::rethrow_exception( std::exchange( error, nullptr ) );
+        }
+
+    private:
+
+        void loop() {
+            std::unique_lock<std::mutex> lock( mutex );
+            for( ;; ) {
+                signal.wait( lock, [this](){ return stop || busy; } );
+                if( stop ) return;
+
+                std::function<void()> f = std::move( job );
+                lock.unlock();
+
+                std::exception_ptr e;
+                try { f(); }
+                catch( ... ) { e = std::current_exception(); }
+
+                lock.lock();
+                error = e; busy = false;
+                signal.notify_all();
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable signal;
+        std::function<void()> job;
+        std::exception_ptr error;
+        bool busy = false, stop = false, posted = false;
+
+        /// declared last; started after the state above is initialised
+        std::thread thread;
+    };
+
+}
+
+#endif // __LIPNET_PARALLEL_HPP__
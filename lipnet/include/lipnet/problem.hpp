@@ -69,6 +69,85 @@ namespace lipnet {
     };
 
 
+    /**
+     * @brief The lipschitz_estimate_helper struct. Detects problems which provide a
+     *        cheap lipschitz estimate ´lipschitz_estimate( var, info )´.
+     */
+    struct lipschitz_estimate_helper {
+        template<class P, class U = void>
+        struct exists { enum { value = 0 }; };
+
+        template<class P>
+        struct exists<P, std::void_t<decltype( &P::lipschitz_estimate )>> { enum { value = 1 }; };
+    };
+
+
+    /**
+     * @brief The admissible_helper struct. Detects problems which provide a cheap
+     *        feasibility oracle ´admissible( var, info )´ for backtracking.
+     */
+    struct admissible_helper {
+        template<class P, class U = void>
+        struct exists { enum { value = 0 }; };
+
+        template<class P>
+        struct exists<P, std::void_t<decltype( &P::admissible )>> { enum { value = 1 }; };
+    };
+
+
+    /**
+     * @brief The barrier_value_helper struct. Detects barrier problems which provide
+     *        the barrier term of the objective ´barrier_value( var, info, gamma )´.
+     */
+    struct barrier_value_helper {
+        template<class P, class U = void>
+        struct exists { enum { value = 0 }; };
+
+        template<class P>
+        struct exists<P, std::void_t<decltype( &P::barrier_value )>> { enum { value = 1 }; };
+    };
+
+
+    /**
+     * @brief The full_batch_helper struct. Detects problems on training data which can
+     *        evaluate the whole dataset instead of the next batch ´full_batch´.
+     */
+    struct full_batch_helper {
+        template<class P, class U = void>
+        struct exists { enum { value = 0 }; };
+
+        template<class P>
+        struct exists<P, std::void_t<decltype( &P::full_batch )>> { enum { value = 1 }; };
+    };
+
+
+    /**
+     * @brief The persistent_state_helper struct. Detects problems with state kept across
+     *        the iterations of the optimizer, e.g. the moments of a subproblem solver,
+     *        which belongs to a checkpoint ´persistent_state()´.
+     */
+    struct persistent_state_helper {
+        template<class P, class U = void>
+        struct exists { enum { value = 0 }; };
+
+        template<class P>
+        struct exists<P, std::void_t<decltype( &P::persistent_state )>> { enum { value = 1 }; };
+    };
+
+
+    /**
+     * @brief The finish_helper struct. Detects problems with background work which
+     *        is completed at the end of the run ´finish()´.
+     */
+    struct finish_helper {
+        template<class P, class U = void>
+        struct exists { enum { value = 0 }; };
+
+        template<class P>
+        struct exists<P, std::void_t<decltype( &P::finish )>> { enum { value = 1 }; };
+    };
+
+
     /**
      * @brief The linesearch_t struct. base linesearch struct (basically a placerholder class)
      * @tparam IMPL problem type
@@ -86,10 +86,10 @@ namespace lipnet {
         /// variable x
         const variable_t &weights_bar;
 
-        /// admm hyperparameter
-        const T rho;
+        /// admm hyperparameter; may change between admm iterations
+        T rho;
 
-        explicit network_problem_batch_admm_t( LOSS<T>&& l, network_data_t<T, at<0,N...>(), at<L::value,N...>() > &&data,
+        explicit network_problem_batch_admm_t( LOSS<T>&& l, shared_data_t<T, at<0,N...>(), at<L::value,N...>() > data,
                                                const T rho,  const variable_t &dualvariable, const variable_t &weights_bar )
             : self_back_t( std::move(l), std::move(data) ) , rho{rho},
               dualvariable{dualvariable}, weights_bar{weights_bar}  {}
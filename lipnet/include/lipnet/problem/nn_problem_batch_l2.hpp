@@ -85,7 +85,7 @@ namespace lipnet {
          */
 
         explicit network_problem_batch_l2_t(  LOSS<T>&& l,
-               network_data_t<T,at<0,N...>(), at<self_back_t::L::value,N...>() > &&data, const T rho = 1.0 )
+               shared_data_t<T,at<0,N...>(), at<self_back_t::L::value,N...>() > data, const T rho = 1.0 )
             : self_back_t( std::move(l), std::move(data) ), rho{ rho } { }
 
 
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_NETWORK_PROBLEM_DYNAMIC_BARRIER_HPP__
+#define __LIPNET_NETWORK_PROBLEM_DYNAMIC_BARRIER_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+#include <lipnet/problem.hpp>
+
+#include <lipnet/network/loss.hpp>
+#include <lipnet/network/activation.hpp>
+
+#include <lipnet/dynamic/network.hpp>
+#include <lipnet/dynamic/backpropagation.hpp>
+#include <lipnet/dynamic/barrier.hpp>
+
+
+namespace lipnet {
+
+
+    /**
+     * @brief The network_problem_dynamic_log_barrier_t struct. The problem implementation of
+     *        barrier neural network training in batches with a runtime topology.
+     *
+     *        @f[  \nabla_{W,b} \mathcal{L}(f_{W,b}) - \rho \log \det ( \chi(\Psi^2,W) ) @f]
+     *
+     * @tparam T Base numeric type (eg. double, float, ...).
+     * @tparam ATPYE Activation type of this neural network.
+     * @tparam LOSS Objectiv function type of this neural network
+     * @see network_problem_log_barrier_t
+     */
+
+    template<typename T, template<typename> typename ATYPE,
+             template<typename> typename LOSS>
+    struct network_problem_dynamic_log_barrier_t :
+            public dynamic_backpropagation_t<T, ATYPE, LOSS>,
+            public dynamic_barrierfunction_t<T>,
+            public problem_t< T, problem_type::NONLINEAR,
+                network_problem_dynamic_log_barrier_t<T,ATYPE,LOSS> > {
+
+
+        typedef dynamic_backpropagation_t<T, ATYPE, LOSS> self_back_t;
+        typedef dynamic_barrierfunction_t<T> self_barrier_t;
+
+
+        typedef typename self_barrier_t::variable_t variable_t;
+
+
+        struct metainfo_t : public self_back_t::metainfo_t {
+            using self_back_t::metainfo_t::metainfo_t;
+
+            /// barrier decomposition of the last iterate
+            typename self_barrier_t::cache_t barrier;
+        };
+
+        /**
+         * @brief The feasibility_t struct. Implementation of feasibility check
+         *          for this problem
+         * @see lipnet::dynamic_barrierfunction_t::maximal_step
+         */
+
+        struct feasibility_t {
+            const self_barrier_t *barrier = nullptr;
+            /// barrier cache of the metainfo; its position is the current iterate
+            const typename self_barrier_t::cache_t *iterate = nullptr;
+            T step, rho;
+
+            void init( const self_barrier_t *b, const T r, const typename self_barrier_t::cache_t &cache ) {
+                barrier = b; iterate = &cache; rho = r; }
+            void run( const variable_t& dir ) {
+                step = barrier->maximal_step( iterate->var, dir, rho );
+            }
+        };
+
+
+
+        /**
+         * @brief network_problem_dynamic_log_barrier_t; default constructor
+         * @param l loss object
+         * @param topo number of neurons at each layer; at least one hidden layer
+         * @param data training data
+         * @param lipschitz lipschitz constant
+         * @param batchsize batch size; zero means the whole dataset
+         */
+
+        network_problem_dynamic_log_barrier_t( LOSS<T>&& l, std::vector<size_t> topo,
+               dynamic_data_t<T> &&data, const T lipschitz = 70.0, const size_t batchsize = 0 )
+            : self_back_t( std::move(l), std::move(topo), std::move(data), batchsize ),
+              self_barrier_t( lipschitz ) {
+            if( this->topology.size() < 3 )
+                throw std::string{"barrier training needs at least one hidden layer"};
+        }
+
+
+
+        /**
+         * @brief compute gradients
+         * @param var variable
+         * @param info metainfo
+         * @param line feasibility check
+         * @param gamma hyperparameter
+         * @return gradients
+         * @see run
+         */
+
+        std::tuple<variable_t,T> operator()( const variable_t& var, metainfo_t &info,
+                                             feasibility_t &line, T &gamma) const {
+            return run<true, true>( var, info, line, gamma );
+        }
+
+        /**
+         * @see run
+         */
+
+        std::tuple<variable_t,T> operator()( const variable_t& var, metainfo_t &info,
+                                             feasibility_t &line ) const {
+            std::void_type void_obj;
+            return run<true, false>( var, info, line, void_obj );
+        }
+
+        /**
+         * @see run
+         */
+
+        std::tuple<variable_t,T> operator()( const variable_t& var, metainfo_t &info,
+                                             const T &gamma ) const {
+            std::void_type void_obj;
+            return run<false, true>( var, info, void_obj, gamma );
+        }
+
+        /**
+         * @see run
+         */
+
+        std::tuple<variable_t,T> operator()( const variable_t& var, metainfo_t &info ) const {
+            std::void_type void_obj;
+            return run<false,false>( var, info, void_obj, void_obj );
+        }
+
+
+
+
+
+        /**
+         * @brief compute gradient of objectiv function
+         * @tparam feasibility_enabled enable/disable feasibility checking
+         * @tparam gamma_enabled enable/disable set init hyperparameter gamma
+         * @param var variable
+         * @param info metainfo
+         * @param line feasibility check
+         * @param level hyperparameter
+         * @return gradients
+         */
+
+        template<bool feasibility_enabled = false, bool gamma_enabled = false>
+        inline std::tuple<variable_t,T> run( const variable_t& var, metainfo_t &info,
+                  typename std::conditional<feasibility_enabled, feasibility_t, std::void_type >::type &feasibility,
+                  typename std::conditional<gamma_enabled, T, std::void_type >::type level ) const {
+            variable_t gradient = generator_t<variable_t>::make( this->topology, T(0), T(0) );
+            T objective = 0;
+
+            T gamma = 1.0;
+            if constexpr ( gamma_enabled )
+                gamma = level;
+
+            // compute gradient
+            std::invoke( &self_back_t::run, *this, var.W , info, gradient.W , objective);
+            self_barrier_t::compute( var, gradient, gamma, info.barrier );
+
+            // prepare feasibility checking; the barrier cache holds var, no copy of the iterate
+            if constexpr ( feasibility_enabled )
+                    feasibility.init( this, std::pow( std::invoke(&self_barrier_t::lipschitz, *this ) , 2), info.barrier );
+
+            return std::make_tuple( std::move(gradient) ,
+                                    std::move(objective) );
+        }
+
+
+    };
+
+}
+
+#endif // __LIPNET_NETWORK_PROBLEM_DYNAMIC_BARRIER_HPP__
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_NETWORK_PROBLEM_DYNAMIC_BATCH_HPP__
+#define __LIPNET_NETWORK_PROBLEM_DYNAMIC_BATCH_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+
+#include <lipnet/traits.hpp>
+#include <lipnet/tensor.hpp>
+#include <lipnet/problem.hpp>
+
+#include <lipnet/network/loss.hpp>
+#include <lipnet/network/activation.hpp>
+
+#include <lipnet/dynamic/network.hpp>
+#include <lipnet/dynamic/backpropagation.hpp>
+
+namespace lipnet {
+
+
+
+    /**
+     * @brief The network_problem_dynamic_batch_t struct. The problem implementation of nominal
+     *        neural network training in batches with a runtime topology.
+     *
+     *         @f[ \nabla_{W,b} \mathcal{L}(f_{W,b}) @f]
+     *
+     * @tparam T Base numeric type (eg. double, float, ...).
+     * @tparam ATPYE Activation type of this neural network.
+     * @tparam LOSS Objectiv function type of this neural network
+     * @see network_problem_batch_t
+     */
+
+    template<typename T, template<typename> typename ATYPE,
+             template<typename> typename LOSS>
+    struct network_problem_dynamic_batch_t :
+            public dynamic_backpropagation_t<T, ATYPE, LOSS>,
+            public problem_t< T, problem_type::NONLINEAR, network_problem_dynamic_batch_t<T,ATYPE,LOSS>,
+                dynamic_weights_t<T>, dynamic_weights_t<T> > {
+
+        typedef dynamic_backpropagation_t<T, ATYPE, LOSS> self_back_t;
+        typedef typename self_back_t::variable_t variable_t;
+
+        using self_back_t::dynamic_backpropagation_t;
+
+
+        struct metainfo_t : public self_back_t::metainfo_t {
+            using self_back_t::metainfo_t::metainfo_t;
+        };
+
+
+
+        /**
+         * @brief The operator () function. compute gradient
+         * @param var current position
+         * @return gradient and loss at specified position
+         */
+
+        std::tuple<variable_t,T> operator()( const variable_t& var, metainfo_t &info ) const {
+
+            variable_t gradient = generator_t<variable_t>::make( this->topology, T(0) );
+            T objective = 0;
+
+            std::invoke( &self_back_t::run, *this, var , info, gradient , objective);
+
+            return std::make_tuple( std::move(gradient) ,
+                                    std::move(objective) );
+        }
+
+    };
+
+}
+
+#endif // __LIPNET_NETWORK_PROBLEM_DYNAMIC_BATCH_HPP__
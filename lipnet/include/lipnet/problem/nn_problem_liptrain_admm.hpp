@@ -28,6 +28,7 @@
 #include <utility>
 #include <initializer_list>
 #include <deque>
+#include <future>
 
 #include <lipnet/traits.hpp>
 #include <lipnet/tensor.hpp>
@@ -88,21 +89,62 @@ namespace lipnet {
 
         typedef typename network_t<T,ATYPE, N...>::layer_t variable_t;
 
+        typedef network_problem_batch_admm_t<T, ATYPE, LOSS, BATCH, N...> subproblem_t;
+        typedef adam_momentum_t<T, subproblem_t, typename subproblem_t::variable_t,
+                        typename subproblem_t::variable_t> subsolver_t;
+
+
+        /**
+         * @brief The subproblem_state_t struct; first subproblem and its solver, kept
+         *          across admm iterations. The subproblem owns the training data and
+         *          refers to the dual and second variable of this struct
+         */
+
+        struct subproblem_state_t {
+            variable_t dvar, varbar;
+            subproblem_t prob;
+            subsolver_t solver;
+
+            subproblem_state_t( network_data_t<T, at<0,N...>(), at<L::value,N...>() > &&data )
+                : prob( LOSS<T>{}, std::move(data), T(0), dvar, varbar ),
+                  solver( typename subsolver_t::parameter_t{
+                        (size_t) 5e3, 1e-6, 1e-4, 0.02, 0.9, 0.999, 1e-8 } ) {
+                solver.state = std::make_shared<typename subsolver_t::state_t>();
+            }
+        };
+
 
-        network_data_t<T, at<0,N...>(), at<L::value,N...>() > training_data;
         const T lipschitz;
 
+        /// first subproblem; shared by copies of this problem
+        std::shared_ptr<subproblem_state_t> subproblem;
+
+        /// persistent sdp model for the lipschitz certificate
+        std::shared_ptr<network_libcalc_t<T, N...>> certificate;
+
+        /// print the lipschitz constant before and after the second subproblem; solved
+        /// asynchronously with a separate sdp model (default = true)
+        bool diagnostics = true;
+
+        /// sdp model and pending job of the diagnostics
+        std::shared_ptr<network_libcalc_t<T, N...>> diagnostic;
+        std::shared_ptr<std::future<void>> pending;
+
+
         /**
          * @brief network_problem_liptrain_enforcing_adam_t; default constructor
          * @param data training data
          * @param lip lipschitz constant
          */
 
-        explicit network_problem_liptrain_enforcing_adam_t( const network_data_t<T,
+        explicit network_problem_liptrain_enforcing_adam_t( network_data_t<T,
                               at<0,N...>(), at<L::value,N...>() > &&data, const T lip = 70.0 )
 
-            : training_data { std::move(data) },
-              lipschitz{ std::move(lip) } {  }
+            : lipschitz{ std::move(lip) },
+              subproblem{ std::make_shared<subproblem_state_t>( std::move(data) ) },
+              certificate{ std::make_shared<network_libcalc_t<T, N...>>() },
+              diagnostic{ std::make_shared<network_libcalc_t<T, N...>>() },
+              pending{ std::make_shared<std::future<void>>() } {  }
 
         /**
          * @brief The residual method; compute residual
@@ -131,19 +173,12 @@ namespace lipnet {
         variable_t optimize1( const T rho, const variable_t &var,
                               const variable_t &varbar, const variable_t &dvar) const {
 
-            typedef network_problem_batch_admm_t<T, ATYPE, LOSS, BATCH, N...> problem_t ;
-
-            network_data_t<T, at<0,N...>(), at<L::value,N...>() > dd = training_data;
-            problem_t prob( LOSS<T>{} , std::move(dd), rho, dvar, varbar );
+            auto &state = *subproblem;
+            state.dvar = dvar; state.varbar = varbar;
+            state.prob.rho = rho;
 
-            typedef adam_momentum_t<T, problem_t, typename problem_t::variable_t,
-                            typename problem_t::variable_t> subsolver_t;
-
-            subsolver_t solver(  typename subsolver_t::parameter_t{
-                 (size_t) 5e3, 1e-6, 1e-4, 0.02, 0.9, 0.999, 1e-8 } );
-
-            typename problem_t::variable_t init = var;
-            auto [ weights, l ] = solver( prob, std::move( init ) );
+            typename subproblem_t::variable_t init = var;
+            auto [ weights, l ] = state.solver( state.prob, std::move( init ) );
 
             return std::move( weights );
         }
@@ -165,16 +200,55 @@ namespace lipnet {
         variable_t optimize2( const T rho, const variable_t &var,
                               const variable_t &varbar, const variable_t &dvar) const {
 
-            auto [ lip, tparam ] = network_libcalc_t<T, N...>::solve( var );
             auto weights =  network_libtrain_enforcing_t<T, N...>::train( lipschitz, rho, var,
                     blaze::uniform( sum<L::value,N...>()-at<0,N...>() , 1e4 ) , dvar );
-            auto [ k2, mmmm ] = network_libcalc_t<T, N...>::solve( weights );
 
-            std::cout << " =================> LIPSCHITZ: real: " << lip << " <-> sub: " << k2 << "\n";
+            if( diagnostics )
+                report( var, weights );
+
             return std::move( weights );
         }
 
 
+        /**
+         * @brief print the lipschitz constant of both variables; runs on another
+         *          thread, the previous report is finished first and its errors
+         *          (e.g. of the mosek solve) are rethrown here
+         * @param var first variable
+         * @param weights second variable
+         */
+
+        void report( const variable_t &var, const variable_t &weights ) const {
+            if( pending->valid() ) pending->get();
+
+            *pending = std::async( std::launch::async, [calc = diagnostic, var, weights](){
+                auto [ lip, tparam ] = calc->compute( var );
+                auto [ k2, mmmm ] = calc->compute( weights );
+
+                std::cout << " =================> LIPSCHITZ: real: " << lip << " <-> sub: " << k2 << "\n";
+            });
+        }
+
+        /**
+         * @brief adam moments of the first subproblem; part of the admm checkpoint
+         * @return state of the subproblem solver
+         */
+
+        typename subsolver_t::state_t& persistent_state() const {
+            return *subproblem->solver.state;
+        }
+
+        /**
+         * @brief finish the last report; its errors are rethrown here. Called by the
+         *          admm optimizer at the end of the run
+         * @see report
+         */
+
+        void finish() const {
+            if( pending->valid() ) pending->get();
+        }
+
+
         /**
          * @brief compute lipschitz constant; mosek; interior point method;
          * @param rho admm hyperparameter; augmented lagrange multiplier
@@ -184,7 +258,7 @@ namespace lipnet {
          */
 
         T loss( const T rho, const variable_t &var, const variable_t &varbar ) const {
-            auto [ lip, tparam ] = network_libcalc_t<T, N...>::solve( var );
+            auto [ lip, tparam ] = certificate->compute( var );
             return lip;
         }
 
@@ -43,6 +43,7 @@
 #include <lipnet/lipschitz/topology.hpp>
 #include <lipnet/lipschitz/barrier.hpp>
 #include <lipnet/lipschitz/feasibility.hpp>
+#include <lipnet/lipschitz/spectral.hpp>
 
 
 namespace lipnet {
@@ -94,6 +95,26 @@ namespace lipnet {
 
         struct metainfo_t : public self_back_t::metainfo_t {
             using self_back_t::metainfo_t::metainfo_t;
+
+            /// barrier decomposition of the last iterate
+            typename self_barrier_t::cache_t barrier;
+
+            /// singular vectors of the lipschitz estimate
+            spectral_estimator_t<T, N...> spectral;
+
+            /// sampler state of the base and the singular vectors; a cached
+            /// decomposition is recomputed after a resume
+            /// @cite cereallib
+            template<class Archive> void save( Archive & archive ) const {
+                self_back_t::metainfo_t::save( archive );
+                archive( spectral );
+            }
+
+            /// @see save
+            template<class Archive> void load( Archive & archive ) {
+                self_back_t::metainfo_t::load( archive );
+                archive( spectral );
+            }
         };
 
         /**
@@ -103,11 +124,19 @@ namespace lipnet {
          */
 
         struct feasibility_t : public feasibilitycheck_t<T,N...> {
-            variable_t pos; T step, rho;
-
-            void init( const T r, const variable_t &p ) {  pos = p; rho = r; }
+            /// barrier cache of the metainfo; its position is the current iterate
+            const typename self_barrier_t::cache_t *iterate = nullptr;
+            /// ranks of a data parallel run; the step of the root rank is used
+            const communicator_t *comm = nullptr;
+            T step, rho;
+
+            void init( const T r, const typename self_barrier_t::cache_t &cache,
+                       const communicator_t *c = nullptr ) {
+                iterate = &cache; rho = r; comm = c; }
             void run( const variable_t& dir ) {
-                step = std::invoke( &feasibilitycheck_t<T,N...>::compute,  *this, pos , dir, rho );
+                if( !comm || comm->root() )
+                    step = std::invoke( &feasibilitycheck_t<T,N...>::compute,  *this, iterate->var , dir, rho );
+                if( comm ) step = comm->broadcast_value( step );
             }
         };
 
@@ -121,7 +150,7 @@ namespace lipnet {
          */
 
         explicit network_problem_log_barrier_t(  LOSS<T>&& l,
-               network_data_t<T,at<0,N...>(), at<L::value,N...>() > &&data,
+               shared_data_t<T,at<0,N...>(), at<L::value,N...>() > data,
                const T lipschitz = 70.0 )
             : self_back_t( std::move(l), std::move(data) ),
               self_barrier_t( lipschitz ) { }
@@ -180,6 +209,54 @@ namespace lipnet {
             return run<false,false>( var, info, void_obj, void_obj );
         }
 
+        /**
+         * @brief cheap estimate of the product of the spectral norms; the power
+         *          iteration continues from the singular vectors kept in info
+         * @param var variable
+         * @param info metainfo
+         * @see lipnet::spectral_estimator_t
+         */
+
+        T lipschitz_estimate( const variable_t& var, metainfo_t &info ) const {
+            return info.spectral.update( var.W );
+        }
+
+        /**
+         * @brief feasibility oracle of the backtracking; a trial position is admissible
+         *          if chi has a cholesky decomposition. The decomposition is kept in
+         *          info and reused by the gradient of the accepted position.
+         * @param var trial position
+         * @param info metainfo
+         * @see barrierfunction_t::try_factorise
+         */
+
+        bool admissible( const variable_t& var, metainfo_t &info ) const {
+            if( !self_back_t::comm )
+                return self_barrier_t::try_factorise( self_barrier_t::lipschitz, var, info.barrier );
+
+            bool res = true;
+            if( self_back_t::comm->root() )
+                res = self_barrier_t::try_factorise( self_barrier_t::lipschitz, var, info.barrier );
+            return self_back_t::comm->broadcast_value( res );
+        }
+
+        /**
+         * @brief barrier term -gamma log det chi of the objective; the loss returned
+         *          by the gradient excludes it. Reuses the decomposition of info.
+         * @param var variable
+         * @param info metainfo
+         * @param gamma hyperparameter of barrier function
+         */
+
+        T barrier_value( const variable_t& var, metainfo_t &info, const T gamma ) const {
+            T value = 0;
+            if( !self_back_t::comm || self_back_t::comm->root() ) {
+                self_barrier_t::factorise( self_barrier_t::lipschitz, var, info.barrier );
+                value = -gamma * self_barrier_t::logdet( info.barrier.L );
+            }
+            return self_back_t::comm ? self_back_t::comm->broadcast_value( value ) : value;
+        }
+
 
 
 
@@ -212,13 +289,19 @@ namespace lipnet {
             if constexpr ( gamma_enabled )
                 gamma = level;
 
-            // compute gradient
+            // compute gradient; the loss gradient is averaged over the ranks, the barrier
+            // term is computed once on the root rank and the sum is broadcast
             std::invoke( &self_back_t::run, *this, var.W , info, gradient.W , objective);
-            std::invoke( &self_barrier_t::compute, *this, var, gradient, gamma );
 
-            // prepare feasibility checking
+            const communicator_t *comm = self_back_t::comm.get();
+            if( !comm || comm->root() )
+                self_barrier_t::compute( var, gradient, gamma, info.barrier );
+            if( comm )
+                comm->broadcast<T>( gradient );
+
+            // prepare feasibility checking; the barrier cache holds var, no copy of the iterate
             if constexpr ( feasibility_enabled )
-                    feasibility.init( std::pow( std::invoke(&self_barrier_t::lipschitz, *this ) , 2), var );
+                    feasibility.init( std::pow( std::invoke(&self_barrier_t::lipschitz, *this ) , 2), info.barrier, comm );
 
             return std::make_tuple( std::move(gradient) ,
                                     std::move(objective) );
@@ -44,6 +44,7 @@
 #include <lipnet/lipschitz/topology.hpp>
 #include <lipnet/lipschitz/barrier_wot.hpp>
 #include <lipnet/lipschitz/feasibility.hpp>
+#include <lipnet/lipschitz/spectral.hpp>
 
 
 
@@ -96,6 +97,22 @@ namespace lipnet {
 
         struct metainfo_t : public self_back_t::metainfo_t {
             using self_back_t::metainfo_t::metainfo_t;
+
+            /// singular vectors of the lipschitz estimate
+            spectral_estimator_t<T, N...> spectral;
+
+            /// sampler state of the base and the singular vectors
+            /// @cite cereallib
+            template<class Archive> void save( Archive & archive ) const {
+                self_back_t::metainfo_t::save( archive );
+                archive( spectral );
+            }
+
+            /// @see save
+            template<class Archive> void load( Archive & archive ) {
+                self_back_t::metainfo_t::load( archive );
+                archive( spectral );
+            }
         };
 
 
@@ -106,18 +123,18 @@ namespace lipnet {
          */
 
         struct feasibility_t : public feasibilitycheck_wot_t<T,N...> {
-            typename self_barrier_t::cholesky_t L; T step;
+            variable_t pos; T step, lipschitz;
             std::optional<std::reference_wrapper<const typename self_barrier_t::tparam_t>> Tparam;
 
-            void init( typename self_barrier_t::cholesky_t &&l,
+            void init( const T l, const variable_t &p,
                        const typename self_barrier_t::tparam_t &t) {
-                L = std::move(l); Tparam = std::cref(t);
+                pos = p; lipschitz = l; Tparam = std::cref(t);
             }
 
 
             void run( const variable_t& dir ) {
                 step = std::invoke( &feasibilitycheck_wot_t<T,N...>::compute,
-                                    *this, Tparam.value().get(), L, dir );
+                                    *this, Tparam.value().get(), lipschitz, pos, dir );
             }
         };
 
@@ -131,7 +148,7 @@ namespace lipnet {
          */
 
         explicit network_problem_log_barrier_wot_t(
-                LOSS<T>&& l, network_data_t<T,at<0,N...>(), at<L::value,N...>() > &&data,
+                LOSS<T>&& l, shared_data_t<T,at<0,N...>(), at<L::value,N...>() > data,
                 param_t&& tparam,  const T lipschitz = 70.0 )
             : self_back_t( std::move(l), std::move(data) ),
               self_barrier_t( std::move(tparam) , lipschitz ){ }
@@ -190,6 +207,18 @@ namespace lipnet {
             return run<false,false>( var, info, void_obj, void_obj );
         }
 
+        /**
+         * @brief cheap estimate of the product of the spectral norms; the power
+         *          iteration continues from the singular vectors kept in info
+         * @param var variable
+         * @param info metainfo
+         * @see lipnet::spectral_estimator_t
+         */
+
+        T lipschitz_estimate( const variable_t& var, metainfo_t &info ) const {
+            return info.spectral.update( var );
+        }
+
 
 
 
@@ -231,7 +260,8 @@ namespace lipnet {
 
             // prepare feasibility check
             if constexpr ( feasibility_enabled )
-                    feasibility.init( std::move(L),  std::invoke( &self_barrier_t::tparam, *this ) );
+                    feasibility.init( std::invoke( &self_barrier_t::lipschitz, *this ), var,
+                                      std::invoke( &self_barrier_t::tparam, *this ) );
 
             return std::make_tuple( std::move(gradient) ,
                                     std::move(objective) );
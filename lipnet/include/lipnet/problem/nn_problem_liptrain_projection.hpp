@@ -44,6 +44,9 @@
 #include <lipnet/lipschitz/structure.hpp>
 #include <lipnet/lipschitz/topology.hpp>
 
+#include <lipnet/lipschitz/projection.hpp>
+#include <lipnet/lipschitz/spectral.hpp>
+
 #include <lipnet/extern/mosek_projection_wot.hpp>
 
 
@@ -52,7 +55,7 @@ namespace lipnet {
 
 
     /**
-     * @brief The network_problem_projection_t struct. The problem implementation of projected neural
+     * @brief The network_problem_projection_policy_t struct. The problem implementation of projected neural
      *        network training in batches.
      *
      *        @f[  \nabla_{W,b} \mathcal{L}(f_{W,b}) @f]
@@ -60,6 +63,7 @@ namespace lipnet {
      * @tparam T Base numeric type (eg. double, float, ...).
      * @tparam ATPYE Activation type of this neural network.
      * @tparam LOSS Objectiv function type of this neural network
+     * @tparam PROJECTION Projection engine (mosek_projection_wot_t or first_order_projection_t).
      * @tparam BATCH Const integer value specifying the batch size.
      * @tparam N Neural network topology. Array of postive integer values specifying the
      *         number of neurons at each layer.
@@ -67,10 +71,12 @@ namespace lipnet {
      */
 
     template<typename T, template<typename> typename ATYPE,
-             template<typename> typename LOSS, size_t BATCH, size_t ...N>
-    struct network_problem_projection_t :
+             template<typename> typename LOSS,
+             template<typename, size_t...> typename PROJECTION, size_t BATCH, size_t ...N>
+    struct network_problem_projection_policy_t :
             public backpropagation_batch_t<T, ATYPE, LOSS, BATCH, N...>,
-            public problem_t< T, problem_type::NONLINEAR, network_problem_projection_t<T,ATYPE,LOSS,N...> > {
+            public problem_t< T, problem_type::NONLINEAR,
+                network_problem_projection_policy_t<T,ATYPE,LOSS,PROJECTION,N...> > {
 
 
         template<size_t NN>
@@ -92,24 +98,45 @@ namespace lipnet {
 
         struct metainfo_t : public self_back_t::metainfo_t {
             using self_back_t::metainfo_t::metainfo_t;
+
+            /// singular vectors of the lipschitz estimate
+            spectral_estimator_t<T, N...> spectral;
+
+            /// sampler state of the base and the singular vectors
+            /// @cite cereallib
+            template<class Archive> void save( Archive & archive ) const {
+                self_back_t::metainfo_t::save( archive );
+                archive( spectral );
+            }
+
+            /// @see save
+            template<class Archive> void load( Archive & archive ) {
+                self_back_t::metainfo_t::load( archive );
+                archive( spectral );
+            }
         };
 
 
-        T lipschitz, tparaminit ;
+        /// constraints of the projection; fixed, the projector is built from them
+        const T lipschitz, tparaminit ;
+
+        /// persistent projection model
+        std::shared_ptr<PROJECTION<T,N...>> projector;
 
         /**
-         * @brief network_problem_projection_t; default constructor
+         * @brief network_problem_projection_policy_t; default constructor
          * @param l loss object
          * @param data tarining data
          * @param lip lipschitz constant
          * @param tparam T hyperparameter from \f$ \chi(\Psi^2,W) \f$
          */
 
-        explicit network_problem_projection_t( LOSS<T>&& l,
-                network_data_t<T, at<0,N...>(), at<L::value,N...>() > &&data,
+        explicit network_problem_projection_policy_t( LOSS<T>&& l,
+                shared_data_t<T, at<0,N...>(), at<L::value,N...>() > data,
                           const T &lip = 70.0, const T &tparam = 100.0 )
             : self_back_t( std::move(l) , std::move(data) ),
-              lipschitz{ lip }, tparaminit{ tparam }  { }
+              lipschitz{ lip }, tparaminit{ tparam },
+              projector{ std::make_shared<PROJECTION<T,N...>>( lip, tparam ) }  { }
 
 
 
@@ -135,6 +162,18 @@ namespace lipnet {
                                     std::move(objective) );
         }
 
+        /**
+         * @brief cheap estimate of the product of the spectral norms; the power
+         *          iteration continues from the singular vectors kept in info
+         * @param var variable
+         * @param info metainfo
+         * @see lipnet::spectral_estimator_t
+         */
+
+        T lipschitz_estimate( const variable_t& var, metainfo_t &info ) const {
+            return info.spectral.update( var );
+        }
+
 
 
 
@@ -143,17 +182,38 @@ namespace lipnet {
          * @brief The projection method. Compute projection
          *          @f[  \min || W - \tilde{W} ||^2 \quad \mathrm{s.t} \quad \chi(\Psi^2,W) \succeq 0 @f]
          * @see lipnet::mosek_projection_wot_t
+         * @see lipnet::first_order_projection_t
          */
 
           variable_t projection(variable_t &&var) const {
-              auto res = mosek_projection_wot_t<T,N...>::projection(
-                                lipschitz, std::move(var), tparaminit );
+              auto res = projector->project( std::move(var) );
               return std::move( res );
           }
 
 
     };
 
+
+    /**
+     * @brief projected training with the conic projection (mosek)
+     * @see network_problem_projection_policy_t
+     */
+
+    template<typename T, template<typename> typename ATYPE,
+             template<typename> typename LOSS, size_t BATCH, size_t ...N>
+    using network_problem_projection_t = network_problem_projection_policy_t<T, ATYPE, LOSS,
+                mosek_projection_wot_t, BATCH, N...>;
+
+    /**
+     * @brief projected training with the first order projection; no mosek license needed
+     * @see network_problem_projection_policy_t
+     */
+
+    template<typename T, template<typename> typename ATYPE,
+             template<typename> typename LOSS, size_t BATCH, size_t ...N>
+    using network_problem_projection_fo_t = network_problem_projection_policy_t<T, ATYPE, LOSS,
+                first_order_projection_t, BATCH, N...>;
+
 }
 
 #endif // __LIPNET_NETWORK_PROBLEM_PROJECTION_HPP__
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_PROFILE_HPP__
+#define __LIPNET_PROFILE_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#include <cereal/cereal.hpp>
+
+
+
+namespace lipnet {
+
+    /// instrumented phases
+    enum class phase_t : size_t { FORWARD = 0, BACKWARD, CHOL, INV, TERMS, FEASIBILITY, SDP, COUNT };
+
+    /// name of a phase in the statistics
+    inline const char* phase_name( const phase_t p ) {
+        constexpr std::array<const char*, size_t(phase_t::COUNT)> names = {
+            "forward", "backward", "chol", "inv", "terms", "feasibility", "sdp" };
+        return names[ size_t(p) ];
+    }
+
+
+    /**
+     * @brief The profile_statistics_t struct; wall time and number of calls of every
+     *          phase, e.g. the difference of two snapshots of profile_t
+     */
+
+    struct profile_statistics_t {
+        std::array<uint64_t, size_t(phase_t::COUNT)> nanoseconds{}, calls{};
+
+        profile_statistics_t operator-( const profile_statistics_t &o ) const {
+            profile_statistics_t res;
+            for( size_t p = 0; p < size_t(phase_t::COUNT); ++p ) {
+                res.nanoseconds[p] = nanoseconds[p] - o.nanoseconds[p];
+                res.calls[p] = calls[p] - o.calls[p];
+            }
+            return res;
+        }
+
+        /// print one line per phase which was called
+        void print( std::ostream &os ) const {
+            for( size_t p = 0; p < size_t(phase_t::COUNT); ++p )
+                if( calls[p] > 0 )
+                    os << "   " << phase_name( phase_t(p) ) << ": " << nanoseconds[p] / 1e6
+                       << " ms in " << calls[p] << " calls\n";
+        }
+
+        template<class Archive> void save( Archive & archive ) const {
+            for( size_t p = 0; p < size_t(phase_t::COUNT); ++p )
+                archive( cereal::make_nvp( std::string( phase_name( phase_t(p) ) ) + "-ms",
+                                           nanoseconds[p] / 1e6 ),
+                         cereal::make_nvp( std::string( phase_name( phase_t(p) ) ) + "-calls",
+                                           calls[p] ) );
+        }
+
+        template<class Archive> void load( Archive & archive ) {}
+    };
+
+
+    /**
+     * @brief The profile_t struct; process wide accumulators of the instrumented
+     *          phases. Only active if compiled with LIPNET_PROFILE, otherwise
+     *          scoped_timer_t is empty and the calls vanish. Phases which run in
+     *          several threads accumulate the time of every thread.
+     */
+
+    struct profile_t {
+#ifdef LIPNET_PROFILE
+        static constexpr bool enabled = true;
+#else
+        static constexpr bool enabled = false;
+#endif
+
+        std::array<std::atomic<uint64_t>, size_t(phase_t::COUNT)> nanoseconds{}, calls{};
+
+        static profile_t& global() {
+            static profile_t profile;
+            return profile;
+        }
+
+        inline void add( const phase_t p, const uint64_t ns ) {
+            nanoseconds[ size_t(p) ].fetch_add( ns, std::memory_order_relaxed );
+            calls[ size_t(p) ].fetch_add( 1, std::memory_order_relaxed );
+        }
+
+        profile_statistics_t snapshot() const {
+            profile_statistics_t res;
+            for( size_t p = 0; p < size_t(phase_t::COUNT); ++p ) {
+                res.nanoseconds[p] = nanoseconds[p].load( std::memory_order_relaxed );
+                res.calls[p] = calls[p].load( std::memory_order_relaxed );
+            }
+            return res;
+        }
+    };
+
+
+    /**
+     * @brief The scoped_timer_t struct; adds the lifetime of the object to a phase
+     * @tparam PHASE instrumented phase
+     */
+
+#ifdef LIPNET_PROFILE
+    template<phase_t PHASE>
+    struct scoped_timer_t {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        ~scoped_timer_t() {
+            profile_t::global().add( PHASE, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start ).count() );
+        }
+    };
+#else
+    template<phase_t PHASE>
+    struct scoped_timer_t { };
+#endif
+
+}
+
+#endif // __LIPNET_PROFILE_HPP__
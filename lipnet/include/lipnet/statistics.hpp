@@ -30,6 +30,10 @@
 #include <utility>
 #include <initializer_list>
 #include <deque>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdint>
 
 #include <lipnet/traits.hpp>
 
@@ -89,6 +93,164 @@ namespace lipnet {
 
 
 
+    /**
+     * @brief The statistics_sink_t struct. Streams one record per iteration to a
+     *          file instead of keeping the series in memory. The records are buffered
+     *          and written in chunks; only every n-th record is kept (decimation).
+     *          Files ending with ".csv" are written as csv, all others in a compact
+     *          binary format (header followed by the raw records).
+     * @tparam T numerical type
+     */
+
+    template<typename T>
+    struct statistics_sink_t {
+        static constexpr uint32_t magic_value = 0x5350494c; // "LIPS"
+        static constexpr uint32_t version_value = 2;
+
+        struct record_t {
+            uint64_t iteration;     /// iteration within the step
+            uint32_t step;          /// step of the central path (0 without central path)
+            uint32_t reserved;
+            T loss;                 /// objective
+            T alpha;                /// effective stepsize
+            T gamma;                /// barrier factor (0 without barrier)
+            T lipschitz;            /// last lipschitz estimate (0 if not tracked)
+            double time;            /// seconds since the sink was opened
+        };
+
+        struct header_t {
+            uint32_t magic = magic_value;
+            uint32_t version = version_value;
+            uint32_t dtype = sizeof(T);     /// size of the value type in bytes
+            uint32_t record = sizeof(record_t); /// size of a record in bytes
+        };
+
+
+        /**
+         * @brief open the sink
+         * @param path path to file on filesystem
+         * @param every keep every n-th record (default = 1, no decimation)
+         * @param chunk number of buffered records (default = 4096)
+         * @param append continue an existing file (e.g. after resuming from a checkpoint)
+         */
+
+        explicit statistics_sink_t( const std::string &path, const size_t every = 1,
+                                    const size_t chunk = 4096, const bool append = false )
+            : csv{ is_csv( path ) }, every{ std::max( every, size_t(1) ) },
+              chunk{ std::max( chunk, size_t(1) ) }, start{ std::chrono::steady_clock::now() } {
+
+            const bool exists = append && std::ifstream( path ).good();
+            const auto mode = csv ? std::ios::out : std::ios::out | std::ios::binary;
+
+            os.open( path, exists ? mode | std::ios::app : mode | std::ios::trunc );
+            if( !os )
+                throw std::string{"could not open statistics file: "} + path;
+
+            if( !exists ) {
+                if( csv ) os << "iteration,step,loss,alpha,gamma,lipschitz,time\n";
+                else { header_t header; os.write( reinterpret_cast<const char*>( &header ), sizeof(header) ); }
+            }
+
+            buffer.reserve( this->chunk );
+        }
+
+        statistics_sink_t( const statistics_sink_t& ) = delete;
+        statistics_sink_t& operator=( const statistics_sink_t& ) = delete;
+
+        ~statistics_sink_t() { flush(); }
+
+
+        /**
+         * @brief add a record; dropped unless it is the n-th since the last kept one
+         * @param iteration iteration within the step
+         * @param step step of the central path
+         * @param loss objective
+         * @param alpha effective stepsize
+         * @param gamma barrier factor
+         * @param lipschitz lipschitz estimate
+         */
+
+        void operator()( const uint64_t iteration, const uint32_t step, const T loss,
+                         const T alpha = 0, const T gamma = 0, const T lipschitz = 0 ) {
+            if( count++ % every != 0 ) return;
+
+            const double time = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start ).count();
+            buffer.push_back( record_t{ iteration, step, 0, loss, alpha, gamma, lipschitz, time } );
+
+            if( buffer.size() >= chunk ) flush();
+        }
+
+        /// write the buffered records
+        void flush() {
+            if( buffer.empty() ) return;
+
+            if( csv ) {
+                for( const auto &r : buffer )
+                    os << r.iteration << "," << r.step << "," << r.loss << ","
+                       << r.alpha << "," << r.gamma << "," << r.lipschitz << "," << r.time << "\n";
+            } else {
+                os.write( reinterpret_cast<const char*>( buffer.data() ), buffer.size()*sizeof(record_t) );
+            }
+
+            os.flush(); buffer.clear();
+        }
+
+
+        /**
+         * @brief read all records of a statistics file
+         * @param path path to file on filesystem
+         * @return records in the order they were written
+         */
+
+        static std::vector<record_t> read( const std::string &path ) {
+            std::vector<record_t> res;
+
+            if( is_csv( path ) ) {
+                std::ifstream is( path );
+                if( !is ) throw std::string{"could not open statistics file: "} + path;
+
+                std::string line; std::getline( is, line );
+                while( std::getline( is, line ) ) {
+                    record_t r{}; char sep;
+                    std::istringstream ls( line );
+                    if( ls >> r.iteration >> sep >> r.step >> sep >> r.loss >> sep
+                           >> r.alpha >> sep >> r.gamma >> sep >> r.lipschitz >> sep >> r.time )
+                        res.push_back( r );
+                }
+                return res;
+            }
+
+            std::ifstream is( path, std::ios::binary );
+            if( !is ) throw std::string{"could not open statistics file: "} + path;
+
+            header_t header, expected;
+            is.read( reinterpret_cast<char*>( &header ), sizeof(header) );
+            if( !is || std::memcmp( &header, &expected, sizeof(header) ) != 0 )
+                throw std::string{"not a statistics file of this value type: "} + path;
+
+            record_t r;
+            while( is.read( reinterpret_cast<char*>( &r ), sizeof(r) ) )
+                res.push_back( r );
+
+            return res;
+        }
+
+    private:
+
+        static bool is_csv( const std::string &path ) {
+            return path.size() >= 4 && path.compare( path.size()-4, 4, ".csv" ) == 0;
+        }
+
+        std::ofstream os;
+        bool csv;
+        size_t every, chunk, count = 0;
+        std::vector<record_t> buffer;
+        std::chrono::steady_clock::time_point start;
+    };
+
+
+
     /**
      * @brief The statistics_helper struct. Helper function to disable
      *        logging for performence reasons if it is desired.
@@ -29,6 +29,7 @@
 #include <utility>
 #include <initializer_list>
 #include <deque>
+#include <cmath>
 
 
 #include <blaze/Blaze.h>
@@ -335,6 +336,102 @@ namespace lipnet {
     };
 
 
+
+
+    /**
+     * @brief The dense_update_t struct; update_t implementation for dense blaze types
+     * @tparam T numerical value type
+     * @tparam V dense vector or matrix type
+     * @see lipnet::update_t
+     * @cite balzelib
+     */
+
+    template<typename T, typename V>
+    struct dense_update_t {
+
+        static inline void scale_add( V &y, const T a, const V &x, const T b ) {
+            y = a * y + b * x;
+        }
+
+        static inline void scale_add_square( V &y, const T a, const V &x, const T b ) {
+            y = a * y + b * ( x % x );
+        }
+
+        static inline void axpy( V &y, const T a, const V &x ) {
+            y += a * x;
+        }
+
+        static inline void adam_direction( V &d, const V &m, const V &v,
+                                           const T c1, const T c2, const T eps ) {
+            // blaze has no element wise division of matrices; a binary map is one pass
+            d = blaze::map( m, v, [c1, c2, eps]( const T a, const T b ){
+                return c1 * a / ( eps + std::sqrt( c2 * b ) );
+            });
+        }
+    };
+
+
+    /**
+     * @brief The update_t struct for blaze::StaticVector.
+     * @see lipnet::dense_update_t
+     */
+
+    template<typename T, size_t N>
+    struct update_t<T, blaze::StaticVector<T,N,blaze::columnVector>>
+        : public dense_update_t<T, blaze::StaticVector<T,N,blaze::columnVector>> {};
+
+
+    /**
+     * @brief The flat_t struct for blaze::StaticVector.
+     * @see lipnet::flat_t
+     */
+
+    template<typename T, size_t N>
+    struct flat_t<T, blaze::StaticVector<T,N,blaze::columnVector>> {
+        typedef blaze::CustomVector<T, blaze::unaligned, blaze::unpadded, blaze::columnVector> view_t;
+        static constexpr size_t size = N;
+
+        static inline void pack( const blaze::StaticVector<T,N,blaze::columnVector> &v, T *dst ) {
+            view_t( dst, N ) = v;
+        }
+
+        static inline void unpack( const T *src, blaze::StaticVector<T,N,blaze::columnVector> &v ) {
+            v = view_t( const_cast<T*>( src ), N );
+        }
+    };
+
+
+    /**
+     * @brief The flat_t struct for blaze::StaticMatrix; the elements are stored
+     *        in the storage order of the matrix
+     * @see lipnet::flat_t
+     */
+
+    template<typename T, size_t N1, size_t N2, bool SO>
+    struct flat_t<T, blaze::StaticMatrix<T,N1,N2,SO>> {
+        typedef blaze::CustomMatrix<T, blaze::unaligned, blaze::unpadded, SO> view_t;
+        static constexpr size_t size = N1*N2;
+
+        static inline void pack( const blaze::StaticMatrix<T,N1,N2,SO> &m, T *dst ) {
+            view_t( dst, N1, N2 ) = m;
+        }
+
+        static inline void unpack( const T *src, blaze::StaticMatrix<T,N1,N2,SO> &m ) {
+            m = view_t( const_cast<T*>( src ), N1, N2 );
+        }
+    };
+
+
+    /**
+     * @brief The update_t struct for blaze::StaticMatrix.
+     * @see lipnet::dense_update_t
+     */
+
+    template<typename T, size_t N1, size_t N2, bool SO>
+    struct update_t<T, blaze::StaticMatrix<T,N1,N2,SO>>
+        : public dense_update_t<T, blaze::StaticMatrix<T,N1,N2,SO>> {};
+
+
 }
 
 
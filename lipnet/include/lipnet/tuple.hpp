@@ -227,6 +227,73 @@ namespace lipnet {
     };
 
 
+    template<typename T, typename ...ARGS>
+    struct update_t<T, std::tuple<ARGS...>> {
+        typedef std::make_integer_sequence<size_t, sizeof... (ARGS)> seq_t;
+
+        template<size_t ...INTS>
+        static inline void scale_add_impl( std::tuple<ARGS...> &y, const T a, const std::tuple<ARGS...> &x,
+                                           const T b, std::integer_sequence<size_t, INTS...>) {
+            ( update_t<T,ARGS>::scale_add( std::get<INTS>(y), a, std::get<INTS>(x), b ), ... );
+        }
+
+        static inline void scale_add( std::tuple<ARGS...> &y, const T a, const std::tuple<ARGS...> &x, const T b ) {
+            scale_add_impl( y, a, x, b, seq_t{} );
+        }
+
+        template<size_t ...INTS>
+        static inline void scale_add_square_impl( std::tuple<ARGS...> &y, const T a, const std::tuple<ARGS...> &x,
+                                                  const T b, std::integer_sequence<size_t, INTS...>) {
+            ( update_t<T,ARGS>::scale_add_square( std::get<INTS>(y), a, std::get<INTS>(x), b ), ... );
+        }
+
+        static inline void scale_add_square( std::tuple<ARGS...> &y, const T a, const std::tuple<ARGS...> &x, const T b ) {
+            scale_add_square_impl( y, a, x, b, seq_t{} );
+        }
+
+        template<size_t ...INTS>
+        static inline void axpy_impl( std::tuple<ARGS...> &y, const T a, const std::tuple<ARGS...> &x,
+                                      std::integer_sequence<size_t, INTS...>) {
+            ( update_t<T,ARGS>::axpy( std::get<INTS>(y), a, std::get<INTS>(x) ), ... );
+        }
+
+        static inline void axpy( std::tuple<ARGS...> &y, const T a, const std::tuple<ARGS...> &x ) {
+            axpy_impl( y, a, x, seq_t{} );
+        }
+
+        template<size_t ...INTS>
+        static inline void adam_direction_impl( std::tuple<ARGS...> &d, const std::tuple<ARGS...> &m,
+                                                const std::tuple<ARGS...> &v, const T c1, const T c2, const T eps,
+                                                std::integer_sequence<size_t, INTS...>) {
+            ( update_t<T,ARGS>::adam_direction( std::get<INTS>(d), std::get<INTS>(m),
+                                                std::get<INTS>(v), c1, c2, eps ), ... );
+        }
+
+        static inline void adam_direction( std::tuple<ARGS...> &d, const std::tuple<ARGS...> &m,
+                                           const std::tuple<ARGS...> &v, const T c1, const T c2, const T eps ) {
+            adam_direction_impl( d, m, v, c1, c2, eps, seq_t{} );
+        }
+    };
+
+
+    template<typename T, typename ...ARGS>
+    struct flat_t<T, std::tuple<ARGS...>> {
+        static constexpr size_t size = ( flat_t<T,ARGS>::size + ... + 0 );
+
+        static inline void pack( const std::tuple<ARGS...> &m, T *dst ) {
+            std::apply( [&dst]( const auto& ...args ) {
+                ( ( flat_t<T, std::decay_t<decltype(args)>>::pack( args, dst ),
+                    dst += flat_t<T, std::decay_t<decltype(args)>>::size ), ... ); }, m );
+        }
+
+        static inline void unpack( const T *src, std::tuple<ARGS...> &m ) {
+            std::apply( [&src]( auto& ...args ) {
+                ( ( flat_t<T, std::decay_t<decltype(args)>>::unpack( src, args ),
+                    src += flat_t<T, std::decay_t<decltype(args)>>::size ), ... ); }, m );
+        }
+    };
+
+
     template<typename T, typename ...ARGS1, typename ...ARGS2>
     struct prod_t<T, std::tuple<ARGS1...>, std::tuple<ARGS2...>> {
 
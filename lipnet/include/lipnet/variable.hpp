@@ -57,6 +57,33 @@ namespace lipnet {
     template<typename V>
     struct function_t {};
 
+
+    /**
+     * @brief The update_t struct. Just a interface for all possible types.
+     *        In place updates of the optimisers; each update is one pass over
+     *        the elements without temporaries.
+     *        scale_add: @f[ y = a y + b x @f]
+     *        scale_add_square: @f[ y = a y + b x \circ x @f]
+     *        axpy: @f[ y = y + a x @f]
+     *        adam_direction: @f[ d = \frac{ c_1 m }{ \epsilon + \sqrt{ c_2 v } } @f]
+     * @tparam T numerical value type
+     * @tparam V tensor type of argument
+     */
+
+    template<typename T, typename V>
+    struct update_t {};
+
+
+    /**
+     * @brief The flat_t struct. Just a interface for all possible types.
+     *        Copy a tensor to and from one contiguous array of size elements.
+     * @tparam T numerical value type
+     * @tparam V tensor type of argument
+     */
+
+    template<typename T, typename V>
+    struct flat_t {};
+
     /**
      * @brief The prod_t struct. Just a interface for all possible types.
      *        Compute inner/outer/... products @f[ V_1 V_2^\top; \;\; V_1^\top V_2; \;\; \cdots  @f].
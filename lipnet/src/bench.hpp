@@ -0,0 +1,176 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIPNET_BENCH_HPP__
+#define __LIPNET_BENCH_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <deque>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+
+
+namespace lipnet::bench {
+
+    typedef std::chrono::steady_clock steady_t;
+
+
+    /// keep the compiler from removing the computation of value
+    template<typename V>
+    inline void do_not_optimize( V const &value ) {
+        asm volatile( "" : : "r,m"( value ) : "memory" );
+    }
+
+
+    /**
+     * @brief The state_t struct; loop control of a benchmark case. The setup before the
+     *          first call of keep_running is not measured.
+     *
+     *              while( state.keep_running() ) { ... }
+     */
+
+    struct state_t {
+        size_t max_iterations = 1;
+        size_t iterations = 0;
+        /// processed items (e.g. samples) per iteration; 0 disables the throughput
+        size_t items = 0;
+
+        steady_t::time_point start, stop;
+
+        inline bool keep_running() {
+            if( iterations == 0 ) start = steady_t::now();
+            if( iterations == max_iterations ) { stop = steady_t::now(); return false; }
+            ++iterations; return true;
+        }
+
+        inline double seconds() const {
+            return std::chrono::duration<double>( stop - start ).count();
+        }
+    };
+
+
+    /// measurement of a benchmark case
+    struct result_t {
+        std::string name;
+        size_t iterations = 0;
+        double median = 0;      /// median time per iteration over the repetitions in ns
+        double min = 0;         /// minimal time per iteration over the repetitions in ns
+        double throughput = 0;  /// items per second of the median; 0 without items
+
+        template<class Archive> void serialize( Archive & archive ) {
+            archive( cereal::make_nvp("name", name),
+                     cereal::make_nvp("iterations", iterations),
+                     cereal::make_nvp("median-ns", median),
+                     cereal::make_nvp("min-ns", min),
+                     cereal::make_nvp("items-per-second", throughput) );
+        }
+    };
+
+
+    /**
+     * @brief The registry_t struct; named benchmark cases. The number of iterations
+     *          is doubled until a run takes at least min_time, then the run is
+     *          repeated and the median and minimum are reported.
+     */
+
+    struct registry_t {
+        typedef std::function<void(state_t&)> function_t;
+
+        std::vector<std::pair<std::string, function_t>> cases;
+
+        double min_time = 0.5;      /// minimal measured time of a repetition in seconds
+        size_t repetitions = 3;     /// repetitions of the calibrated run
+        size_t max_iterations = 1e9;
+
+        inline void add( std::string name, function_t f ) {
+            cases.emplace_back( std::move(name), std::move(f) );
+        }
+
+        /**
+         * @brief run all cases whose name contains filter
+         * @param filter substring of the case names; empty runs all
+         * @param os stream of the table
+         * @return results in the order of registration
+         */
+
+        std::vector<result_t> run( const std::string &filter, std::ostream &os = std::cout ) const {
+            std::vector<result_t> results;
+
+            os << std::left << std::setw(48) << "benchmark" << std::right
+               << std::setw(14) << "median ns" << std::setw(14) << "min ns"
+               << std::setw(12) << "iterations" << std::setw(16) << "items/s" << "\n";
+
+            for( const auto &[ name, f ] : cases ) {
+                if( !filter.empty() && name.find( filter ) == std::string::npos )
+                    continue;
+
+                // calibrate
+                size_t n = 1; state_t state;
+                while( true ) {
+                    state = state_t{}; state.max_iterations = n;
+                    f( state );
+                    if( state.seconds() >= min_time || n >= max_iterations ) break;
+
+                    const double estimate = state.seconds() > 0
+                            ? 1.2 * min_time / state.seconds() * n : 10.0 * n;
+                    n = std::min( max_iterations, std::max( 2*n, (size_t) estimate ) );
+                }
+
+                std::vector<double> times{ 1e9 * state.seconds() / state.iterations };
+                for( size_t r = 1; r < repetitions; ++r ) {
+                    state = state_t{}; state.max_iterations = n;
+                    f( state );
+                    times.push_back( 1e9 * state.seconds() / state.iterations );
+                }
+                std::sort( times.begin(), times.end() );
+
+                result_t res;
+                res.name = name; res.iterations = n;
+                res.median = times[ times.size()/2 ];
+                res.min = times.front();
+                res.throughput = state.items > 0 ? 1e9 * state.items / res.median : 0;
+
+                os << std::left << std::setw(48) << res.name << std::right
+                   << std::setw(14) << std::fixed << std::setprecision(0) << res.median
+                   << std::setw(14) << res.min << std::setw(12) << res.iterations
+                   << std::setw(16) << res.throughput << "\n";
+                os.flush();
+
+                results.push_back( std::move(res) );
+            }
+
+            return results;
+        }
+    };
+
+}
+
+#endif // __LIPNET_BENCH_HPP__
@@ -54,19 +54,11 @@ using namespace lipnet;
 
 template<size_t I, size_t O>
 auto load_data( const std::string &filename ) {
-    network_data_t<double,I,O> data;
-
-    auto opt = loader_t<double>::load(filename);
+    auto opt = loader_t<double>::template load_network_data<I,O>( filename, true );
     if( !opt.has_value() )
         throw std::string{"could not load file"};
 
-    data.idata = blaze::trans( blaze::submatrix( opt.value(), 0, 0,
-                           I, opt.value().columns() ));
-
-    auto last = blaze::row( opt.value(), I );
-    data.tdata = blaze::trans( make_one_hot<double>( blaze::trans(last), O ) );
-
-    return std::move(data);
+    return std::move( opt.value() );
 }
 
 
@@ -106,6 +98,10 @@ int main(int argc, char **argv)
     double initweights = 0.1;
     size_t maxiter = 50;
 
+    checkpoint_t checkpoint;
+    bool asynchronous = false;
+    resources_t res;
+
 
     bool show_help = false;
     auto cli
@@ -131,7 +127,21 @@ int main(int argc, char **argv)
             | lyra::opt(beta2, "beta2")
                   ["-p"]["--beta2"]("adam beta2 param")
             | lyra::opt(initweights, "initweights")
-                  ["-i"]["--initweights"]("initweights variance");
+                  ["-i"]["--initweights"]("initweights variance")
+            | lyra::opt(checkpoint.path, "checkpointfile")
+                  ["-C"]["--checkpoint"]("checkpoint the admm iterations to 'checkpointfile' and resume from it if it exists")
+            | lyra::opt(checkpoint.every, "iterations")
+                  ["--checkpoint-every"]("iterations between two checkpoints (default: 1000)")
+            | lyra::opt(asynchronous)
+                  ["-A"]["--async"]("certify the iterate on another thread while the next first subproblem is solved")
+            | lyra::opt(res.workers, "threads")
+                  ["--workers"]("lipnet worker threads, e.g. of the backpropagation (default: hardware threads)")
+            | lyra::opt(res.blaze, "threads")
+                  ["--blaze-threads"]("threads of blaze (default: blaze default)")
+            | lyra::opt(res.solver, "threads")
+                  ["--solver-threads"]("threads of every mosek model (default: mosek decides)")
+            | lyra::opt(res.pin, "core")
+                  ["--pin"]("pin the process to consecutive cores starting at 'core', one per thread of the largest pool (default: off)");
 
     auto result = cli.parse({ argc, argv });
     if (!result) {
@@ -143,6 +153,8 @@ int main(int argc, char **argv)
         std::cout << cli << "\n";  return 0;
     }
 
+    configure( res );
+
 
     typedef network_t<double, tanh_activation_t, INPUTS::value, HIDDEN1::value,
                 HIDDEN2::value, OUTPUTS::value> nn_t;
@@ -183,6 +195,8 @@ int main(int argc, char **argv)
    typename pro_nn_t::variable_t init2 = weights;
 
    solver_t solver( solver_t::parameter_t{ (size_t) maxiter, rho, diff}  );
+   solver.param.checkpoint = checkpoint;
+   solver.param.asynchronous = asynchronous;
    pro_nn_t prob ( std::move(data), lipschitz );
 
    solver_t::main_statistics_t stats;
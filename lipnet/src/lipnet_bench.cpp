@@ -0,0 +1,334 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <lipnet/network/activation.hpp>
+#include <lipnet/network/loss.hpp>
+#include <lipnet/network/topology.hpp>
+#include <lipnet/network/backpropagation.hpp>
+
+#include <lipnet/lipschitz/barrier.hpp>
+#include <lipnet/lipschitz/feasibility.hpp>
+#include <lipnet/lipschitz/structure.hpp>
+
+#include <lipnet/extern/nn_lipcalc.hpp>
+#include <lipnet/extern/mosek_projection_wot.hpp>
+
+#include <lipnet/variable.hpp>
+
+#include <cereal/archives/json.hpp>
+#include <lyra/lyra.hpp>
+
+#include "bench.hpp"
+
+using namespace lipnet;
+using namespace lipnet::bench;
+
+
+
+
+/// name of a topology, e.g. 2-10-10-3
+template<size_t ...N>
+std::string topology_name() {
+    std::string res;
+    ( ( res += ( res.empty() ? "" : "-" ) + std::to_string( N ) ), ... );
+    return res;
+}
+
+/// random labeled training data with one sample per column
+template<size_t IN, size_t OUT>
+network_data_t<double, IN, OUT> random_data( const size_t samples ) {
+    network_data_t<double, IN, OUT> data;
+    data.icols.resize( IN, samples );
+    blaze::randomize( data.icols, -1.0, 1.0 );
+
+    data.labels.resize( samples );
+    for( size_t i = 0; i < samples; ++i )
+        data.labels[i] = i % OUT;
+
+    return data;
+}
+
+
+/**
+ * @brief forward and backward pass of a batch, a full batch step of the sampler
+ *          and the adam update of the weights
+ */
+
+template<size_t BATCH, size_t ...N>
+void register_backpropagation( registry_t &registry ) {
+    typedef backpropagation_batch_t<double, tanh_activation_t, cross_entropy_t, BATCH, N...> bp_t;
+    typedef typename bp_t::variable_t variable_t;
+    typedef std::integral_constant<size_t, sizeof... (N)-1> L;
+
+    const std::string suffix = "/" + topology_name<N...>() + "/" + std::to_string( BATCH );
+
+    auto bp = std::make_shared<bp_t>( cross_entropy_t<double>(),
+                random_data<at<0,N...>(), at<L::value,N...>()>( 4*BATCH ) );
+    bp->prefetch = false;
+
+    registry.add( "forward" + suffix, [bp]( state_t &state ) {
+        auto ws = std::make_unique<typename bp_t::workspace_t>();
+        const variable_t var = generator_t<variable_t>::make( 0.1 );
+        const auto &params = bp->propagation_weights( var, *ws );
+        auto &b = ws->batches[0]; bp->sample( *ws, b );
+
+        state.items = BATCH;
+        while( state.keep_running() ) {
+            bp->forward( params, b.input, ws->x, ws->z, ws->deriv );
+            do_not_optimize( std::get<L::value-1>( ws->z ) );
+        }
+    });
+
+    registry.add( "backward" + suffix, [bp]( state_t &state ) {
+        auto ws = std::make_unique<typename bp_t::workspace_t>();
+        const variable_t var = generator_t<variable_t>::make( 0.1 );
+        variable_t gradient = generator_t<variable_t>::make( 0.0 );
+        const auto &params = bp->propagation_weights( var, *ws );
+        auto &b = ws->batches[0]; bp->sample( *ws, b );
+
+        bp->forward( params, b.input, ws->x, ws->z, ws->deriv );
+        std::get<L::value-1>( ws->delta ) = std::get<L::value-1>( ws->z );
+
+        state.items = BATCH;
+        while( state.keep_running() ) {
+            bp->backward( params, gradient, b.input, ws->x, ws->delta, ws->deriv );
+            do_not_optimize( gradient );
+        }
+    });
+
+    registry.add( "batch_step" + suffix, [bp]( state_t &state ) {
+        typename bp_t::metainfo_t info;
+        const variable_t var = generator_t<variable_t>::make( 0.1 );
+        variable_t gradient = generator_t<variable_t>::make( 0.0 );
+        double objective = 0;
+
+        state.items = BATCH;
+        while( state.keep_running() ) {
+            bp->run( var, info, gradient, objective );
+            do_not_optimize( objective );
+        }
+    });
+}
+
+
+/**
+ * @brief barrier function, feasibility check, sdps and the optimizer update; independent
+ *          of the batch size
+ */
+
+template<size_t ...N>
+void register_lipschitz( registry_t &registry ) {
+    typedef barrierfunction_t<double, N...> barrier_t;
+    typedef typename barrier_t::variable_t variable_t;
+    typedef typename network_t<double, tanh_activation_t, N...>::layer_t weights_t;
+
+    const std::string suffix = "/" + topology_name<N...>();
+    const double lipschitz = 100;
+
+    // small weights keep chi positive definite
+    const auto position = [](){ return generator_t<variable_t>::make( 1e-3, 1.0 ); };
+
+    registry.add( "barrier_chol" + suffix, [=]( state_t &state ) {
+        barrier_t barrier( lipschitz );
+        const variable_t var = position();
+
+        while( state.keep_running() )
+            do_not_optimize( barrier.chol( lipschitz, var ) );
+    });
+
+    registry.add( "barrier_inv" + suffix, [=]( state_t &state ) {
+        barrier_t barrier( lipschitz );
+        const auto L = barrier.chol( lipschitz, position() );
+
+        while( state.keep_running() )
+            do_not_optimize( barrier.inv( L ) );
+    });
+
+    registry.add( "barrier_compute" + suffix, [=]( state_t &state ) {
+        barrier_t barrier( lipschitz );
+        const variable_t var = position();
+        variable_t gradient = generator_t<variable_t>::make( 0.0, 0.0 );
+
+        while( state.keep_running() ) {
+            do_not_optimize( barrier.compute( var, gradient, 1.0 ) );
+            do_not_optimize( gradient );
+        }
+    });
+
+    registry.add( "feasibility" + suffix, [=]( state_t &state ) {
+        feasibilitycheck_t<double, N...> check;
+        const variable_t var = position();
+        const variable_t dir = generator_t<variable_t>::make( 1e-2, 1e-2 );
+
+        while( state.keep_running() )
+            do_not_optimize( check.compute( var, dir, lipschitz*lipschitz ) );
+    });
+
+    registry.add( "adam_update" + suffix, [=]( state_t &state ) {
+        variable_t x = position(), gradient = generator_t<variable_t>::make( 1e-2, 1e-2 );
+        variable_t momentum = generator_t<variable_t>::make( 0.0, 0.0 );
+        variable_t velocity = momentum, direction = momentum;
+
+        while( state.keep_running() ) {
+            update_t<double,variable_t>::scale_add( momentum, 0.9, gradient, 0.1 );
+            update_t<double,variable_t>::scale_add_square( velocity, 0.999, gradient, 0.001 );
+            update_t<double,variable_t>::adam_direction( direction, momentum, velocity, 10.0, 1000.0, 1e-8 );
+            update_t<double,variable_t>::axpy( x, -1e-3, direction );
+            do_not_optimize( x );
+        }
+    });
+
+    registry.add( "sdp_lipschitz" + suffix, [=]( state_t &state ) {
+        const weights_t w = generator_t<weights_t>::make( 0.1 );
+
+        while( state.keep_running() )
+            do_not_optimize( network_libcalc_t<double, N...>::solve( w ) );
+    });
+
+    registry.add( "sdp_lipschitz_reuse" + suffix, [=]( state_t &state ) {
+        const weights_t w = generator_t<weights_t>::make( 0.1 );
+        network_libcalc_t<double, N...> calc;
+        calc.compute( w );
+
+        while( state.keep_running() )
+            do_not_optimize( calc.compute( w ) );
+    });
+
+    registry.add( "sdp_projection" + suffix, [=]( state_t &state ) {
+        const weights_t w = generator_t<weights_t>::make( 0.5 );
+        mosek_projection_wot_t<double, N...> projection( 10.0, 1.0 );
+
+        while( state.keep_running() )
+            do_not_optimize( projection.project( weights_t( w ) ) );
+    });
+}
+
+
+
+/**
+ * @brief compare the block cholesky decomposition and the block inverse of
+ *          barrierfunction_t with blaze::llh and blaze::inv of the assembled chi;
+ *          the block recursions are generic in the depth of the network
+ * @return largest relative deviation of the blocks
+ */
+
+template<size_t ...N>
+double check_decomposition() {
+    typedef barrierfunction_t<double, N...> barrier_t;
+    typedef typename barrier_t::variable_t variable_t;
+    typedef blaze::DynamicMatrix<double, blaze::rowMajor> dmatrix_t;
+    typedef std::integral_constant<size_t, sizeof... (N)-1> L;
+
+    const double lipschitz = 100;
+    barrier_t barrier( lipschitz );
+    const variable_t var = generator_t<variable_t>::make( 1e-1, 1.0 );
+
+    const dmatrix_t chi = generate_lipschitz_chi<double, N...>( var.W, var.t, lipschitz*lipschitz );
+
+    // without the numerical offset the blocks decompose chi itself
+    const auto blocks = barrier.template chol<false>( lipschitz, var );
+    const auto inverse = barrier.inv( blocks );
+
+    dmatrix_t lower, reference;
+    lower = generate_lipschitz_train_l<double, N...>( blocks );
+    blaze::llh( chi, reference );
+    const dmatrix_t dense = blaze::inv( chi );
+
+    const auto deviation = []( const auto &a, const auto &b ) {
+        return double( blaze::norm( a - b ) ) / std::max( 1.0, double( blaze::norm( b ) ) );
+    };
+
+    double error = deviation( lower, reference );
+
+    std::for_range<0, L::value+1>([&]<auto I>(){
+        error = std::max( error, deviation( std::get<I>( inverse.P ),
+            blaze::submatrix<sum<I,N...>(), sum<I,N...>(), at<I,N...>(), at<I,N...>()>( dense ) ) );
+
+        if constexpr ( I < L::value )
+            error = std::max( error, deviation( std::get<I>( inverse.K ),
+                blaze::submatrix<sum<I+1,N...>(), sum<I,N...>(), at<I+1,N...>(), at<I,N...>()>( dense ) ) );
+    });
+
+    std::cout << "decomposition " << topology_name<N...>() << ": " << error << "\n";
+    return error;
+}
+
+
+int main(int argc, char **argv)
+{
+    registry_t registry;
+
+    std::string filter;
+    std::string outputfile;
+    bool check = false;
+
+    bool show_help = false;
+    auto cli
+            = lyra::help(show_help)
+            | lyra::opt(filter, "filter")
+                  ["-f"]["--filter"]("only run the benchmarks whose name contains 'filter'")
+            | lyra::opt(registry.min_time, "seconds")
+                  ["-t"]["--min-time"]("minimal measured time of a repetition (default: 0.5)")
+            | lyra::opt(registry.repetitions, "repetitions")
+                  ["-r"]["--repetitions"]("repetitions of every benchmark (default: 3)")
+            | lyra::opt(outputfile, "outputfile")
+                  ["-o"]["--output"]("write the results as json to 'outputfile'")
+            | lyra::opt(check)
+                  ["-c"]["--check"]("compare the block decompositions of chi with the dense ones for several depths and exit");
+
+    auto result = cli.parse({ argc, argv });
+    if (!result) {
+        std::cerr << "Error in command line: " << result.errorMessage() << std::endl;
+        std::cerr << cli << "\n";  return 1;
+    }
+
+    if (show_help) {
+        std::cout << cli << "\n";  return 0;
+    }
+
+
+    if( check ) {
+        const double error = std::max( { check_decomposition<2, 10, 3>(),
+                                         check_decomposition<2, 10, 10, 3>(),
+                                         check_decomposition<2, 10, 10, 10, 3>(),
+                                         check_decomposition<4, 8, 6, 8, 6, 2>() } );
+        return error < 1e-8 ? 0 : 1;
+    }
+
+    register_backpropagation<32, 2, 10, 10, 3>( registry );
+    register_backpropagation<400, 2, 10, 10, 3>( registry );
+    register_backpropagation<32, 196, 100, 40, 10>( registry );
+    register_backpropagation<400, 196, 100, 40, 10>( registry );
+
+    register_lipschitz<2, 10, 10, 3>( registry );
+    register_lipschitz<196, 100, 40, 10>( registry );
+
+    const auto results = registry.run( filter );
+
+    if( !outputfile.empty() ) {
+        std::ofstream os( outputfile );
+        {
+            cereal::JSONOutputArchive archive( os );
+            archive( cereal::make_nvp("benchmarks", results) );
+        }
+        os.close();
+    }
+}
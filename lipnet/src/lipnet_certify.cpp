@@ -0,0 +1,100 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <lipnet/network/activation.hpp>
+#include <lipnet/network/network.hpp>
+
+#include <lipnet/extern/nn_lipcalc_batch.hpp>
+
+#include <cereal/archives/json.hpp>
+#include <lyra/lyra.hpp>
+
+using namespace lipnet;
+
+
+
+int main(int argc, char **argv)
+{
+    typedef network_t<double, tanh_activation_t, 2, 10, 10, 3> nn_t;
+    typedef network_libcalc_batch_t<double, 2, 10, 10, 3> certifier_t;
+
+    std::vector<std::string> modelfiles;
+    std::string outputfile;
+
+    certifier_t certifier;
+    bool skip_pairs = false;
+
+    bool show_help = false;
+    auto cli
+            = lyra::help(show_help)
+            | lyra::opt(certifier.target, "target")
+                  ["-l"]["--lipschitz"]("stop once the bounds decide 'target'; spectral norms, layer pair sdps, full sdp (default: 0, always the full sdp)")
+            | lyra::opt(certifier.workers, "workers")
+                  ["-j"]["--workers"]("number of concurrent sdps (default: hardware threads)")
+            | lyra::opt(certifier.solver_threads, "threads")
+                  ["-t"]["--threads"]("threads of each mosek model (default: 1)")
+            | lyra::opt(certifier.chordal)
+                  ["-c"]["--chordal"]("one psd cone per pair of layers instead of one for chi")
+            | lyra::opt(skip_pairs)
+                  ["-P"]["--skip-pairs"]("go from the spectral norms directly to the full sdp")
+            | lyra::opt(outputfile, "outputfile")
+                  ["-o"]["--output"]("write the results table to 'outputfile' (default: stdout)")
+            | lyra::arg(modelfiles, "modelfiles")("models as json").required();
+
+    auto result = cli.parse({ argc, argv });
+    if (!result) {
+        std::cerr << "Error in command line: " << result.errorMessage() << std::endl;
+        std::cerr << cli << "\n";  return 1;
+    }
+
+    if (show_help) {
+        std::cout << cli << "\n";  return 0;
+    }
+
+    certifier.pairs = !skip_pairs;
+
+
+    std::vector<typename certifier_t::variable_t> models;
+    for( const auto &file : modelfiles ) {
+        nn_t network;
+
+        std::ifstream is( file );
+        {
+            cereal::JSONInputArchive archive(is);
+            archive( cereal::make_nvp("model", network) );
+        }
+        is.close();
+
+        models.push_back( network.layers );
+    }
+
+    auto results = certifier.compute( modelfiles, models );
+
+    if( outputfile.empty() )
+        certifier_t::print( std::cout, results );
+    else {
+        std::ofstream os( outputfile );
+        certifier_t::print( os, results );
+    }
+
+    return 0;
+}
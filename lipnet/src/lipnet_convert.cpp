@@ -0,0 +1,108 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include <lipnet/loader/loader.hpp>
+#include <lipnet/loader/container.hpp>
+#include <lipnet/loader/binary.hpp>
+
+#include <cereal/archives/json.hpp>
+#include <lyra/lyra.hpp>
+
+using namespace lipnet;
+
+
+
+int main(int argc, char **argv)
+{
+    typedef binary_loader_t<double> binary_t;
+    typedef typename binary_t::cmatrix_t cmatrix_t;
+
+    std::string inputfile;
+    std::string outputfile;
+
+    size_t classes = 3;
+    bool json = false;
+    bool single = false;
+
+    bool show_help = false;
+    auto cli
+            = lyra::help(show_help)
+            | lyra::opt(classes, "classes")
+                  ["-c"]["--classes"]("number of classes of the label row of a csv file (default: 3)")
+            | lyra::opt(json)
+                  ["-j"]["--json"]("read a data container as json (nvp 'mnist') instead of csv")
+            | lyra::opt(single)
+                  ["-s"]["--float"]("store the values as float")
+            | lyra::arg(inputfile, "inputfile")("csv or json dataset").required()
+            | lyra::arg(outputfile, "outputfile")("binary dataset").required();
+
+    auto result = cli.parse({ argc, argv });
+    if (!result) {
+        std::cerr << "Error in command line: " << result.errorMessage() << std::endl;
+        std::cerr << cli << "\n";  return 1;
+    }
+
+    if (show_help) {
+        std::cout << cli << "\n";  return 0;
+    }
+
+
+    cmatrix_t icols, tcols;
+
+    if( json ) {
+        data_container_t<double> container;
+        std::ifstream iss( inputfile );
+        {
+            cereal::JSONInputArchive archive( iss );
+            archive( cereal::make_nvp("mnist", container) );
+        }
+        iss.close();
+
+        icols = blaze::trans( container.x );
+        tcols = blaze::trans( container.y );
+    } else {
+        auto opt = loader_t<double>::load( inputfile );
+        if( !opt.has_value() ) {
+            std::cerr << "could not read '" << inputfile << "'" << std::endl;
+            return 1;
+        }
+
+        const auto &raw = opt.value();
+        const size_t inputs = raw.rows()-1;
+
+        icols = blaze::submatrix( raw, 0, 0, inputs, raw.columns() );
+        tcols = make_one_hot<double>( blaze::trans( blaze::row( raw, inputs ) ), classes );
+    }
+
+    const bool written = single
+            ? binary_t::save<float>( outputfile, icols, tcols )
+            : binary_t::save<double>( outputfile, icols, tcols );
+
+    if( !written ) {
+        std::cerr << "could not write '" << outputfile << "'" << std::endl;
+        return 1;
+    }
+
+    std::cout << icols.columns() << " samples, " << icols.rows() << " inputs, "
+              << tcols.rows() << " outputs" << std::endl;
+
+    return 0;
+}
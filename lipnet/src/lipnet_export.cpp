@@ -0,0 +1,89 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include <lipnet/network/activation.hpp>
+#include <lipnet/network/network.hpp>
+#include <lipnet/network/export.hpp>
+
+#include <lipnet/dynamic/network.hpp>
+
+#include <cereal/archives/json.hpp>
+#include <lyra/lyra.hpp>
+
+using namespace lipnet;
+
+
+
+int main(int argc, char **argv)
+{
+    // the topology is read from the model file
+    typedef dynamic_network_t<double, tanh_activation_t> nn_t;
+
+    std::string modelfile = "model.json";
+    std::string outputfile = "model.lipm";
+
+    bool show_help = false;
+    auto cli
+            = lyra::help(show_help)
+            | lyra::opt(modelfile, "modelfile")
+                  ["-i"]["--input"]("read model as json from 'modelfile'")
+            | lyra::opt(outputfile, "outputfile")
+                  ["-o"]["--output"]("write the frozen model to 'outputfile'");
+
+    auto result = cli.parse({ argc, argv });
+    if (!result) {
+        std::cerr << "Error in command line: " << result.errorMessage() << std::endl;
+        std::cerr << cli << "\n";  return 1;
+    }
+
+    if (show_help) {
+        std::cout << cli << "\n";  return 0;
+    }
+
+
+    nn_t network;
+
+    std::ifstream is( modelfile );
+    {
+        cereal::JSONInputArchive archive(is);
+        archive( cereal::make_nvp("model", network) );
+    }
+    is.close();
+
+    if( !export_frozen( network, outputfile ) ) {
+        std::cerr << "could not write '" << outputfile << "'" << std::endl;
+        return 1;
+    }
+
+    // compare the frozen network against the trained one on random points of the input cube
+    auto frozen = frozen_network_t<double>::load( outputfile );
+
+    blaze::DynamicMatrix<double, blaze::rowMajor> points =
+            blaze::rand<blaze::DynamicMatrix<double, blaze::rowMajor>>( network.topology.front(), 21*21, -1.0, 1.0 );
+
+    const double deviation = blaze::max( blaze::abs(
+                network.query_batch( points ) - frozen.query_batch( points ) ) );
+
+    std::cout << "exported " << frozen.layers.size() << " layers, max deviation "
+              << deviation << std::endl;
+
+    return 0;
+}
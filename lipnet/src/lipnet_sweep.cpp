@@ -0,0 +1,415 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+
+#include <lipnet/network/activation.hpp>
+#include <lipnet/network/loss.hpp>
+#include <lipnet/network/topology.hpp>
+
+#include <lipnet/problem/nn_problem_batch.hpp>
+#include <lipnet/problem/nn_problem_batch_l2.hpp>
+#include <lipnet/problem/nn_problem_liptrain_barrier.hpp>
+#include <lipnet/problem/nn_problem_liptrain_barrier_wot.hpp>
+#include <lipnet/problem/nn_problem_liptrain_projection.hpp>
+
+#include <lipnet/optimizer.hpp>
+#include <lipnet/statistics.hpp>
+#include <lipnet/parallel.hpp>
+
+#include <lipnet/loader/loader.hpp>
+
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <lyra/lyra.hpp>
+
+using namespace lipnet;
+
+
+/// methods of lipnet_training which are available in the sweep; same values as there
+enum choice_t : size_t {
+    NOM = 0,
+    L2 = 1,
+    PRO = 3,
+    BARR = 4,
+    BARRWOT = 5,
+    BARRF = 7,
+    BARRWOTF = 8
+};
+
+
+typedef std::integral_constant<size_t,2>  INPUTS;
+typedef std::integral_constant<size_t,10> HIDDEN1;
+typedef std::integral_constant<size_t,10> HIDDEN2;
+typedef std::integral_constant<size_t,3>  OUTPUTS;
+
+typedef std::integral_constant<size_t, 400> BATCH;
+
+typedef network_t<double, tanh_activation_t, INPUTS::value, HIDDEN1::value,
+            HIDDEN2::value, OUTPUTS::value> nn_t;
+
+typedef shared_data_t<double, INPUTS::value, OUTPUTS::value> data_t;
+
+
+/// hyperparameters which are the same for every configuration
+struct options_t {
+    std::string outdir = ".";
+
+    double diff = 1e-8;
+    double threshold = 1e-8;
+    size_t window = 300;
+
+    size_t centralpathsteps = 5;
+    double rhodec = 0.5;
+    double alphadec = 0.5;
+
+    double beta1 = 0.9;
+    double beta2 = 0.999;
+
+    double tparam = 100;
+    double initweights = 0.1;
+
+    size_t maxiter = 1e5;
+
+    /// threads of the backpropagation of every configuration
+    size_t threads = 1;
+};
+
+
+/// one point of the grid
+struct config_t {
+    size_t method = NOM;
+    double lipschitz = 50;
+    double rho = 0.1;
+    double alpha = 0.02;
+
+    /// prefix of the model and statistics file
+    std::string name() const {
+        std::ostringstream os;
+        os << "m" << method << "-l" << lipschitz << "-r" << rho << "-a" << alpha;
+        return os.str();
+    }
+};
+
+
+/// summary of a finished configuration
+struct outcome_t {
+    config_t config;
+    bool ok = false;
+    double loss = 0;
+    long long time = 0;
+    std::string error;
+
+    template<class Archive> void serialize(Archive & archive)
+        {  archive( cereal::make_nvp("name", config.name()), cereal::make_nvp("method", config.method),
+                    cereal::make_nvp("lipschitz", config.lipschitz), cereal::make_nvp("rho", config.rho),
+                    cereal::make_nvp("alpha", config.alpha), cereal::make_nvp("ok", ok),
+                    cereal::make_nvp("final-loss", loss), cereal::make_nvp("optimization-time", time),
+                    cereal::make_nvp("error", error) ); }
+};
+
+
+
+template<typename NN>
+int dumptodisk( const std::string &path, const std::string &name, NN &nn ) {
+    std::ofstream oss( path );
+    {
+        cereal::JSONOutputArchive archive(oss);
+        archive( cereal::make_nvp(name, nn) );
+    }
+    oss.close();
+    return 0;
+}
+
+
+/**
+ * @brief train one configuration and write its model and statistics
+ * @param c configuration
+ * @param opt common hyperparameters
+ * @param data training data; shared by all configurations
+ * @param setup serializes the random initialisation, the generator of blaze is not thread safe
+ * @return summary of the run
+ */
+
+outcome_t train( const config_t &c, const options_t &opt, const data_t &data, std::mutex &setup ) {
+    outcome_t res; res.config = c;
+
+    const std::string prefix = opt.outdir + "/" + c.name();
+    nn_t nn;
+
+    // runs the solver on the problem and stores weights, loss and time
+    const auto finish = [&]( auto &solver, auto &prob, auto &&init, auto &stats ) {
+        auto [ weights, value ] = solver( prob, std::move(init), stats );
+        if constexpr ( std::is_same<std::decay_t<decltype(weights)>, typename nn_t::layer_t>::value )
+            nn.layers = weights;
+        else
+            nn.layers = weights.W;
+
+        res.loss = value; res.time = stats.duration.count();
+        dumptodisk( prefix + "-model.json", "model", nn );
+        dumptodisk( prefix + "-stats.json", "run", stats );
+    };
+
+    switch ( c.method ) {
+    case choice_t::NOM:
+    case choice_t::L2: {
+        typedef network_problem_batch_l2_t<double, tanh_activation_t,
+                      cross_entropy_t, BATCH::value, INPUTS::value, HIDDEN1::value,
+                    HIDDEN2::value, OUTPUTS::value> pro_nn_t ;
+        typedef adam_momentum_t<double, pro_nn_t, typename pro_nn_t::variable_t,
+                typename pro_nn_t::variable_t> solver_t;
+
+        // the nominal training is the l2 training without regularisation
+        solver_t solver( solver_t::parameter_t{ opt.maxiter, opt.diff, 1e-4, c.alpha, opt.beta1, opt.beta2, 1e-8} );
+        pro_nn_t prob ( cross_entropy_t<double>(), data, c.method == choice_t::L2 ? c.rho : 0.0 );
+        prob.threads = opt.threads;
+
+        typename pro_nn_t::variable_t init;
+        { std::lock_guard<std::mutex> lock( setup );
+            init = generator_t<typename pro_nn_t::variable_t>::make( opt.initweights ); }
+
+        typename solver_t::main_statistics_t stats;
+        finish( solver, prob, std::move(init), stats );
+        break; }
+
+    case choice_t::PRO: {
+        typedef network_problem_projection_t<double, tanh_activation_t,
+             cross_entropy_t, BATCH::value,INPUTS::value, HIDDEN1::value,
+             HIDDEN2::value, OUTPUTS::value> pro_nn_t;
+        typedef adam_projected_t<double, pro_nn_t, typename pro_nn_t::variable_t,
+                 typename pro_nn_t::variable_t> solver_t;
+
+        solver_t solver( solver_t::parameter_t{ opt.maxiter, opt.diff, opt.threshold, opt.window,
+                                                c.alpha, opt.beta1, opt.beta2, 1e-8 } );
+        pro_nn_t prob ( cross_entropy_t<double>(), data, c.lipschitz, opt.tparam );
+        prob.threads = opt.threads;
+
+        typename pro_nn_t::variable_t init;
+        { std::lock_guard<std::mutex> lock( setup );
+            init = generator_t<typename pro_nn_t::variable_t>::make( opt.initweights ); }
+
+        typename solver_t::main_statistics_t stats;
+        finish( solver, prob, std::move(init), stats );
+        break; }
+
+    case choice_t::BARR:
+    case choice_t::BARRF: {
+        typedef network_problem_log_barrier_t<double, tanh_activation_t,
+                      cross_entropy_t, BATCH::value, INPUTS::value, HIDDEN1::value,
+                HIDDEN2::value, OUTPUTS::value> pro_nn_t ;
+
+        pro_nn_t prob ( cross_entropy_t<double>(), data, c.lipschitz );
+        prob.threads = opt.threads;
+
+        typename pro_nn_t::variable_t init;
+        { std::lock_guard<std::mutex> lock( setup );
+            init = generator_t<typename pro_nn_t::variable_t>::make( opt.initweights, 0.1 ); }
+
+        std::for_range<0,2>([&]<auto F>(){
+            if( ( c.method == choice_t::BARRF ) != bool(F) ) return;
+
+            typedef adam_barrier_t<double, pro_nn_t, typename pro_nn_t::variable_t,
+                    typename pro_nn_t::variable_t, bool(F)> solver_t;
+            solver_t solver(  solver_t::parameter_t{ opt.maxiter, opt.centralpathsteps,
+                        opt.diff, opt.threshold, opt.window, c.rho, c.alpha, opt.beta1, opt.beta2,
+                        opt.alphadec, opt.rhodec, 1e-8 } );
+
+            typename solver_t::main_statistics_t stats;
+            finish( solver, prob, std::move(init), stats );
+        });
+        break; }
+
+    case choice_t::BARRWOT:
+    case choice_t::BARRWOTF: {
+        typedef network_problem_log_barrier_wot_t<double, tanh_activation_t,
+                      cross_entropy_t, BATCH::value, INPUTS::value, HIDDEN1::value,
+                HIDDEN2::value, OUTPUTS::value> pro_nn_t ;
+
+        typename pro_nn_t::param_t tinit;
+        std::get<0>( tinit ) = blaze::uniform( HIDDEN1::value, 1e2 );
+        std::get<1>( tinit ) = blaze::uniform( HIDDEN2::value, 1e2 );
+
+        pro_nn_t prob ( cross_entropy_t<double>(), data, std::move(tinit), c.lipschitz );
+        prob.threads = opt.threads;
+
+        typename pro_nn_t::variable_t init;
+        { std::lock_guard<std::mutex> lock( setup );
+            init = generator_t<typename pro_nn_t::variable_t>::make( opt.initweights ); }
+
+        std::for_range<0,2>([&]<auto F>(){
+            if( ( c.method == choice_t::BARRWOTF ) != bool(F) ) return;
+
+            typedef adam_barrier_t<double, pro_nn_t, typename pro_nn_t::variable_t,
+                    typename pro_nn_t::variable_t, bool(F)> solver_t;
+            solver_t solver(  solver_t::parameter_t{ opt.maxiter, opt.centralpathsteps,
+                        opt.diff, opt.threshold, opt.window, c.rho, c.alpha, opt.beta1, opt.beta2,
+                        opt.alphadec, opt.rhodec, 1e-8 } );
+
+            typename solver_t::main_statistics_t stats;
+            finish( solver, prob, std::move(init), stats );
+        });
+        break; }
+
+    default:
+        throw std::string{"method is not available in the sweep: "} + std::to_string( c.method );
+    }
+
+    res.ok = true;
+    return res;
+}
+
+
+
+int main(int argc, char **argv)
+{
+    std::string datafile = "data.csv";
+    std::string summaryfile;
+    options_t opt;
+
+    std::vector<size_t> methods;
+    std::vector<double> lipschitz, rho, alpha;
+    size_t jobs = default_threads();
+    resources_t res;
+
+    bool show_help = false;
+    auto cli
+            = lyra::help(show_help)
+            | lyra::opt(datafile, "inputfile")
+                  ["-f"]["--file"]("read datapoints as csv from 'inputfile'; loaded once for all configurations")
+            | lyra::opt(opt.outdir, "outdir")
+                  ["-O"]["--outdir"]("directory of the models and statistics (default: .)")
+            | lyra::opt(summaryfile, "summaryfile")
+                  ["-s"]["--summary"]("save the final loss and time of every configuration to 'summaryfile'")
+            | lyra::opt(methods, "method")
+                  ["-M"]["--method"]("method of the grid (0,1,3,4,5,7,8); repeatable (default: 5)")
+            | lyra::opt(lipschitz, "lipschitz")
+                  ["-l"]["--lipschitz"]("enforced lipschitz constant of the grid; repeatable (default: 50)")
+            | lyra::opt(rho, "rho")
+                  ["-r"]["--rho"]("l2-regularisation or log det parameter of the grid; repeatable (default: 0.1)")
+            | lyra::opt(alpha, "alpha")
+                  ["-a"]["--alpha"]("stepsize of the grid; repeatable (default: 0.02)")
+            | lyra::opt(jobs, "jobs")
+                  ["-j"]["--jobs"]("configurations trained concurrently (default: hardware threads)")
+            | lyra::opt(opt.threads, "threads")
+                  ["--threads"]("threads of the backpropagation of every configuration (default: 1)")
+            | lyra::opt(res.blaze, "threads")
+                  ["--blaze-threads"]("threads of blaze (default: blaze default)")
+            | lyra::opt(res.solver, "threads")
+                  ["--solver-threads"]("threads of every mosek model (default: --threads)")
+            | lyra::opt(res.pin, "core")
+                  ["--pin"]("pin the process to consecutive cores starting at 'core', one per thread of the largest pool (default: off)")
+            | lyra::opt(opt.alphadec, "alphadec")
+                  ["-y"]["--alphadec"]("alphadec (default: 0.5)")
+            | lyra::opt(opt.diff, "diff")
+                  ["-d"]["--diff"]("stopping criterion (default: 1e-8)")
+            | lyra::opt(opt.threshold, "threshold")
+                  ["-t"]["--threshold"]("threshold for expo window loss decrease stopping criterion (default: 1e-8)")
+            | lyra::opt(opt.window, "window")
+                  ["-w"]["--window"]("window for expo window loss decrease stopping criterion (default: 300)")
+            | lyra::opt(opt.centralpathsteps, "centralpathsteps")
+                  ["-c"]["--steps"]("centralpathsteps (default: 5)")
+            | lyra::opt(opt.rhodec, "rhodec")
+                  ["-x"]["--rhodec"]("rhodec (default: 0.5)")
+            | lyra::opt(opt.tparam, "tparam")
+                  ["-k"]["--tparam"]("tparam for projection cp (default: 100)")
+            | lyra::opt(opt.maxiter, "maxiter")
+                  ["-m"]["--maxiter"]("max iteration steps (default: 1e5)")
+            | lyra::opt(opt.beta1, "beta1")
+                  ["-q"]["--beta1"]("adam beta1 param")
+            | lyra::opt(opt.beta2, "beta2")
+                  ["-p"]["--beta2"]("adam beta2 param")
+            | lyra::opt(opt.initweights, "initweights")
+                  ["-i"]["--initweights"]("initweights variance");
+
+    auto result = cli.parse({ argc, argv });
+    if (!result) {
+        std::cerr << "Error in command line: " << result.errorMessage() << std::endl;
+        std::cerr << cli << "\n";  return 1;
+    }
+
+    if (show_help) {
+        std::cout << cli << "\n";  return 0;
+    }
+
+    // every concurrent configuration gets its share of the cores, mosek included
+    res.workers = std::max<size_t>( 1, jobs ) * std::max<size_t>( 1, opt.threads );
+    if( res.solver == 0 ) res.solver = std::max<size_t>( 1, opt.threads );
+    configure( res );
+
+    if( methods.empty() ) methods = { choice_t::BARRWOT };
+    if( lipschitz.empty() ) lipschitz = { 50 };
+    if( rho.empty() ) rho = { 0.1 };
+    if( alpha.empty() ) alpha = { 0.02 };
+
+    std::vector<config_t> configs;
+    for( const auto m : methods ) for( const auto l : lipschitz )
+        for( const auto r : rho ) for( const auto a : alpha )
+            configs.push_back( config_t{ m, l, r, a } );
+
+
+    // one column layout copy of the samples, read by every configuration
+    auto opt_data = loader_t<double>::template load_network_data<INPUTS::value,OUTPUTS::value>( datafile, true, true );
+    if( !opt_data.has_value() ) {
+        std::cerr << "could not load file " << datafile << std::endl;
+        return 1;
+    }
+    const data_t data( std::move( opt_data.value() ) );
+
+    std::cout << configs.size() << " configurations, " << data->samples() << " samples, "
+              << std::min( jobs, configs.size() ) << " jobs\n";
+
+
+    std::vector<outcome_t> outcomes( configs.size() );
+    std::atomic<size_t> next{ 0 };
+    std::mutex setup, output;
+
+    // every job pulls the next configuration; the runs differ a lot in length
+    parallel_for( std::min( jobs, configs.size() ), jobs, [&]( size_t, size_t, size_t ) {
+        for( size_t k = next++; k < configs.size(); k = next++ ) {
+            try {
+                outcomes[k] = train( configs[k], opt, data, setup );
+            } catch( const std::string &e ) {
+                outcomes[k].config = configs[k]; outcomes[k].error = e;
+            } catch( const std::exception &e ) {
+                outcomes[k].config = configs[k]; outcomes[k].error = e.what();
+            }
+
+            std::lock_guard<std::mutex> lock( output );
+            const auto &o = outcomes[k];
+            std::cout << "[" << k+1 << "/" << configs.size() << "] " << o.config.name() << ": "
+                      << ( o.ok ? "loss " + std::to_string( o.loss ) + ", "
+                                  + std::to_string( o.time ) + " ms" : "failed, " + o.error ) << "\n" << std::flush;
+        }
+    });
+
+
+    if( !summaryfile.empty() ) {
+        std::ofstream oss( summaryfile );{
+            cereal::JSONOutputArchive archive(oss);
+            archive( cereal::make_nvp("file", datafile), cereal::make_nvp("runs", outcomes) );
+        } oss.close();
+    }
+
+    return std::all_of( outcomes.begin(), outcomes.end(), []( const outcome_t &o ){ return o.ok; } ) ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include <lipnet/network/activation.hpp>
+#include <lipnet/network/network.hpp>
+
+#include <lipnet/extern/nn_lipcalc.hpp>
+
+#include <lipnet/statistics.hpp>
+#include <lipnet/loader/loader.hpp>
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <lyra/lyra.hpp>
+
+using namespace lipnet;
+
+
+
+/// methods of lipnet_training; same values as choice_t there
+const std::vector<std::pair<int, std::string>> methods = {
+    { 0, "NOM" }, { 1, "L2" }, { 2, "PRO_SIMPLE" }, { 3, "PRO" }, { 4, "BARR" },
+    { 5, "BARRWOT" }, { 6, "BARRPRE" }, { 7, "BARRF" }, { 8, "BARRWOTF" },
+    { 9, "BARRPREF" }, { 10, "PROFO" }, { 11, "L2LBFGS" }, { 12, "BARRLBFGS" } };
+
+
+/// loss series and optimisation time of a run; the other statistics are ignored
+struct run_statistics_t {
+    series_t<double> loss;
+    long long time = 0;
+
+    template<class Archive> void serialize(Archive & archive)
+        {  archive( cereal::make_nvp("loss", loss),
+                    cereal::make_nvp("optimization-time", time) ); }
+};
+
+
+/// measurement of one method
+struct result_t {
+    int method = 0;
+    std::string name;
+    bool ok = false;            /// the training finished and wrote model and statistics
+    size_t evaluations = 0;     /// number of batch evaluations (entries of the loss series)
+    double seconds = 0;         /// optimisation time of the run
+    double wall = 0;            /// wall time of the process, including loading and the pretraining
+    double throughput = 0;      /// samples per second of the optimisation
+    double target_time = -1;    /// seconds until the loss first reached the target; -1 if never
+    double loss = 0;            /// final loss
+    double accuracy = 0;        /// accuracy on the dataset
+    double lipschitz = 0;       /// certified lipschitz constant
+
+    template<class Archive> void serialize(Archive & archive)
+        {  archive( cereal::make_nvp("method", method), cereal::make_nvp("name", name),
+                    cereal::make_nvp("ok", ok), cereal::make_nvp("evaluations", evaluations),
+                    cereal::make_nvp("optimization-seconds", seconds),
+                    cereal::make_nvp("wall-seconds", wall),
+                    cereal::make_nvp("samples-per-second", throughput),
+                    cereal::make_nvp("time-to-target", target_time),
+                    cereal::make_nvp("final-loss", loss),
+                    cereal::make_nvp("accuracy", accuracy),
+                    cereal::make_nvp("lipschitz", lipschitz) ); }
+};
+
+
+/**
+ * @brief write the pinned dataset; three classes of interleaved spiral arms in
+ *          [-1,1]^2. The samples only depend on the seed, the raw output of
+ *          mt19937 is scaled by hand to be independent of the standard library.
+ */
+
+void write_dataset( const std::string &path, const size_t samples, const unsigned seed ) {
+    std::mt19937 gen( seed );
+    const auto uniform = [&](){ return gen() / 4294967296.0; };
+
+    std::ofstream os( path );
+    os << std::setprecision(17);
+
+    for( size_t i = 0; i < samples; ++i ) {
+        const size_t label = i % 3;
+        const double r = uniform();
+        const double phi = 4.0*r + 2.0*M_PI*label/3.0 + 0.3*( uniform() - 0.5 );
+        os << r*std::cos( phi ) << "," << r*std::sin( phi ) << "," << label << "\n";
+    }
+}
+
+
+
+int main(int argc, char **argv)
+{
+    typedef network_t<double, tanh_activation_t, 2, 10, 10, 3> nn_t;
+
+    std::string training = "./lipnet_training";
+    std::string workdir = ".";
+    std::string outputfile;
+
+    std::vector<int> selected;
+    size_t samples = 2000;
+    size_t batch = 400;
+    size_t maxiter = 200;
+    size_t steps = 2;
+    unsigned seed = 1;
+    double target = 0.5;
+    double lipschitz = 50;
+
+    bool show_help = false;
+    auto cli
+            = lyra::help(show_help)
+            | lyra::opt(training, "executable")
+                  ["-e"]["--executable"]("path of lipnet_training (default: ./lipnet_training)")
+            | lyra::opt(workdir, "workdir")
+                  ["-w"]["--workdir"]("directory of the dataset, models and statistics (default: .)")
+            | lyra::opt(outputfile, "outputfile")
+                  ["-o"]["--output"]("write the results as json to 'outputfile'")
+            | lyra::opt(selected, "method")
+                  ["-M"]["--method"]("method to run; repeatable (default: all)")
+            | lyra::opt(samples, "samples")
+                  ["-n"]["--samples"]("samples of the synthetic dataset (default: 2000)")
+            | lyra::opt(batch, "batch")
+                  ["-b"]["--batch"]("batch size compiled into lipnet_training (default: 400)")
+            | lyra::opt(maxiter, "maxiter")
+                  ["-m"]["--maxiter"]("iterations of each run, per central path step (default: 200)")
+            | lyra::opt(steps, "steps")
+                  ["-c"]["--steps"]("central path steps of the barrier methods (default: 2)")
+            | lyra::opt(seed, "seed")
+                  ["-r"]["--seed"]("seed of the synthetic dataset (default: 1)")
+            | lyra::opt(target, "target")
+                  ["-t"]["--target"]("target loss of the time-to-target (default: 0.5)")
+            | lyra::opt(lipschitz, "lipschitz")
+                  ["-l"]["--lipschitz"]("enforced lipschitz constant (default: 50)");
+
+    auto result = cli.parse({ argc, argv });
+    if (!result) {
+        std::cerr << "Error in command line: " << result.errorMessage() << std::endl;
+        std::cerr << cli << "\n";  return 1;
+    }
+
+    if (show_help) {
+        std::cout << cli << "\n";  return 0;
+    }
+
+
+    const std::string datafile = workdir + "/throughput-data.csv";
+    write_dataset( datafile, samples, seed );
+
+    auto data = loader_t<double>::template load_network_data<2,3>( datafile, true, true ).value();
+
+    std::vector<result_t> results;
+    for( const auto &[ method, name ] : methods ) {
+        if( !selected.empty() && std::find( selected.begin(), selected.end(), method ) == selected.end() )
+            continue;
+
+        result_t res; res.method = method; res.name = name;
+
+        const std::string prefix = workdir + "/throughput-" + name;
+        const std::string command = "'" + training + "' -f '" + datafile + "' -o '" + prefix + "-model.json'"
+                + " -s '" + prefix + "-stats.json' -m " + std::to_string( maxiter )
+                + " -c " + std::to_string( steps ) + " -l " + std::to_string( lipschitz )
+                + " " + std::to_string( method ) + " > '" + prefix + ".log' 2>&1";
+
+        std::cout << "running " << name << " ...\n" << std::flush;
+
+        const auto t1 = std::chrono::steady_clock::now();
+        const int status = std::system( command.c_str() );
+        const auto t2 = std::chrono::steady_clock::now();
+        res.wall = std::chrono::duration<double>( t2 - t1 ).count();
+
+        if( status != 0 ) {
+            std::cerr << name << " failed, see " << prefix << ".log\n";
+            results.push_back( res ); continue;
+        }
+
+        try {
+            run_statistics_t stats;
+            std::ifstream is( prefix + "-stats.json" );
+            {
+                cereal::JSONInputArchive archive( is );
+                archive( cereal::make_nvp("run", stats) );
+            }
+
+            nn_t nn;
+            std::ifstream ms( prefix + "-model.json" );
+            {
+                cereal::JSONInputArchive archive( ms );
+                archive( cereal::make_nvp("model", nn) );
+            }
+
+            const auto &loss = stats.loss.data;
+            res.evaluations = loss.size();
+            res.seconds = stats.time / 1000.0;
+            res.throughput = res.seconds > 0 ? res.evaluations * batch / res.seconds : 0;
+            res.loss = loss.empty() ? 0 : loss.back();
+
+            // the loss is recorded once per evaluation; the time of an evaluation is taken as constant
+            const auto hit = std::find_if( loss.begin(), loss.end(), [&]( const double l ){ return l <= target; } );
+            if( hit != loss.end() )
+                res.target_time = res.seconds * ( hit - loss.begin() + 1 ) / loss.size();
+
+            const auto outputs = nn.query_batch( data.icols, default_threads() );
+            size_t correct = 0;
+            for( size_t i = 0; i < data.samples(); ++i )
+                correct += blaze::argmax( blaze::column( outputs, i ) ) == data.labels[i];
+            res.accuracy = double( correct ) / data.samples();
+
+            res.lipschitz = std::get<0>( network_libcalc_t<double, 2, 10, 10, 3>::solve( nn.layers ) );
+            res.ok = true;
+        } catch( const std::exception &e ) {
+            std::cerr << name << ": could not read the results: " << e.what() << "\n";
+        } catch( const std::string &e ) {
+            std::cerr << name << ": could not read the results: " << e << "\n";
+        }
+
+        results.push_back( res );
+    }
+
+
+    std::cout << "\n" << std::left << std::setw(12) << "method" << std::right
+              << std::setw(8) << "evals" << std::setw(12) << "opt s" << std::setw(12) << "wall s"
+              << std::setw(14) << "samples/s" << std::setw(12) << "target s"
+              << std::setw(12) << "loss" << std::setw(10) << "acc" << std::setw(12) << "lipschitz" << "\n";
+    for( const auto &r : results )
+        std::cout << std::left << std::setw(12) << r.name << std::right
+                  << std::setw(8) << r.evaluations << std::setw(12) << r.seconds
+                  << std::setw(12) << r.wall << std::setw(14) << r.throughput
+                  << std::setw(12) << r.target_time << std::setw(12) << r.loss
+                  << std::setw(10) << r.accuracy << std::setw(12) << r.lipschitz
+                  << ( r.ok ? "" : "  (failed)" ) << "\n";
+
+    if( !outputfile.empty() ) {
+        std::ofstream os( outputfile );
+        {
+            cereal::JSONOutputArchive archive( os );
+            archive( cereal::make_nvp("samples", samples), cereal::make_nvp("seed", seed),
+                     cereal::make_nvp("maxiter", maxiter), cereal::make_nvp("target", target),
+                     cereal::make_nvp("results", results) );
+        }
+        os.close();
+    }
+
+    return std::all_of( results.begin(), results.end(), []( const result_t &r ){ return r.ok; } ) ? 0 : 1;
+}
@@ -40,10 +40,12 @@
 
 #include <lipnet/optimizer.hpp>
 #include <lipnet/statistics.hpp>
+#include <lipnet/distributed.hpp>
 
 #include <lipnet/loader/loader.hpp>
 
 #include <lipnet/lipschitz/barrier.hpp>
+#include <lipnet/lipschitz/trivial.hpp>
 
 #include <cereal/types/vector.hpp>
 #include <lyra/lyra.hpp>
@@ -61,24 +63,19 @@ enum choice_t : size_t {
     BARRPRE = 6,
     BARRF = 7,
     BARRWOTF = 8,
-    BARRPREF = 9
+    BARRPREF = 9,
+    PROFO = 10,
+    L2LBFGS = 11,
+    BARRLBFGS = 12
 };
 
 template<size_t I, size_t O>
 auto load_data( const std::string &filename ) {
-    network_data_t<double,I,O> data;
-
-    auto opt = loader_t<double>::load(filename);
+    auto opt = loader_t<double>::template load_network_data<I,O>( filename, true, true );
     if( !opt.has_value() )
         throw std::string{"could not load file"};
 
-    data.idata = blaze::trans( blaze::submatrix( opt.value(), 0, 0,
-                           I, opt.value().columns() ));
-
-    auto last = blaze::row( opt.value(), I );
-    data.tdata = blaze::trans( make_one_hot<double>( blaze::trans(last), O ) );
-
-    return std::move(data);
+    return std::move( opt.value() );
 }
 
 
@@ -86,6 +83,10 @@ auto load_data( const std::string &filename ) {
 
 template<typename NN>
 int dumptodisk( const std::string &path, const std::string &name, NN &nn ) {
+    // one writer in data parallel runs
+    if( default_communicator() && !default_communicator()->root() )
+        return 0;
+
     std::ofstream oss( path );
     {
         cereal::JSONOutputArchive archive(oss);
@@ -97,6 +98,9 @@ int dumptodisk( const std::string &path, const std::string &name, NN &nn ) {
 
 int main(int argc, char **argv)
 {
+    // mpi ranks of a data parallel run (LIPNET_MPI); a single process otherwise
+    environment_t env( argc, argv );
+
     typedef std::integral_constant<size_t,2>  INPUTS;
     typedef std::integral_constant<size_t,10> HIDDEN1;
     typedef std::integral_constant<size_t,10> HIDDEN2;
@@ -131,6 +135,17 @@ int main(int argc, char **argv)
     size_t maxiter = 1e5;
 
     int method = choice_t::NOM;
+    bool streaming = false;
+
+    checkpoint_t checkpoint;
+    std::string tracefile;
+    size_t traceevery = 1;
+
+    size_t lipevery = 0;
+    double lipstop = 0;
+    size_t backtracking = 0;
+    size_t memory = 10;
+    resources_t res;
 
     bool show_help = false;
     auto cli
@@ -171,6 +186,32 @@ int main(int argc, char **argv)
                   ["-p"]["--beta2"]("adam beta2 param")
             | lyra::opt(initweights, "initweights")
                   ["-i"]["--initweights"]("initweights variance")
+            | lyra::opt(streaming)
+                  ["-S"]["--stream"]("stream the batches from 'inputfile' (csv or .bin) instead of loading it; method 0 only")
+            | lyra::opt(checkpoint.path, "checkpointfile")
+                  ["-C"]["--checkpoint"]("checkpoint the barrier methods to 'checkpointfile' and resume from it if it exists")
+            | lyra::opt(checkpoint.every, "iterations")
+                  ["--checkpoint-every"]("iterations between two checkpoints (default: 1000)")
+            | lyra::opt(tracefile, "tracefile")
+                  ["--trace"]("stream the barrier (and projected) loss per iteration to 'tracefile' (binary, or csv if it ends with .csv) instead of keeping it in 'statsfile'")
+            | lyra::opt(traceevery, "n")
+                  ["--trace-every"]("keep every n-th record of the trace (default: 1)")
+            | lyra::opt(lipevery, "n")
+                  ["--lipschitz-every"]("estimate the product of the spectral norms every n iterations (default: 0, never)")
+            | lyra::opt(lipstop, "bound")
+                  ["--lipschitz-stop"]("stop once the estimate exceeds 'bound' (default: 0, never)")
+            | lyra::opt(backtracking, "halvings")
+                  ["--backtracking"]("halve a barrier step at most 'halvings' times until chi (without numerical offset) has a cholesky decomposition (default: 0, off)")
+            | lyra::opt(memory, "pairs")
+                  ["--memory"]("correction pairs of the l-bfgs methods (default: 10)")
+            | lyra::opt(res.workers, "threads")
+                  ["--workers"]("lipnet worker threads, e.g. of the backpropagation (default: hardware threads)")
+            | lyra::opt(res.blaze, "threads")
+                  ["--blaze-threads"]("threads of blaze (default: blaze default)")
+            | lyra::opt(res.solver, "threads")
+                  ["--solver-threads"]("threads of every mosek model (default: mosek decides)")
+            | lyra::opt(res.pin, "core")
+                  ["--pin"]("pin the process to consecutive cores starting at 'core', one per thread of the largest pool (default: off)")
             | lyra::arg( method, "method").help("method to train the network  (default: 5, only barrier) ")
                     .required();
 
@@ -184,11 +225,43 @@ int main(int argc, char **argv)
         std::cout << cli << "\n";  return 0;
     }
 
+    configure( res );
+
+    auto comm = std::make_shared<const communicator_t>();
+    if( comm->size() > 1 ) {
+        const bool supported = method == choice_t::NOM || method == choice_t::L2
+                || method == choice_t::BARR || method == choice_t::BARRF
+                || method == choice_t::L2LBFGS || method == choice_t::BARRLBFGS;
+        if( !supported || streaming || !checkpoint.path.empty() ) {
+            if( comm->root() )
+                std::cerr << "data parallel runs support the methods 0, 1, 4, 7, 11 and 12"
+                             " without streaming and checkpoints" << std::endl;
+            return 1;
+        }
+
+        // same initial weights on every rank; the seed of the root rank
+        blaze::setSeed( uint32_t( comm->broadcast_value( int( blaze::getSeed() ) ) ) );
+        if( !comm->root() ) tracefile.clear();
+        default_communicator() = comm;
+    }
+
+    std::shared_ptr<statistics_sink_t<double>> trace;
+    if( !tracefile.empty() )
+        trace = std::make_shared<statistics_sink_t<double>>( tracefile, traceevery, 4096,
+                                                             !checkpoint.path.empty() );
+
 
     typedef network_t<double, tanh_activation_t, INPUTS::value, HIDDEN1::value,
                 HIDDEN2::value, OUTPUTS::value> nn_t;
 
-    auto data = load_data<INPUTS::value,OUTPUTS::value>( datafile );
+    if( streaming && method != choice_t::NOM ) {
+        std::cerr << "streaming is only supported by method 0" << std::endl;
+        return 1;
+    }
+
+    network_data_t<double, INPUTS::value, OUTPUTS::value> data;
+    if( !streaming )
+        data = shard( load_data<INPUTS::value,OUTPUTS::value>( datafile ), comm->rank(), comm->size() );
     auto nn = nn_t();
 
     switch ( method ) {
@@ -201,7 +274,9 @@ int main(int argc, char **argv)
                 typename pro_nn_t::variable_t> solver_t;
 
         solver_t solver( solver_t::parameter_t{ maxiter, diff, 1e-4, alpha, beta1, beta2, 1e-8} );
-        pro_nn_t prob ( cross_entropy_t<double>(), std::move(data)  );
+        pro_nn_t prob = streaming
+                ? pro_nn_t( cross_entropy_t<double>(), pro_nn_t::stream_t::open( datafile, BATCH::value ) )
+                : pro_nn_t( cross_entropy_t<double>(), std::move(data) );
 
         typename pro_nn_t::variable_t init = generator_t<
                 typename pro_nn_t::variable_t>::make( initweights );
@@ -270,6 +345,34 @@ int main(int argc, char **argv)
                  typename pro_nn_t::variable_t> solver_t;
 
         solver_t solver( solver_t::parameter_t{ maxiter, diff, threshold, window, alpha, beta1, beta2, 1e-8 } );
+        solver.param.lipschitz_every = lipevery;
+        solver.param.lipschitz_stop = lipstop;
+        solver.sink = trace;
+        pro_nn_t prob ( cross_entropy_t<double>(), std::move(data), lipschitz, tparam );
+
+        typename pro_nn_t::variable_t init = generator_t<
+                typename pro_nn_t::variable_t>::make( initweights );
+        typename solver_t::main_statistics_t stats;
+        auto [ weights, value ] = solver( prob, std::move(init), stats );
+        nn.layers = weights;
+
+        dumptodisk(modelfile, "model", nn);
+        dumptodisk(statsfile, "run", stats);
+
+        break; }
+
+    case choice_t::PROFO: {
+        typedef network_problem_projection_fo_t<double, tanh_activation_t,
+             cross_entropy_t, BATCH::value,INPUTS::value, HIDDEN1::value,
+             HIDDEN2::value, OUTPUTS::value> pro_nn_t;
+
+        typedef adam_projected_t<double, pro_nn_t, typename pro_nn_t::variable_t,
+                 typename pro_nn_t::variable_t> solver_t;
+
+        solver_t solver( solver_t::parameter_t{ maxiter, diff, threshold, window, alpha, beta1, beta2, 1e-8 } );
+        solver.param.lipschitz_every = lipevery;
+        solver.param.lipschitz_stop = lipstop;
+        solver.sink = trace;
         pro_nn_t prob ( cross_entropy_t<double>(), std::move(data), lipschitz, tparam );
 
         typename pro_nn_t::variable_t init = generator_t<
@@ -298,6 +401,11 @@ int main(int argc, char **argv)
 
         solver_t solver( solver_t::parameter_t{ maxiter, centralpathsteps,
                                         diff, threshold, window, rho ,alpha, beta1, beta2, alphadec, rhodec, 1e-8 } );
+        solver.param.checkpoint = checkpoint;
+        solver.param.lipschitz_every = lipevery;
+        solver.param.lipschitz_stop = lipstop;
+        solver.param.backtracking = backtracking;
+        solver.sink = trace;
         pro_nn_t prob ( cross_entropy_t<double>(), std::move(data), std::move(tinit), lipschitz );
 
         typename pro_nn_t::variable_t init = generator_t<
@@ -326,10 +434,8 @@ int main(int argc, char **argv)
         psolver_t psolver( psolver_t::parameter_t{ maxiter, diff, 1e-4, alpha, beta1, beta2, 1e-8 },
                          [&](const double &fx, const typename ppro_nn_t::variable_t &var,
                             const typename ppro_nn_t::variable_t &grad) -> bool {
-                                double L = 1.0; std::for_range<0,3>([&]<auto I>(){
-                                   auto &w = std::get<I>(var).weight;
-                                   L *= blaze::max( blaze::reduce<blaze::columnwise>(blaze::abs(w), blaze::Add())); });
-                                return L < lipschitz;
+                                return calculate_lipschitz_t<double, INPUTS::value, HIDDEN1::value, HIDDEN2::value,
+                                        OUTPUTS::value>::column_sum_lipschitz( var ) < lipschitz;
                          });
         ppro_nn_t pprob ( cross_entropy_t<double>(), std::move(pdata)  );
 
@@ -350,6 +456,11 @@ int main(int argc, char **argv)
 
         solver_t solver(  solver_t::parameter_t{ maxiter, centralpathsteps,
                     diff, threshold, window, rho, alpha, beta1, beta2, alphadec, rhodec, 1e-8 } );
+        solver.param.checkpoint = checkpoint;
+        solver.param.lipschitz_every = lipevery;
+        solver.param.lipschitz_stop = lipstop;
+        solver.param.backtracking = backtracking;
+        solver.sink = trace;
         pro_nn_t prob ( cross_entropy_t<double>(), std::move(data), lipschitz );
 
         typename pro_nn_t::variable_t init = generator_t<
@@ -387,6 +498,11 @@ int main(int argc, char **argv)
 
         solver_t solver(  solver_t::parameter_t{ maxiter, centralpathsteps,
                     diff, threshold, window, rho, alpha, beta1, beta2, alphadec, rhodec, 1e-8 } );
+        solver.param.checkpoint = checkpoint;
+        solver.param.lipschitz_every = lipevery;
+        solver.param.lipschitz_stop = lipstop;
+        solver.param.backtracking = backtracking;
+        solver.sink = trace;
         pro_nn_t prob ( cross_entropy_t<double>(), std::move(data), lipschitz );
 
         typename pro_nn_t::variable_t init = generator_t<
@@ -410,6 +526,11 @@ int main(int argc, char **argv)
 
         solver_t solver(  solver_t::parameter_t{ maxiter, centralpathsteps,
                  diff, threshold, window, rho, alpha, beta1, beta2, alphadec, rhodec, 1e-8 } );
+        solver.param.checkpoint = checkpoint;
+        solver.param.lipschitz_every = lipevery;
+        solver.param.lipschitz_stop = lipstop;
+        solver.param.backtracking = backtracking;
+        solver.sink = trace;
         pro_nn_t prob ( cross_entropy_t<double>(), std::move(data), lipschitz );
 
         typename pro_nn_t::variable_t init = generator_t<
@@ -438,6 +559,11 @@ int main(int argc, char **argv)
 
         solver_t solver( solver_t::parameter_t{ maxiter, centralpathsteps,
                       diff, threshold, window, rho ,alpha, beta1, beta2, alphadec, rhodec, 1e-8 } );
+        solver.param.checkpoint = checkpoint;
+        solver.param.lipschitz_every = lipevery;
+        solver.param.lipschitz_stop = lipstop;
+        solver.param.backtracking = backtracking;
+        solver.sink = trace;
         pro_nn_t prob ( cross_entropy_t<double>(), std::move(data), std::move(tinit), lipschitz );
 
         typename pro_nn_t::variable_t init = generator_t<
@@ -467,10 +593,8 @@ int main(int argc, char **argv)
          psolver_t psolver( psolver_t::parameter_t{ maxiter, diff, 1e-4, alpha, beta1, beta2, 1e-8 },
                  [&](const double &fx, const typename ppro_nn_t::variable_t &var,
                      const typename ppro_nn_t::variable_t &grad) -> bool {
-                          double L = 1.0; std::for_range<0,3>([&]<auto I>(){
-                          auto &w = std::get<I>(var).weight;
-                          L *= blaze::max( blaze::reduce<blaze::columnwise>(blaze::abs(w), blaze::Add())); });
-                          return L < lipschitz;
+                          return calculate_lipschitz_t<double, INPUTS::value, HIDDEN1::value, HIDDEN2::value,
+                                        OUTPUTS::value>::column_sum_lipschitz( var ) < lipschitz;
                                  });
 
          ppro_nn_t pprob ( cross_entropy_t<double>(), std::move(pdata)  );
@@ -492,6 +616,11 @@ int main(int argc, char **argv)
 
          solver_t solver(  solver_t::parameter_t{ maxiter, centralpathsteps,
                       diff, threshold, window, rho, alpha, beta1, beta2, alphadec, rhodec, 1e-8 } );
+         solver.param.checkpoint = checkpoint;
+         solver.param.lipschitz_every = lipevery;
+         solver.param.lipschitz_stop = lipstop;
+         solver.param.backtracking = backtracking;
+         solver.sink = trace;
 
          pro_nn_t prob ( cross_entropy_t<double>(), std::move(data), lipschitz );
 
@@ -517,6 +646,51 @@ int main(int argc, char **argv)
                 //dumptodisk(statsfile, "prerun", pstats);
          break; }
 
+    case choice_t::L2LBFGS: {
+
+        typedef network_problem_batch_l2_t<double, tanh_activation_t,
+                      cross_entropy_t, BATCH::value, INPUTS::value, HIDDEN1::value,
+                    HIDDEN2::value, OUTPUTS::value> pro_nn_t ;
+        typedef lbfgs_t<double, pro_nn_t, typename pro_nn_t::variable_t,
+                typename pro_nn_t::variable_t> solver_t;
+
+        solver_t solver( solver_t::parameter_t{ maxiter, memory, 1, 1e-6, diff, 1.0, 1.0 } );
+        pro_nn_t prob ( cross_entropy_t<double>(), std::move(data) , rho );
+
+        typename pro_nn_t::variable_t init = generator_t<
+                typename pro_nn_t::variable_t>::make( initweights );
+        typename solver_t::main_statistics_t stats;
+        auto [ weights, value ] = solver( prob, std::move(init), stats );
+        nn.layers = weights;
+
+        dumptodisk(modelfile, "model", nn);
+        dumptodisk(statsfile, "run", stats);
+
+        break; }
+
+    case choice_t::BARRLBFGS: {
+
+        typedef network_problem_log_barrier_t<double, tanh_activation_t,
+                      cross_entropy_t, BATCH::value, INPUTS::value, HIDDEN1::value,
+                HIDDEN2::value, OUTPUTS::value> pro_nn_t ;
+
+        typedef lbfgs_t<double, pro_nn_t, typename pro_nn_t::variable_t,
+                typename pro_nn_t::variable_t> solver_t;
+
+        solver_t solver( solver_t::parameter_t{ maxiter, memory, centralpathsteps,
+                    1e-6, diff, rho, rhodec } );
+        pro_nn_t prob ( cross_entropy_t<double>(), std::move(data), lipschitz );
+
+        typename pro_nn_t::variable_t init = generator_t<
+                typename pro_nn_t::variable_t>::make( initweights, 0.1 );
+        typename solver_t::main_statistics_t stats;
+        auto [ weights, value ] = solver( prob, std::move(init), stats );
+        nn.layers = weights.W;
+
+        dumptodisk(modelfile, "model", nn);
+        dumptodisk(statsfile, "run", stats);
+
+        break; }
 
     }
 
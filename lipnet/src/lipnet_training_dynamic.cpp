@@ -0,0 +1,323 @@
+/*
+ * Copyright 2020 Niklas Funcke <niklas.funcke@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+
+#include <lipnet/network/activation.hpp>
+#include <lipnet/network/loss.hpp>
+
+#include <lipnet/dynamic/network.hpp>
+
+#include <lipnet/problem/nn_problem_dynamic_batch.hpp>
+#include <lipnet/problem/nn_problem_dynamic_barrier.hpp>
+
+#include <lipnet/extern/nn_lipcalc_dynamic.hpp>
+
+#include <lipnet/optimizer.hpp>
+#include <lipnet/statistics.hpp>
+
+#include <lipnet/loader/loader.hpp>
+#include <lipnet/loader/binary.hpp>
+
+#include <cereal/types/vector.hpp>
+#include <lyra/lyra.hpp>
+
+using namespace lipnet;
+
+
+enum choice_t : size_t {
+    NOM = 0,
+    BARR = 4,
+    BARRPRE = 6
+};
+
+
+auto load_data( const std::string &filename, const size_t outputs ) {
+    auto opt = ( filename.size() > 4 && filename.substr( filename.size()-4 ) == ".bin" )
+            ? binary_loader_t<double>::load_dynamic_data( filename )
+            : loader_t<double>::load_dynamic_data( filename, outputs, true, true );
+    if( !opt.has_value() )
+        throw std::string{"could not load file"};
+
+    return std::move( opt.value() );
+}
+
+
+
+
+template<typename NN>
+int dumptodisk( const std::string &path, const std::string &name, NN &nn ) {
+    std::ofstream oss( path );
+    {
+        cereal::JSONOutputArchive archive(oss);
+        archive( cereal::make_nvp(name, nn) );
+    }
+    oss.close();
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    typedef dynamic_network_t<double, tanh_activation_t> nn_t;
+
+    std::string datafile = "data.csv";
+    std::string modelfile = "model.json";
+    std::string statsfile = "stats.json";
+    std::string initfile;
+    std::string topology = "2,10,10,3";
+
+    double lipschitz = 50;
+    double alpha = 0.02;
+
+    double diff = 1e-8;
+    double threshold = 1e-8;
+    size_t window = 300;
+
+    size_t centralpathsteps = 5;
+    double rho = 0.1;
+    double beta = 5;
+
+    double rhodec = 0.5;
+    double alphadec = 0.5;
+
+    double beta1 = 0.9;
+    double beta2 = 0.999;
+
+    double initweights = 0.1;
+
+    size_t maxiter = 1e5;
+    size_t batch = 400;
+
+    int method = choice_t::NOM;
+    bool feasibility = false;
+
+    checkpoint_t checkpoint;
+    std::string tracefile;
+    size_t traceevery = 1;
+
+    bool show_help = false;
+    auto cli
+            = lyra::help(show_help)
+            | lyra::opt(datafile, "inputfile")
+                  ["-f"]["--file"]("read datapoints as csv or .bin from 'inputfile'")
+            | lyra::opt(modelfile, "modelfile")
+                  ["-o"]["--output"]("save model as json to 'modelfile'")
+            | lyra::opt(statsfile, "statsfile")
+                  ["-s"]["--stats"]("save statistics about optimization to 'statsfile'")
+            | lyra::opt(topology, "topology")
+                  ["-T"]["--topology"]("neurons at each layer, e.g. 2,10,10,3 (default: 2,10,10,3)")
+            | lyra::opt(initfile, "initfile")
+                  ["-I"]["--init"]("start from the model in 'initfile'; its topology replaces --topology")
+            | lyra::opt(batch, "batch")
+                  ["-n"]["--batch"]("batch size; 0 uses the whole dataset (default: 400)")
+            | lyra::opt(lipschitz, "lipschitz")
+                  ["-l"]["--lipschitz"]("set enforceing lipschitz constant")
+            | lyra::opt(alpha, "alpha")
+                  ["-a"]["--alpha"]("set stepsize alpha (default: 0.02)")
+            | lyra::opt(alphadec, "alphadec")
+                  ["-y"]["--alphadec"]("alphadec (default: 0.5)")
+            | lyra::opt(diff, "diff")
+                  ["-d"]["--diff"]("stopping criterion (default: 1e-8)")
+            | lyra::opt(threshold, "threshold")
+                  ["-t"]["--threshold"]("threshold for expo window loss decrease stopping criterion (default: 1e-8)")
+            | lyra::opt(window, "window")
+                  ["-w"]["--window"]("window for expo window loss decrease stopping criterion (default: 300)")
+            | lyra::opt(centralpathsteps, "centralpathsteps")
+                  ["-c"]["--steps"]("centralpathsteps (default: 5)")
+            | lyra::opt(rho, "rho")
+                  ["-r"]["--rho"]("log det parameter (default: 0.1)")
+            | lyra::opt(rhodec, "rhodec")
+                  ["-x"]["--rhodec"]("rhodec (default: 0.5)")
+            | lyra::opt(maxiter, "maxiter")
+                  ["-m"]["--maxiter"]("max iteration steps (default: 1e5)")
+            | lyra::opt(beta, "beta")
+                  ["-b"]["--beta"]("decrease parameter for trivial stopping criterion")
+            | lyra::opt(beta1, "beta1")
+                  ["-q"]["--beta1"]("adam beta1 param")
+            | lyra::opt(beta2, "beta2")
+                  ["-p"]["--beta2"]("adam beta2 param")
+            | lyra::opt(initweights, "initweights")
+                  ["-i"]["--initweights"]("initweights variance")
+            | lyra::opt(feasibility)
+                  ["-F"]["--feasibility"]("check the feasibility of every barrier step")
+            | lyra::opt(checkpoint.path, "checkpointfile")
+                  ["-C"]["--checkpoint"]("checkpoint the barrier methods to 'checkpointfile' and resume from it if it exists")
+            | lyra::opt(checkpoint.every, "iterations")
+                  ["--checkpoint-every"]("iterations between two checkpoints (default: 1000)")
+            | lyra::opt(tracefile, "tracefile")
+                  ["--trace"]("stream the barrier loss per iteration to 'tracefile' (binary, or csv if it ends with .csv) instead of keeping it in 'statsfile'")
+            | lyra::opt(traceevery, "n")
+                  ["--trace-every"]("keep every n-th record of the trace (default: 1)")
+            | lyra::arg( method, "method").help("method to train the network: 0 nominal, 4 barrier, "
+                                                "6 barrier after nominal pretraining (default: 0)")
+                    .required();
+
+    auto result = cli.parse({ argc, argv });
+    if (!result) {
+        std::cerr << "Error in command line: " << result.errorMessage() << std::endl;
+        std::cerr << cli << "\n";  return 1;
+    }
+
+    if (show_help) {
+        std::cout << cli << "\n";  return 0;
+    }
+
+    std::shared_ptr<statistics_sink_t<double>> trace;
+    if( !tracefile.empty() )
+        trace = std::make_shared<statistics_sink_t<double>>( tracefile, traceevery, 4096,
+                                                             !checkpoint.path.empty() );
+
+
+    nn_t nn;
+    if( !initfile.empty() ) {
+        std::ifstream is( initfile );
+        {
+            cereal::JSONInputArchive archive(is);
+            archive( cereal::make_nvp("model", nn) );
+        }
+        is.close();
+    } else {
+        nn = nn_t( parse_topology( topology ), initweights );
+    }
+
+    std::cout << "topology:";
+    for( const auto n : nn.topology ) std::cout << " " << n;
+    std::cout << "\n";
+
+    auto data = load_data( datafile, nn.topology.back() );
+
+
+    typedef network_problem_dynamic_batch_t<double, tanh_activation_t, cross_entropy_t> pro_nom_t;
+    typedef network_problem_dynamic_log_barrier_t<double, tanh_activation_t, cross_entropy_t> pro_barr_t;
+
+    const auto barrier = [&]( auto &&prob, typename pro_barr_t::variable_t &&init, auto &stats ) {
+        typedef typename std::decay<decltype(prob)>::type prob_t;
+
+        if( feasibility ) {
+            typedef adam_barrier_t<double, prob_t, typename prob_t::variable_t,
+                    typename prob_t::variable_t, true> solver_t;
+            solver_t solver( typename solver_t::parameter_t{ maxiter, centralpathsteps,
+                        diff, threshold, window, rho, alpha, beta1, beta2, alphadec, rhodec, 1e-8 } );
+            solver.param.checkpoint = checkpoint;
+            solver.sink = trace;
+
+            typename solver_t::main_statistics_t s;
+            auto res = solver( prob, std::move(init), s );
+            stats( s ); return std::get<0>( std::move(res) );
+        }
+
+        typedef adam_barrier_t<double, prob_t, typename prob_t::variable_t,
+                typename prob_t::variable_t> solver_t;
+        solver_t solver( typename solver_t::parameter_t{ maxiter, centralpathsteps,
+                    diff, threshold, window, rho, alpha, beta1, beta2, alphadec, rhodec, 1e-8 } );
+        solver.param.checkpoint = checkpoint;
+        solver.sink = trace;
+
+        typename solver_t::main_statistics_t s;
+        auto res = solver( prob, std::move(init), s );
+        stats( s ); return std::get<0>( std::move(res) );
+    };
+
+    const auto dumpstats = [&]( const auto &s ) { dumptodisk( statsfile, "run", s ); };
+
+
+    switch ( method ) {
+    case choice_t::NOM: {
+
+        typedef adam_momentum_t<double, pro_nom_t, typename pro_nom_t::variable_t,
+                typename pro_nom_t::variable_t> solver_t;
+
+        solver_t solver( solver_t::parameter_t{ maxiter, diff, 1e-4, alpha, beta1, beta2, 1e-8} );
+        pro_nom_t prob( cross_entropy_t<double>(), nn.topology, std::move(data), batch );
+
+        typename solver_t::main_statistics_t stats;
+        auto [ weights, value ] = solver( prob, std::move(nn.layers), stats );
+        nn.layers = std::move(weights);
+
+        dumptodisk(modelfile, "model", nn);
+        dumptodisk(statsfile, "run", stats);
+
+        break; }
+
+    case choice_t::BARR: {
+
+        pro_barr_t prob( cross_entropy_t<double>(), nn.topology, std::move(data), lipschitz, batch );
+
+        auto init = generator_t<typename pro_barr_t::variable_t>::make( nn.topology, initweights, 0.1 );
+        if( !initfile.empty() ) init.W = nn.layers;
+
+        nn.layers = barrier( prob, std::move(init), dumpstats ).W;
+        dumptodisk(modelfile, "model", nn);
+
+        break; }
+
+    case choice_t::BARRPRE: {
+
+        typedef adam_momentum_t<double, pro_nom_t, typename pro_nom_t::variable_t,
+                  typename pro_nom_t::variable_t> psolver_t;
+
+        const double lip = lipschitz;
+        psolver_t psolver( psolver_t::parameter_t{ maxiter, diff, 1e-4, alpha, beta1, beta2, 1e-8 },
+                         [lip](const double &fx, const typename pro_nom_t::variable_t &var,
+                               const typename pro_nom_t::variable_t &grad) -> bool {
+                                double L = 1.0;
+                                for( const auto &layer : var )
+                                    L *= blaze::max( blaze::reduce<blaze::columnwise>(blaze::abs(layer.weight), blaze::Add()));
+                                return L < lip;
+                         });
+
+        pro_nom_t pprob( cross_entropy_t<double>(), nn.topology, load_data( datafile, nn.topology.back() ), batch );
+
+        psolver_t::main_statistics_t pstats;
+        auto [ w, v ] = psolver( pprob, std::move(nn.layers), pstats );
+        auto [ L, tparam ] = dynamic_network_libcalc_t<double>::solve( w );
+        std::cout << "pretrainig finished:  => L: " << L << "\n";
+
+
+        pro_barr_t prob( cross_entropy_t<double>(), nn.topology, std::move(data), lipschitz, batch );
+
+        auto init = generator_t<typename pro_barr_t::variable_t>::make( nn.topology, initweights, 0.1 );
+        init.W = std::move(w);
+
+        size_t offset = 0;
+        for( auto &t : init.t ) {
+            t = blaze::subvector( tparam, offset, t.size() );
+            offset += t.size();
+        }
+
+        nn.layers = barrier( prob, std::move(init), [&]( const auto &s ) {
+            std::ofstream oss( statsfile );{
+                cereal::JSONOutputArchive archive(oss);
+                archive( cereal::make_nvp("prerun", pstats) );
+                archive( cereal::make_nvp("run", s) );
+            } oss.close();
+        } ).W;
+
+        dumptodisk(modelfile, "model", nn);
+
+        break; }
+
+    default:
+        std::cerr << "unknown method " << method << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
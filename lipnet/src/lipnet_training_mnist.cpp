@@ -40,6 +40,7 @@
 
 #include <lipnet/loader/loader.hpp>
 #include <lipnet/loader/container.hpp>
+#include <lipnet/loader/binary.hpp>
 
 #include <lipnet/lipschitz/barrier.hpp>
 
@@ -49,6 +50,14 @@
 using namespace lipnet;
 
 
+/// numerical type of the training; e.g. -DLIPNET_VALUE_TYPE=float
+#ifndef LIPNET_VALUE_TYPE
+#define LIPNET_VALUE_TYPE double
+#endif
+
+typedef LIPNET_VALUE_TYPE value_t;
+
+
 template<typename NN>
 int dumptodisk( const std::string &path, const std::string &name, NN &nn ) {
     std::ofstream oss( path );
@@ -74,30 +83,40 @@ int main(int argc, char **argv)
     typedef std::integral_constant<size_t,40> HIDDEN2;
     typedef std::integral_constant<size_t,10>  OUTPUTS;
 
-    typedef std::integral_constant<size_t, 60000> BATCH;
+    typedef std::integral_constant<size_t, dynamic_batch> BATCH;
 
     std::string datafile = "mnist_training.json";
     std::string modelfile = "model_mnist.json";
     std::string statsfile = "stats_mnist.json";
 
-    double lipschitz = 20;
-    double alpha = 0.001;
-    double diff = 1e-8;
+    value_t lipschitz = 20;
+    value_t alpha = 0.001;
+    value_t diff = 1e-8;
     size_t centralpathsteps = 3;
     size_t maxiter = 1e4;
-    double threshold = 1e-8;
+    value_t threshold = 1e-8;
     size_t window = 300;
+    size_t batchsize = 0;
 
-    double rhodec = 0.5;
-    double alphadec = 0.5;
+    value_t rhodec = 0.5;
+    value_t alphadec = 0.5;
 
-    double rho = 0.1;
+    value_t rho = 0.1;
 
-    double beta1 = 0.9, beta2 = 0.999;
+    value_t beta1 = 0.9, beta2 = 0.999;
 
     int method = choice_t::NOM;
     bool feasbility_enabled = true;
 
+    checkpoint_t checkpoint;
+    std::string tracefile;
+    size_t traceevery = 1;
+
+    size_t lipevery = 0;
+    value_t lipstop = 0;
+    size_t backtracking = 0;
+    resources_t res;
+
     bool show_help = false;
     auto cli
             = lyra::help(show_help)
@@ -130,6 +149,29 @@ int main(int argc, char **argv)
                   ["-x"]["--rhodec"]("rhodec (default: 0.5)")
             | lyra::opt(feasbility_enabled, "feasbility_enabled")["-e"]["--fenabled"]("default true")
             | lyra::opt(maxiter, "maxiter")["-m"]["--maxiter"]("maxiter")
+            | lyra::opt(batchsize, "batchsize")["-b"]["--batch"]("batch size (default: 0, whole dataset)")
+            | lyra::opt(checkpoint.path, "checkpointfile")
+                  ["-C"]["--checkpoint"]("checkpoint the barrier methods to 'checkpointfile' and resume from it if it exists")
+            | lyra::opt(checkpoint.every, "iterations")
+                  ["--checkpoint-every"]("iterations between two checkpoints (default: 1000)")
+            | lyra::opt(tracefile, "tracefile")
+                  ["--trace"]("stream the barrier loss per iteration to 'tracefile' (binary, or csv if it ends with .csv) instead of keeping it in 'statsfile'")
+            | lyra::opt(traceevery, "n")
+                  ["--trace-every"]("keep every n-th record of the trace (default: 1)")
+            | lyra::opt(lipevery, "n")
+                  ["--lipschitz-every"]("estimate the product of the spectral norms every n iterations (default: 0, never)")
+            | lyra::opt(lipstop, "bound")
+                  ["--lipschitz-stop"]("stop once the estimate exceeds 'bound' (default: 0, never)")
+            | lyra::opt(backtracking, "halvings")
+                  ["--backtracking"]("halve a barrier step at most 'halvings' times until chi (without numerical offset) has a cholesky decomposition (default: 0, off)")
+            | lyra::opt(res.workers, "threads")
+                  ["--workers"]("lipnet worker threads, e.g. of the backpropagation (default: hardware threads)")
+            | lyra::opt(res.blaze, "threads")
+                  ["--blaze-threads"]("threads of blaze (default: blaze default)")
+            | lyra::opt(res.solver, "threads")
+                  ["--solver-threads"]("threads of every mosek model (default: mosek decides)")
+            | lyra::opt(res.pin, "core")
+                  ["--pin"]("pin the process to consecutive cores starting at 'core', one per thread of the largest pool (default: off)")
             | lyra::arg(method, "method").help("method to train the network").required();
 
     auto result = cli.parse({ argc, argv });
@@ -142,22 +184,42 @@ int main(int argc, char **argv)
         std::cout << cli << "\n";  return 0;
     }
 
-     data_container_t<double> mnist;
-     std::ifstream iss( datafile );
-     {
-         cereal::JSONInputArchive archive( iss );
-         archive( cereal::make_nvp("mnist", mnist) );
-     }
+    configure( res );
+
+    std::shared_ptr<statistics_sink_t<value_t>> trace;
+    if( !tracefile.empty() )
+        trace = std::make_shared<statistics_sink_t<value_t>>( tracefile, traceevery, 4096,
+                                                             !checkpoint.path.empty() );
 
-     iss.close();
+     network_data_t<value_t,INPUTS::value,OUTPUTS::value> data;
+
+     if( datafile.size() > 4 && datafile.substr( datafile.size()-4 ) == ".bin" ) {
+         auto opt = binary_loader_t<value_t>::load_network_data<INPUTS::value,
+                 OUTPUTS::value>( datafile );
+         if( !opt.has_value() ) {
+             std::cerr << "could not read '" << datafile << "'" << std::endl;
+             return 1;
+         }
+         data = std::move( opt.value() );
+     } else {
+         data_container_t<value_t> mnist;
+         std::ifstream iss( datafile );
+         {
+             cereal::JSONInputArchive archive( iss );
+             archive( cereal::make_nvp("mnist", mnist) );
+         }
+
+         iss.close();
+
+         data = network_data_t<value_t,INPUTS::value,OUTPUTS::value>{
+             std::move( mnist.x ), std::move( mnist.y )
+         };
+     }
 
      std::cout << "data loaded..."  << "\n";
-     network_data_t<double,INPUTS::value,OUTPUTS::value> data{
-         std::move( mnist.x ), std::move( mnist.y )
-     };
 
 
-     typedef network_t<double, tanh_activation_t, INPUTS::value, HIDDEN1::value,
+     typedef network_t<value_t, tanh_activation_t, INPUTS::value, HIDDEN1::value,
              HIDDEN2::value, OUTPUTS::value> nn_t;
      auto nn = nn_t();
 
@@ -165,30 +227,42 @@ int main(int argc, char **argv)
      switch (method) {
      case choice_t::BARR: {
 
-         typedef network_problem_log_barrier_t<double, tanh_activation_t,
+         typedef network_problem_log_barrier_t<value_t, tanh_activation_t,
                          cross_entropy_t, BATCH::value, INPUTS::value, HIDDEN1::value,
                  HIDDEN2::value, OUTPUTS::value> pro_nn_t ;
          typename pro_nn_t::variable_t init
              = generator_t<typename pro_nn_t::variable_t>::make( 0.1, 2.0 );
          if (feasbility_enabled) {
-             typedef adam_barrier_t<double, pro_nn_t, typename pro_nn_t::variable_t,
+             typedef adam_barrier_t<value_t, pro_nn_t, typename pro_nn_t::variable_t,
                      typename pro_nn_t::variable_t, true> solver_t;
              //solver_t solver( solver_t::parameter_t{ (size_t) 100, 1e-6, 0.5, 0.03, 0.9, 0.999, 1e-8 } );
              solver_t solver(  solver_t::parameter_t{ maxiter, centralpathsteps,
                           diff, threshold, window, rho, alpha, beta1, beta2, alphadec, rhodec,  1e-8 } );
-             pro_nn_t prob ( cross_entropy_t<double>(), std::move(data), lipschitz );
+             solver.param.checkpoint = checkpoint;
+             solver.param.lipschitz_every = lipevery;
+             solver.param.lipschitz_stop = lipstop;
+             solver.param.backtracking = backtracking;
+             solver.sink = trace;
+             pro_nn_t prob ( cross_entropy_t<value_t>(), std::move(data), lipschitz );
+             prob.batch = batchsize;
              solver_t::main_statistics_t stats;
              auto [ weights, value ] = solver( prob, std::move(init), stats );
              nn.layers = weights.W;
 
              dumptodisk( statsfile, "run", stats );
          } else {
-             typedef adam_barrier_t<double, pro_nn_t, typename pro_nn_t::variable_t,
+             typedef adam_barrier_t<value_t, pro_nn_t, typename pro_nn_t::variable_t,
                      typename pro_nn_t::variable_t, false> solver_t;
              //solver_t solver( solver_t::parameter_t{ (size_t) 100, 1e-6, 0.5, 0.03, 0.9, 0.999, 1e-8 } );
              solver_t solver(  solver_t::parameter_t{ maxiter, centralpathsteps,
                           diff, threshold, window, rho, alpha, beta1, beta2, alphadec, rhodec,  1e-8 } );
-             pro_nn_t prob ( cross_entropy_t<double>(), std::move(data), lipschitz );
+             solver.param.checkpoint = checkpoint;
+             solver.param.lipschitz_every = lipevery;
+             solver.param.lipschitz_stop = lipstop;
+             solver.param.backtracking = backtracking;
+             solver.sink = trace;
+             pro_nn_t prob ( cross_entropy_t<value_t>(), std::move(data), lipschitz );
+             prob.batch = batchsize;
              solver_t::main_statistics_t stats;
              auto [ weights, value ] = solver( prob, std::move(init), stats );
              nn.layers = weights.W;
@@ -201,17 +275,17 @@ int main(int argc, char **argv)
      }
      case choice_t::NOM: {
 
-        typedef network_problem_batch_t<double, tanh_activation_t,
+        typedef network_problem_batch_t<value_t, tanh_activation_t,
                  cross_entropy_t, BATCH::value, INPUTS::value, HIDDEN1::value,
                          HIDDEN2::value, OUTPUTS::value> pro_nn_t ;
         typename pro_nn_t::variable_t init = generator_t<typename pro_nn_t::variable_t>::make( 0.1 );
 
-        typedef adam_momentum_t<double, pro_nn_t, typename pro_nn_t::variable_t,
+        typedef adam_momentum_t<value_t, pro_nn_t, typename pro_nn_t::variable_t,
                    typename pro_nn_t::variable_t> solver_t;
 
         solver_t solver(  solver_t::parameter_t{ maxiter, diff, 1e-12, alpha, beta1, beta2, 1e-8 } );
 
-        pro_nn_t prob ( cross_entropy_t<double>(), std::move(data) );
+        pro_nn_t prob ( cross_entropy_t<value_t>(), std::move(data), batchsize );
 
         solver_t::main_statistics_t stats;
         auto [ weights, value ] = solver( prob, std::move(init), stats );
@@ -19,11 +19,13 @@
 #include <fstream>
 #include <chrono>
 #include <string>
+#include <cstdio>
 
 #include <lipnet/network/activation.hpp>
 #include <lipnet/network/loss.hpp>
 #include <lipnet/network/topology.hpp>
 #include <lipnet/network/backpropagation.hpp>
+#include <lipnet/dynamic/network.hpp>
 
 #include <lipnet/optimizer.hpp>
 #include <lipnet/statistics.hpp>
@@ -31,6 +33,7 @@
 #include <lipnet/loader/loader.hpp>
 
 #include <lipnet/lipschitz/barrier.hpp>
+#include <lipnet/parallel.hpp>
 
 #include <cereal/types/vector.hpp>
 #include <lyra/lyra.hpp>
@@ -40,74 +43,109 @@
 
 using namespace lipnet;
 
-struct image_t {
-    typedef blaze::StaticVector<double,3,blaze::columnVector> pixel_t;
-    explicit image_t( size_t w, size_t h )
-        : width{ w }, height{ h } { data.resize(w*h); }
+typedef blaze::DynamicMatrix<double,blaze::rowMajor> matrix_t;
 
-    inline pixel_t& operator()(const size_t &x, const size_t &y) {
-                return data[y*width+x]; }
+// the topology is read from the model file; two inputs, the first three outputs are the colors
+typedef dynamic_network_t<double, tanh_activation_t> nn_t;
 
-    size_t width, height;
-    std::vector<pixel_t> data;
-};
 
-bool save( const std::string &path, const image_t &img ) {
-    size_t size = img.width*img.height*3;
-    std::unique_ptr<unsigned char[]> data( new unsigned char[size] );
+/**
+ * @brief render the decision surface into a packed rgb buffer, row j holds y = -1 + 2/ny*j.
+ *          Every tile of tile x tile pixels is one batch of the forward pass, the
+ *          tiles are distributed over the threads and write disjoint pixels.
+ */
 
-    for (size_t i = 0; i < img.height*img.width; ++i) {
-        auto &pixel = img.data[i];
-        //auto &pixel = img.data[ (img.height-i/img.width-1)*img.width + i % img.width];
-        for (size_t j = 0; j<3; j++)
-            data[i*3+j] = (unsigned char)(255 * std::max(0., std::min(1., pixel[j] )));;
-    }
+std::vector<unsigned char> render( const nn_t &network, const size_t nx, const size_t ny,
+                                   const size_t tile, const size_t threads ) {
+    const size_t tx = ( nx + tile - 1 ) / tile, ty = ( ny + tile - 1 ) / tile;
+    const size_t channels = std::min<size_t>( 3, network.topology.back() );
+
+    std::vector<unsigned char> rgb( nx*ny*3, 0 );
+
+    parallel_for( tx*ty, threads, [&]( const size_t, const size_t begin, const size_t end ) {
+        matrix_t points;
+
+        for( size_t t = begin; t < end; ++t ) {
+            const size_t x0 = ( t % tx )*tile, y0 = ( t / tx )*tile;
+            const size_t w = std::min( tile, nx - x0 ), h = std::min( tile, ny - y0 );
+
+            points.resize( 2, w*h, false );
+            for( size_t j = 0; j < h; ++j )
+                for( size_t i = 0; i < w; ++i ) {
+                    points( 0, j*w+i ) = -1.0+2.0/nx*( x0+i );
+                    points( 1, j*w+i ) = -1.0+2.0/ny*( y0+j );
+                }
+
+            const matrix_t outputs = blaze::softmax<blaze::columnwise>( network.propagate( points ) );
+
+            for( size_t j = 0; j < h; ++j ) {
+                unsigned char *row = &rgb[ ( ( y0+j )*nx + x0 )*3 ];
+                for( size_t i = 0; i < w; ++i )
+                    for( size_t c = 0; c < channels; ++c )
+                        row[ i*3+c ] = (unsigned char)( 255 * std::max( 0., std::min( 1., outputs( c, j*w+i ) ) ) );
+            }
+        }
+    });
+
+    return rgb;
+}
 
+bool save( const std::string &path, const std::vector<unsigned char> &rgb,
+           const size_t width, const size_t height ) {
     stbi__flip_vertically_on_write = 1;
-    return 0 == stbi_write_png( path.c_str(), img.width, img.height,
-                                3, (const void*) data.get(), 3*img.width );
+    return 0 != stbi_write_png( path.c_str(), width, height,
+                                3, (const void*) rgb.data(), 3*width );
 }
 
 
+/// name of frame k of an animation; 'surface.png' -> 'surface-0003.png'
+std::string frame_name( const std::string &path, const size_t k ) {
+    char index[16]; std::snprintf( index, sizeof( index ), "-%04zu", k );
 
-auto load_data( const std::string &filename ) {
-    network_data_t<double,2,3> data;
+    const size_t dot = path.find_last_of( '.' ), slash = path.find_last_of( '/' );
+    if( dot == std::string::npos || ( slash != std::string::npos && dot < slash ) )
+        return path + index;
+    return path.substr( 0, dot ) + index + path.substr( dot );
+}
 
-    auto opt = loader_t<double>::load(filename);
-    if( !opt.has_value() )
-        throw std::string{"could not load file"};
 
-    data.idata = blaze::trans( blaze::submatrix( opt.value(), 0, 0,
-                           2, opt.value().columns() ));
 
-    auto last = blaze::row( opt.value(), 2);
-    data.tdata = blaze::trans( make_one_hot<double>( blaze::trans(last), 3 ) );
+auto load_data( const std::string &filename ) {
+    auto opt = loader_t<double>::template load_network_data<2,3>( filename, true );
+    if( !opt.has_value() )
+        throw std::string{"could not load file"};
 
-    return std::move(data);
+    return std::move( opt.value() );
 }
 
 
 int main(int argc, char **argv)
 {
-    std::string modelfile = "model.json";
+    std::vector<std::string> modelfiles;
     std::string surffile = "topology.png";
 
     size_t nx = 60, ny = 60;
+    size_t tile = 128;
+    size_t threads = default_threads();
 
     bool type = false;
     bool show_help = false;
     auto cli
             = lyra::help(show_help)
-            | lyra::opt(modelfile, "modelfile")
-                  ["-i"]["--input"]("read model as json from 'modelfile'")
+            | lyra::opt(modelfiles, "modelfile")
+                  ["-i"]["--input"]("read model as json from 'modelfile'; repeatable, one frame per model, e.g. the checkpoints of a run (default: model.json)")
             | lyra::opt(surffile, "surffile")
-                  ["-o"]["--output"]("save surface topology of network to 'surffile'")
+                  ["-o"]["--output"]("save surface topology of network to 'surffile'; frames are numbered 'surffile-0000.png', ...")
             | lyra::opt(type, "type")
                   ["-t"]["--type"]("image or value file")
             | lyra::opt(nx, "nx")
                   ["-x"]["--numberx"]("resolution in x direction")
             | lyra::opt(ny, "ny")
-                  ["-y"]["--numbery"]("resolution in y direction");
+                  ["-y"]["--numbery"]("resolution in y direction")
+            | lyra::opt(tile, "tile")
+                  ["--tile"]("pixels per side of a tile evaluated as one batch (default: 128)")
+            | lyra::opt(threads, "threads")
+                  ["-j"]["--threads"]("threads of the renderer (default: hardware threads)");
 
     auto result = cli.parse({ argc, argv });
 
@@ -124,14 +162,28 @@ int main(int argc, char **argv)
         return 0;
     }
 
+    if( modelfiles.empty() ) modelfiles = { "model.json" };
+    tile = std::max<size_t>( 1, tile );
+
+
+    /// grid points of a (mx,my) grid with spacing 2/nx, 2/ny as one batch; column i*my+j
+    const auto grid = [&]( const size_t mx, const size_t my ) {
+        matrix_t points( 2, mx*my );
+        for(size_t i=0; i < mx; i++)
+            for(size_t j=0; j < my; j++) {
+                points( 0, i*my+j ) = -1.0+2.0/nx*i;
+                points( 1, i*my+j ) = -1.0+2.0/ny*j;
+            }
+        return points;
+    };
 
 
-    typedef blaze::StaticVector<double,2,blaze::columnVector> vector_t;
-    typedef blaze::DynamicMatrix<double,blaze::rowMajor> matrix_t;
-    network_t<double, tanh_activation_t, 2, 10, 10, 3> network;
+    for( size_t k = 0; k < modelfiles.size(); ++k ) {
+    const std::string target = ( modelfiles.size() > 1 ) ? frame_name( surffile, k ) : surffile;
 
+    nn_t network;
 
-    std::ifstream is( modelfile );
+    std::ifstream is( modelfiles[k] );
     {
         cereal::JSONInputArchive archive(is);
         archive( cereal::make_nvp("model", network) );
@@ -139,18 +191,25 @@ int main(int argc, char **argv)
 
     is.close();
 
-
+    if( network.topology.front() != 2 )
+        throw std::string{"the surface needs a network with two inputs"};
+    if( type && network.topology.back() < 3 )
+        throw std::string{"the value file needs a network with three outputs"};
 
 
     if( type ) {
-    std::ofstream stream( surffile );
+    std::ofstream stream( target );
        csv2::Writer<csv2::delimiter<','>> writer(stream);
 
+    const matrix_t points = grid( nx+3, ny+3 );
+    const matrix_t outputs = blaze::softmax<blaze::columnwise>(
+                network.query_batch( points, threads ) );
+
     for(int i=0; i < nx+3; i++)
         for(int j=0; j < ny+3; j++)
         {
             double x =  -1.0+2.0/nx*i, y = -1.0+2.0/ny*j;
-            auto res = blaze::softmax(network.query( vector_t{x,y} ));
+            auto res = blaze::column( outputs, i*(ny+3)+j );
 
             std::array<std::string,5> row = { std::to_string(x),
                                              std::to_string(y),
@@ -158,36 +217,23 @@ int main(int argc, char **argv)
                                              std::to_string(res[1]),
                                              std::to_string(res[2]) };
             writer.write_row( row );
-
-
-            /*blaze::row(inputmatrix, i*ny+j)
-                = {x,y, res[0], res[1], res[2]};*/
-
         }
 
     stream.close();
 
     } else {
-        image_t img( nx, ny );
-        blaze::StaticVector<double,3,blaze::columnVector>
-                pixel = {1, 1, 1};
-        blaze::StaticVector<double,3,blaze::columnVector>
-                 weight = { 1.0, 0.5, 0.0 } ;
-
-        for(int i=0; i < nx; i++)
-            for(int j=0; j < ny; j++)
-            {
-                double x =  -1.0+2.0/nx*i, y = -1.0+2.0/ny*j;
-
-                //auto res = blaze::softmax(network.query( vector_t{x,y} ));
-                //std::cout << "res: " << blaze::trans(res);
-                //img(i,j) = pixel * blaze::sum( (res * weight) );
-                img( i, j ) = blaze::softmax(network.query( vector_t{x,y} ));
-            }
+        const auto start = std::chrono::steady_clock::now();
+        const auto rgb = render( network, nx, ny, tile, threads );
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
-        save( surffile, img );
+        if( !save( target, rgb, nx, ny ) ) {
+            std::cerr << "could not write '" << target << "'" << std::endl;
+            return 1;
+        }
+
+        std::cout << target << ": " << nx << "x" << ny << " in " << elapsed.count() << "s\n";
+    }
     }
 
 
 }
-
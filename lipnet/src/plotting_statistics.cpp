@@ -113,13 +113,11 @@ int main(int argc, char **argv)
     //std::cout << data.idata << "\n";
     vector_t list(  data.idata.rows() );
 
-    for(int i=0; i < data.idata.rows(); i++) {
-
-        vec_t in =  blaze::trans(blaze::row(data.idata,i));
-        auto obj = network.query( in );
+    auto outputs = network.query_batch( blaze::trans( data.idata ), default_threads() );
 
+    for(int i=0; i < data.idata.rows(); i++) {
         list[i] = blaze::argmax(blaze::row(data.tdata,i))
-                        == blaze::argmax( obj ) ? 1 : 0;
+                        == blaze::argmax( blaze::column( outputs, i ) ) ? 1 : 0;
     }
 
     double acc = ((double) blaze::sum( list )) / list.size();